@@ -17,6 +17,7 @@
 
 #include <Kaleidoscope.h>
 #include <Kaleidoscope-CycleTimeReport.h>
+#include <Kaleidoscope-FocusSerial.h>
 
 // *INDENT-OFF*
 KEYMAPS(
@@ -40,7 +41,7 @@ KEYMAPS(
 )
 // *INDENT-ON*
 
-KALEIDOSCOPE_INIT_PLUGINS(CycleTimeReport);
+KALEIDOSCOPE_INIT_PLUGINS(Focus, CycleTimeReport);
 
 void setup() {
   Kaleidoscope.serialPort().begin(9600);
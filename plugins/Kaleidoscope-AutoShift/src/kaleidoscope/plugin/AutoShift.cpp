@@ -168,6 +168,8 @@ EventHandlerResult AutoShift::afterEachCycle() {
     flushEvent(true);
     flushQueue();
   }
+  if (!queue_.isEmpty())
+    Runtime.declareDeadline(queue_.timestamp(0), settings_.timeout);
   return EventHandlerResult::OK;
 }
 
@@ -55,8 +55,23 @@ void ColormapEffect::TransientLEDMode::refreshAt(KeyAddr key_addr) {
 }
 
 EventHandlerResult ColormapEffect::onLayerChange() {
-  if (::LEDControl.get_mode_index() == led_mode_id_)
-    ::LEDControl.get_mode<TransientLEDMode>()->onActivate();
+  if (!Runtime.has_leds || ::LEDControl.get_mode_index() != led_mode_id_)
+    return EventHandlerResult::OK;
+
+  uint8_t previous_layer = top_layer_;
+  top_layer_ = Layer.mostRecent();
+
+  // Momentary layer changes that do not change the top layer (or changes
+  // between layers without a colormap) leave the LEDs as they are. Otherwise,
+  // repaint only the keys whose color differs between the two layers.
+  if (top_layer_ == previous_layer || top_layer_ > max_layers_)
+    return EventHandlerResult::OK;
+
+  if (previous_layer <= max_layers_)
+    ::LEDPaletteTheme.updateHandler(map_base_, top_layer_, previous_layer);
+  else
+    ::LEDPaletteTheme.updateHandler(map_base_, top_layer_);
+
   return EventHandlerResult::OK;
 }
 
@@ -1,6 +1,6 @@
 /* -*- mode: c++ -*-
  * Kaleidoscope-CycleTimeReport -- Scan cycle time reporting
- * Copyright (C) 2017, 2018  Keyboard.io, Inc
+ * Copyright (C) 2017, 2018, 2021  Keyboard.io, Inc
  *
  * This program is free software: you can redistribute it and/or modify it under
  * the terms of the GNU General Public License as published by the Free Software
@@ -18,46 +18,187 @@
 #include <Kaleidoscope-CycleTimeReport.h>
 #include <Kaleidoscope-FocusSerial.h>
 
+#include "kaleidoscope/CycleProfile.h"
+
 namespace kaleidoscope {
 namespace plugin {
+
+// -----------------------------------------------------------------------------
+// CycleTimeHistogram
+
+constexpr uint8_t CycleTimeHistogram::bucket_count;
+
+uint8_t CycleTimeHistogram::bucketIndex(uint32_t micros) {
+  if (micros < 4)
+    return micros;
+
+  // The top bit says which power of two, the two below it which quarter.
+  uint8_t top_bit = 2;
+  while (micros >> (top_bit + 1))
+    top_bit++;
+
+  uint8_t index = 4 * (top_bit - 1) + ((micros >> (top_bit - 2)) & 3);
+  return index < bucket_count ? index : bucket_count - 1;
+}
+
+uint32_t CycleTimeHistogram::bucketStart(uint8_t index) {
+  if (index < 4)
+    return index;
+  return uint32_t(4 + index % 4) << (index / 4 - 1);
+}
+
+void CycleTimeHistogram::record(uint32_t micros) {
+  uint16_t &bucket = buckets_[bucketIndex(micros)];
+  if (bucket == UINT16_MAX) {
+    for (uint16_t &b : buckets_)
+      b = (b + 1) / 2;
+  }
+  bucket++;
+
+  if (micros > max_)
+    max_ = micros;
+}
+
+void CycleTimeHistogram::reset() {
+  for (uint16_t &b : buckets_)
+    b = 0;
+  max_ = 0;
+}
+
+uint32_t CycleTimeHistogram::count() const {
+  uint32_t count = 0;
+  for (uint16_t b : buckets_)
+    count += b;
+  return count;
+}
+
+uint32_t CycleTimeHistogram::percentile(uint8_t percent) const {
+  // The number of cycles that have to fit, rounded up.
+  uint32_t wanted = (count() * percent + 99) / 100;
+  if (wanted == 0)
+    return 0;
+
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < bucket_count - 1; i++) {
+    seen += buckets_[i];
+    if (seen >= wanted) {
+      uint32_t end = bucketStart(i + 1) - 1;
+      return end < max_ ? end : max_;
+    }
+  }
+  return max_;
+}
+
+// -----------------------------------------------------------------------------
+// CycleTimeReport
+
+CycleTimeHistogram CycleTimeReport::histogram_;
 uint16_t CycleTimeReport::last_report_time_;
 uint32_t CycleTimeReport::loop_start_time_;
+uint32_t CycleTimeReport::loop_time_sum_;
+uint16_t CycleTimeReport::loop_count_;
 uint32_t CycleTimeReport::average_loop_time;
+uint32_t CycleTimeReport::max_loop_time;
 
 EventHandlerResult CycleTimeReport::onSetup() {
   last_report_time_ = Runtime.millisAtCycleStart();
+  loop_start_time_ = Runtime.device().micros();
   return EventHandlerResult::OK;
 }
 
+// A cycle is timed from one call to this to the next, so that it counts all
+// of the cycle, wherever the plugin is in the list.
 EventHandlerResult CycleTimeReport::beforeEachCycle() {
-  loop_start_time_ = micros();
-  return EventHandlerResult::OK;
-}
-
-EventHandlerResult CycleTimeReport::afterEachCycle() {
-  uint32_t loop_time = micros() - loop_start_time_;
+  uint32_t now = Runtime.device().micros();
+  uint32_t loop_time = now - loop_start_time_;
+  loop_start_time_ = now;
 
-  if (average_loop_time)
-    average_loop_time = (average_loop_time + loop_time) / 2;
-  else
-    average_loop_time = loop_time;
+  histogram_.record(loop_time);
+  loop_time_sum_ += loop_time;
+  loop_count_++;
+  if (loop_time > max_loop_time)
+    max_loop_time = loop_time;
 
   if (Runtime.hasTimeExpired(last_report_time_, uint16_t(1000))) {
+    average_loop_time = loop_time_sum_ / loop_count_;
     cycleTimeReport();
 
-    average_loop_time = 0;
+    loop_time_sum_ = 0;
+    loop_count_ = 0;
+    max_loop_time = 0;
     last_report_time_ = Runtime.millisAtCycleStart();
+
+    // Printing the report takes a while, which is no part of the next cycle.
+    loop_start_time_ = Runtime.device().micros();
   }
 
   return EventHandlerResult::OK;
 }
 
+void CycleTimeReport::reset() {
+  histogram_.reset();
+#if KALEIDOSCOPE_CYCLE_PROFILE
+  cycle_profile.reset();
+#endif
+}
+
+EventHandlerResult CycleTimeReport::onNameQuery() {
+  return ::Focus.sendName(F("CycleTimeReport"));
+}
+
+EventHandlerResult CycleTimeReport::onFocusEvent(const char *command) {
+  if (::Focus.handleHelp(command, PSTR("cycletime.percentiles\n"
+                                       "cycletime.histogram\n"
+                                       "cycletime.phases\n"
+                                       "cycletime.reset")))
+    return EventHandlerResult::OK;
+
+  if (strncmp_P(command, PSTR("cycletime."), 10) != 0)
+    return EventHandlerResult::OK;
+  command += 10;
+
+  if (strcmp_P(command, PSTR("percentiles")) == 0) {
+    ::Focus.send(histogram_.count(),
+                 histogram_.percentile(50),
+                 histogram_.percentile(90),
+                 histogram_.percentile(99),
+                 histogram_.longest());
+  } else if (strcmp_P(command, PSTR("histogram")) == 0) {
+    // One line per bucket that isn't empty: the shortest time that goes in
+    // it, and the number of cycles in it.
+    bool first = true;
+    for (uint8_t i = 0; i < CycleTimeHistogram::bucket_count; i++) {
+      if (histogram_.bucket(i) == 0)
+        continue;
+      if (!first)
+        ::Focus.sendRaw(::Focus.NEWLINE);
+      ::Focus.send(CycleTimeHistogram::bucketStart(i), histogram_.bucket(i));
+      first = false;
+    }
+  } else if (strcmp_P(command, PSTR("phases")) == 0) {
+    // One line per phase, in `CyclePhase` order: the mean and longest time it
+    // took in a cycle. Without a profile, there are no lines.
+#if KALEIDOSCOPE_CYCLE_PROFILE
+    for (uint8_t i = 0; i < CycleProfile::phase_count; i++) {
+      if (i > 0)
+        ::Focus.sendRaw(::Focus.NEWLINE);
+      ::Focus.send(cycle_profile.mean(CyclePhase(i)),
+                   cycle_profile.longest(CyclePhase(i)));
+    }
+#endif
+  } else if (strcmp_P(command, PSTR("reset")) == 0) {
+    reset();
+  }
+
+  return EventHandlerResult::EVENT_CONSUMED;
+}
+
 }
 }
 
 __attribute__((weak)) void cycleTimeReport(void) {
   Focus.send(Focus.COMMENT, F("average loop time:"), CycleTimeReport.average_loop_time,
-             Focus.NEWLINE);
+             F("max:"), CycleTimeReport.max_loop_time, Focus.NEWLINE);
 }
 
 kaleidoscope::plugin::CycleTimeReport CycleTimeReport;
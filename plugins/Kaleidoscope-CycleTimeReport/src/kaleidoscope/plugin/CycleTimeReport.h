@@ -1,6 +1,6 @@
 /* -*- mode: c++ -*-
  * Kaleidoscope-CycleTimeReport -- Scan cycle time reporting
- * Copyright (C) 2017, 2018  Keyboard.io, Inc
+ * Copyright (C) 2017, 2018, 2021  Keyboard.io, Inc
  *
  * This program is free software: you can redistribute it and/or modify it under
  * the terms of the GNU General Public License as published by the Free Software
@@ -21,20 +21,68 @@
 
 namespace kaleidoscope {
 namespace plugin {
+
+// A histogram of cycle times, in microseconds, with logarithmic buckets: the
+// first four hold 0 to 3, and from there on, every power of two is split in
+// four, so no bucket is wider than a quarter of the values in it. Times past
+// the start of the last bucket (about 115ms) all go in there.
+class CycleTimeHistogram {
+ public:
+  static constexpr uint8_t bucket_count = 64;
+
+  void record(uint32_t micros);
+  void reset();
+
+  uint32_t count() const;
+  uint32_t longest() const {
+    return max_;
+  }
+  // The time within which `percent` percent of the cycles finished, rounded
+  // up to the end of its bucket, but never past `longest()`.
+  uint32_t percentile(uint8_t percent) const;
+
+  uint16_t bucket(uint8_t index) const {
+    return buckets_[index];
+  }
+  static uint8_t bucketIndex(uint32_t micros);
+  // The shortest time that goes in bucket `index`.
+  static uint32_t bucketStart(uint8_t index);
+
+ private:
+  // When a bucket is about to overflow, all of them get halved, which keeps
+  // the percentiles right, at the cost of weighing older cycles less.
+  uint16_t buckets_[bucket_count] = {};
+  uint32_t max_ = 0;
+};
+
 class CycleTimeReport : public kaleidoscope::Plugin {
  public:
   CycleTimeReport() {}
 
   EventHandlerResult onSetup();
   EventHandlerResult beforeEachCycle();
-  EventHandlerResult afterEachCycle();
+  EventHandlerResult onNameQuery();
+  EventHandlerResult onFocusEvent(const char *command);
 
+  // The mean and longest cycle times since the last report.
   static uint32_t average_loop_time;
+  static uint32_t max_loop_time;
+
+  // All cycle times since the last `reset()`.
+  static const CycleTimeHistogram &histogram() {
+    return histogram_;
+  }
+  // Empties the histogram, and the per-phase times, if there are any.
+  static void reset();
 
  private:
+  static CycleTimeHistogram histogram_;
   static uint16_t last_report_time_;
   static uint32_t loop_start_time_;
+  static uint32_t loop_time_sum_;
+  static uint16_t loop_count_;
 };
+
 }
 }
 
@@ -25,6 +25,17 @@ namespace plugin {
 uint16_t DynamicMacros::storage_base_;
 uint16_t DynamicMacros::storage_size_;
 uint16_t DynamicMacros::map_[];
+uint8_t DynamicMacros::map_size_;
+uint8_t DynamicMacros::read_ahead_[];
+uint16_t DynamicMacros::read_ahead_start_;
+uint8_t DynamicMacros::read_ahead_size_;
+bool DynamicMacros::playing_;
+bool DynamicMacros::release_when_done_;
+uint16_t DynamicMacros::play_pos_;
+macro_t DynamicMacros::play_sequence_ = MACRO_ACTION_END;
+uint8_t DynamicMacros::play_interval_;
+uint16_t DynamicMacros::play_wait_start_;
+uint16_t DynamicMacros::play_wait_;
 Key DynamicMacros::active_macro_keys_[];
 
 // =============================================================================
@@ -53,16 +64,61 @@ void DynamicMacros::tap(Key key) {
   Runtime.handleKeyEvent(KeyEvent(KeyAddr::none(), WAS_PRESSED | INJECTED, key));
 }
 
-void DynamicMacros::updateDynamicMacroCache() {
-  uint16_t pos = storage_base_;
+void DynamicMacros::releaseAll() {
+  for (Key key : active_macro_keys_) {
+    release(key);
+  }
+}
+
+// Macros are read from storage sequentially, both when indexing and when
+// playing them, so rather than reading a byte at a time, we read a small block
+// ahead in one go, and serve the following reads from that.
+uint8_t DynamicMacros::readByte(uint16_t pos) {
+  if (pos < read_ahead_start_ || pos >= read_ahead_start_ + read_ahead_size_) {
+    if (pos >= storage_size_)
+      return MACRO_ACTION_END;
+
+    read_ahead_start_ = pos;
+    if (storage_size_ - pos >= DYNAMIC_MACRO_READ_AHEAD) {
+      read_ahead_size_ = DYNAMIC_MACRO_READ_AHEAD;
+      Runtime.storage().get(storage_base_ + pos, read_ahead_);
+    } else {
+      read_ahead_size_ = storage_size_ - pos;
+      for (uint8_t i = 0; i < read_ahead_size_; i++)
+        read_ahead_[i] = Runtime.storage().read(storage_base_ + pos + i);
+    }
+  }
+  return read_ahead_[pos - read_ahead_start_];
+}
+
+// Rebuilds the index of macro start offsets after the bytes between
+// `first_changed` and `last_changed` have been changed. Macros that end before
+// the first changed byte are left alone, and once we're past the last changed
+// byte, as soon as a macro ends where it did before, the rest of the index is
+// known to be unchanged too.
+void DynamicMacros::updateDynamicMacroCache(uint16_t first_changed,
+                                            uint16_t last_changed) {
+  // The read-ahead buffer might hold stale data.
+  read_ahead_size_ = 0;
+
+  // The last entry of the index is where the empty macro that ends the list
+  // ends, rather than the start of a macro, so it is never a starting point.
+  uint8_t old_map_size = map_size_;
   uint8_t current_id = 0;
+  while (current_id + 2 < map_size_ && map_[current_id + 1] <= first_changed)
+    current_id++;
+
+  uint16_t pos = map_[current_id];
   macro_t macro = MACRO_ACTION_END;
-  bool previous_macro_ended = false;
+  bool previous_macro_ended = current_id > 0;
 
-  map_[0] = 0;
+  if (current_id == 0) {
+    map_[0] = 0;
+    map_size_ = 1;
+  }
 
-  while (pos < storage_base_ + storage_size_) {
-    macro = Runtime.storage().read(pos++);
+  while (pos < storage_size_) {
+    macro = readByte(pos++);
     switch (macro) {
     case MACRO_ACTION_STEP_EXPLICIT_REPORT:
     case MACRO_ACTION_STEP_IMPLICIT_REPORT:
@@ -90,23 +146,33 @@ void DynamicMacros::updateDynamicMacroCache() {
       previous_macro_ended = false;
       uint8_t keyCode, flags;
       do {
-        flags = Runtime.storage().read(pos++);
-        keyCode = Runtime.storage().read(pos++);
-      } while (!(flags == 0 && keyCode == 0));
+        flags = readByte(pos++);
+        keyCode = readByte(pos++);
+      } while (!(flags == 0 && keyCode == 0) && pos < storage_size_);
       break;
     }
 
     case MACRO_ACTION_STEP_TAP_CODE_SEQUENCE: {
       previous_macro_ended = false;
-      uint8_t keyCode, flags;
+      uint8_t keyCode;
       do {
-        keyCode = Runtime.storage().read(pos++);
-      } while (keyCode != 0);
+        keyCode = readByte(pos++);
+      } while (keyCode != 0 && pos < storage_size_);
       break;
     }
 
     case MACRO_ACTION_END:
-      map_[++current_id] = pos - storage_base_;
+      if (++current_id > MAX_DYNAMIC_MACROS)
+        return;
+
+      if (!previous_macro_ended && pos > last_changed &&
+          current_id + 1 < old_map_size && map_[current_id] == pos) {
+        map_size_ = old_map_size;
+        return;
+      }
+
+      map_[current_id] = pos;
+      map_size_ = current_id + 1;
 
       if (previous_macro_ended)
         return;
@@ -117,93 +183,119 @@ void DynamicMacros::updateDynamicMacroCache() {
   }
 }
 
-// public
-void DynamicMacros::play(uint8_t macro_id) {
-  macro_t macro = MACRO_ACTION_END;
-  uint8_t interval = 0;
-  uint16_t pos;
-  Key key;
-
-  pos = storage_base_ + map_[macro_id];
-
-  while (true) {
-    switch (macro = Runtime.storage().read(pos++)) {
-    case MACRO_ACTION_STEP_EXPLICIT_REPORT:
-    case MACRO_ACTION_STEP_IMPLICIT_REPORT:
-    case MACRO_ACTION_STEP_SEND_REPORT:
-      break;
+// Runs the steps of the macro being played until one of them asks for a pause,
+// or `DYNAMIC_MACRO_STEPS_PER_CYCLE` steps have run, so that a long macro never
+// holds up the rest of the firmware. Pauses are timed from when the previous
+// one ended, rather than from when we noticed, so they don't add up to more
+// than the macro asked for.
+void DynamicMacros::runMacro() {
+  for (uint8_t i = 0; playing_ && i < DYNAMIC_MACRO_STEPS_PER_CYCLE; i++) {
+    if (!Runtime.hasTimeExpired(play_wait_start_, play_wait_))
+      return;
+    play_wait_start_ += play_wait_;
+    play_wait_ = runStep();
+  }
 
-    case MACRO_ACTION_STEP_INTERVAL:
-      interval = Runtime.storage().read(pos++);
-      break;
-    case MACRO_ACTION_STEP_WAIT: {
-      uint8_t wait = Runtime.storage().read(pos++);
-      delay(wait);
-      break;
-    }
+  if (!playing_ && release_when_done_) {
+    release_when_done_ = false;
+    releaseAll();
+  }
+}
 
-    case MACRO_ACTION_STEP_KEYDOWN:
-      key.setFlags(Runtime.storage().read(pos++));
-      key.setKeyCode(Runtime.storage().read(pos++));
-      press(key);
-      break;
-    case MACRO_ACTION_STEP_KEYUP:
-      key.setFlags(Runtime.storage().read(pos++));
-      key.setKeyCode(Runtime.storage().read(pos++));
-      release(key);
-      break;
-    case MACRO_ACTION_STEP_TAP:
-      key.setFlags(Runtime.storage().read(pos++));
-      key.setKeyCode(Runtime.storage().read(pos++));
-      tap(key);
-      break;
+// Runs a single step of the macro being played, and returns the time to wait
+// before the next one, in milliseconds.
+uint16_t DynamicMacros::runStep() {
+  Key key;
 
-    case MACRO_ACTION_STEP_KEYCODEDOWN:
-      key.setFlags(0);
-      key.setKeyCode(Runtime.storage().read(pos++));
-      press(key);
-      break;
-    case MACRO_ACTION_STEP_KEYCODEUP:
-      key.setFlags(0);
-      key.setKeyCode(Runtime.storage().read(pos++));
-      release(key);
-      break;
-    case MACRO_ACTION_STEP_TAPCODE:
+  if (play_sequence_ != MACRO_ACTION_END) {
+    if (play_sequence_ == MACRO_ACTION_STEP_TAP_SEQUENCE)
+      key.setFlags(readByte(play_pos_++));
+    else
       key.setFlags(0);
-      key.setKeyCode(Runtime.storage().read(pos++));
+    key.setKeyCode(readByte(play_pos_++));
+    if (key == Key_NoKey) {
+      play_sequence_ = MACRO_ACTION_END;
+    } else {
       tap(key);
-      break;
-
-    case MACRO_ACTION_STEP_TAP_SEQUENCE: {
-      while (true) {
-        key.setFlags(0);
-        key.setKeyCode(pgm_read_byte(pos++));
-        if (key == Key_NoKey)
-          break;
-        tap(key);
-        delay(interval);
-      }
-      break;
-    }
-    case MACRO_ACTION_STEP_TAP_CODE_SEQUENCE: {
-      while (true) {
-        key.setFlags(0);
-        key.setKeyCode(pgm_read_byte(pos++));
-        if (key.getKeyCode() == 0)
-          break;
-        tap(key);
-        delay(interval);
-      }
-      break;
-    }
-
-    case MACRO_ACTION_END:
-    default:
-      return;
     }
+    return play_interval_;
+  }
 
-    delay(interval);
+  macro_t step = readByte(play_pos_++);
+  switch (step) {
+  case MACRO_ACTION_STEP_EXPLICIT_REPORT:
+  case MACRO_ACTION_STEP_IMPLICIT_REPORT:
+  case MACRO_ACTION_STEP_SEND_REPORT:
+    break;
+
+  case MACRO_ACTION_STEP_INTERVAL:
+    play_interval_ = readByte(play_pos_++);
+    break;
+  case MACRO_ACTION_STEP_WAIT:
+    return readByte(play_pos_++) + play_interval_;
+
+  case MACRO_ACTION_STEP_KEYDOWN:
+    key.setFlags(readByte(play_pos_++));
+    key.setKeyCode(readByte(play_pos_++));
+    press(key);
+    break;
+  case MACRO_ACTION_STEP_KEYUP:
+    key.setFlags(readByte(play_pos_++));
+    key.setKeyCode(readByte(play_pos_++));
+    release(key);
+    break;
+  case MACRO_ACTION_STEP_TAP:
+    key.setFlags(readByte(play_pos_++));
+    key.setKeyCode(readByte(play_pos_++));
+    tap(key);
+    break;
+
+  case MACRO_ACTION_STEP_KEYCODEDOWN:
+    key.setFlags(0);
+    key.setKeyCode(readByte(play_pos_++));
+    press(key);
+    break;
+  case MACRO_ACTION_STEP_KEYCODEUP:
+    key.setFlags(0);
+    key.setKeyCode(readByte(play_pos_++));
+    release(key);
+    break;
+  case MACRO_ACTION_STEP_TAPCODE:
+    key.setFlags(0);
+    key.setKeyCode(readByte(play_pos_++));
+    tap(key);
+    break;
+
+  case MACRO_ACTION_STEP_TAP_SEQUENCE:
+  case MACRO_ACTION_STEP_TAP_CODE_SEQUENCE:
+    // The keys of the sequence are tapped one per step, from here on.
+    play_sequence_ = step;
+    return 0;
+
+  case MACRO_ACTION_END:
+  default:
+    playing_ = false;
+    return 0;
   }
+
+  return play_interval_;
+}
+
+// public
+void DynamicMacros::play(uint8_t macro_id) {
+  if (macro_id >= map_size_ || macro_id >= MAX_DYNAMIC_MACROS)
+    return;
+
+  // Playback starts right away, and carries on in `afterEachCycle()`. Playing
+  // a macro while another one is still running stops the earlier one.
+  playing_ = true;
+  release_when_done_ = false;
+  play_pos_ = map_[macro_id];
+  play_sequence_ = MACRO_ACTION_END;
+  play_interval_ = 0;
+  play_wait_start_ = Runtime.millisAtCycleStart();
+  play_wait_ = 0;
+  runMacro();
 }
 
 bool isDynamicMacrosKey(Key key) {
@@ -219,15 +311,30 @@ EventHandlerResult DynamicMacros::onKeyEvent(KeyEvent &event) {
   if (keyToggledOn(event.state)) {
     uint8_t macro_id = event.key.getRaw() - ranges::DYNAMIC_MACRO_FIRST;
     play(macro_id);
+  } else if (playing_) {
+    // Keys held by the macro are released once it has finished, as they
+    // would have been if it had played in one go.
+    release_when_done_ = true;
   } else {
-    for (Key key : active_macro_keys_) {
-      release(key);
-    }
+    releaseAll();
   }
 
   return EventHandlerResult::EVENT_CONSUMED;
 }
 
+// -----------------------------------------------------------------------------
+EventHandlerResult DynamicMacros::afterEachCycle() {
+  if (playing_)
+    runMacro();
+
+  // A macro that's still playing is either waiting for a pause to end, or has
+  // steps left to run in the next cycle, with no pause at all.
+  if (playing_)
+    Runtime.declareDeadline(play_wait_start_, play_wait_);
+
+  return EventHandlerResult::OK;
+}
+
 EventHandlerResult DynamicMacros::onNameQuery() {
   return ::Focus.sendName(F("DynamicMacros"));
 }
@@ -248,15 +355,23 @@ EventHandlerResult DynamicMacros::onFocusEvent(const char *command) {
       }
     } else {
       uint16_t pos = 0;
+      uint16_t first_changed = 0xffff;
+      uint16_t last_changed = 0;
 
       while (!::Focus.isEOL()) {
         uint8_t b;
         ::Focus.read(b);
 
+        if (Runtime.storage().read(storage_base_ + pos) != b) {
+          if (first_changed == 0xffff)
+            first_changed = pos;
+          last_changed = pos;
+        }
         Runtime.storage().update(storage_base_ + pos++, b);
       }
       Runtime.storage().commit();
-      updateDynamicMacroCache();
+      if (first_changed != 0xffff)
+        updateDynamicMacroCache(first_changed, last_changed);
     }
   }
 
@@ -273,9 +388,23 @@ EventHandlerResult DynamicMacros::onFocusEvent(const char *command) {
 void DynamicMacros::reserve_storage(uint16_t size) {
   storage_base_ = ::EEPROMSettings.requestSlice(size);
   storage_size_ = size;
+  map_size_ = 0;
   updateDynamicMacroCache();
 }
 
+// public
+void DynamicMacros::update(uint16_t offset, const uint8_t *data, uint16_t size) {
+  if (offset >= storage_size_ || size == 0)
+    return;
+  if (size > storage_size_ - offset)
+    size = storage_size_ - offset;
+
+  for (uint16_t i = 0; i < size; i++)
+    Runtime.storage().update(storage_base_ + offset + i, data[i]);
+  Runtime.storage().commit();
+  updateDynamicMacroCache(offset, offset + size - 1);
+}
+
 } // namespace plugin
 } // namespace kaleidoscope
 
@@ -25,6 +25,9 @@
 #define DM(n) Key(kaleidoscope::ranges::DYNAMIC_MACRO_FIRST + n)
 
 #define MAX_CONCURRENT_DYNAMIC_MACRO_KEYS 8
+#define MAX_DYNAMIC_MACROS 32
+#define DYNAMIC_MACRO_STEPS_PER_CYCLE 8
+#define DYNAMIC_MACRO_READ_AHEAD 16
 
 namespace kaleidoscope {
 namespace plugin {
@@ -34,16 +37,37 @@ class DynamicMacros : public kaleidoscope::Plugin {
   EventHandlerResult onNameQuery();
   EventHandlerResult onKeyEvent(KeyEvent &event);
   EventHandlerResult onFocusEvent(const char *command);
+  EventHandlerResult afterEachCycle();
 
   static void reserve_storage(uint16_t size);
+  static void update(uint16_t offset, const uint8_t *data, uint16_t size);
 
   void play(uint8_t seq_id);
 
  private:
   static uint16_t storage_base_;
   static uint16_t storage_size_;
-  static uint16_t map_[31];
-  static void updateDynamicMacroCache();
+  static uint16_t map_[MAX_DYNAMIC_MACROS + 1];
+  static uint8_t map_size_;
+  static void updateDynamicMacroCache(uint16_t first_changed = 0,
+                                      uint16_t last_changed = 0xffff);
+
+  static uint8_t read_ahead_[DYNAMIC_MACRO_READ_AHEAD];
+  static uint16_t read_ahead_start_;
+  static uint8_t read_ahead_size_;
+  static uint8_t readByte(uint16_t pos);
+
+  static bool playing_;
+  static bool release_when_done_;
+  static uint16_t play_pos_;
+  static macro_t play_sequence_;
+  static uint8_t play_interval_;
+  static uint16_t play_wait_start_;
+  static uint16_t play_wait_;
+  static void runMacro();
+  static uint16_t runStep();
+  static void releaseAll();
+
   static Key active_macro_keys_[MAX_CONCURRENT_DYNAMIC_MACRO_KEYS];
   static void press(Key key);
   static void release(Key key);
@@ -26,6 +26,7 @@ namespace plugin {
 struct EEPROMSettings::settings EEPROMSettings::settings_;
 bool EEPROMSettings::is_valid_;
 bool EEPROMSettings::sealed_;
+uint8_t EEPROMSettings::generation_;
 uint16_t EEPROMSettings::next_start_ = sizeof(EEPROMSettings::settings);
 
 EventHandlerResult EEPROMSettings::onSetup() {
@@ -233,6 +234,7 @@ EventHandlerResult FocusEEPROMCommand::onFocusEvent(const char *command) {
         ::Focus.read(d);
         Runtime.storage().update(i, d);
       }
+      ::EEPROMSettings.contentsReplaced();
     }
 
     break;
@@ -57,6 +57,17 @@ class EEPROMSettings : public kaleidoscope::Plugin {
   static uint16_t crc(void);
   static uint16_t used(void);
 
+  /* Changes every time the storage is overwritten wholesale, such as through
+   * the `eeprom.contents` Focus command, so that plugins that keep a copy of
+   * parts of it in RAM can tell when to reload them, wherever they are in the
+   * plugin list. */
+  static uint8_t generation(void) {
+    return generation_;
+  }
+  static void contentsReplaced(void) {
+    generation_++;
+  }
+
   static uint8_t default_layer(uint8_t layer);
   static uint8_t default_layer() {
     return settings_.default_layer;
@@ -71,6 +82,7 @@ class EEPROMSettings : public kaleidoscope::Plugin {
   static uint16_t next_start_;
   static bool is_valid_;
   static bool sealed_;
+  static uint8_t generation_;
 
   static struct settings {
     uint8_t default_layer: 7;
@@ -28,6 +28,12 @@ namespace plugin {
 
 uint16_t FingerPainter::color_base_;
 bool FingerPainter::edit_mode_;
+uint16_t FingerPainter::flush_timeout = 5000;
+uint8_t FingerPainter::theme_[FingerPainter::theme_size_];
+uint8_t FingerPainter::dirty_[(kaleidoscope::Device::led_count + 7) / 8];
+bool FingerPainter::has_dirty_;
+uint16_t FingerPainter::last_paint_time_;
+uint8_t FingerPainter::next_color_[16];
 
 EventHandlerResult FingerPainter::onNameQuery() {
   return ::Focus.sendName(F("FingerPainter"));
@@ -39,15 +45,83 @@ EventHandlerResult FingerPainter::onSetup() {
 }
 
 void FingerPainter::update(void) {
-  ::LEDPaletteTheme.updateHandler(color_base_, 0);
+  if (!edit_mode_) {
+    ::LEDPaletteTheme.updateHandler(color_base_, 0);
+    return;
+  }
+
+  for (uint8_t pos = 0; pos < Runtime.device().led_count; pos++)
+    ::LEDControl.setCrgbAt(pos, ::LEDPaletteTheme.lookupPaletteColor(colorIndexAt(pos)));
 }
 
 void FingerPainter::refreshAt(KeyAddr key_addr) {
-  ::LEDPaletteTheme.refreshAt(color_base_, 0, key_addr);
+  if (!edit_mode_) {
+    ::LEDPaletteTheme.refreshAt(color_base_, 0, key_addr);
+    return;
+  }
+
+  uint8_t pos = Runtime.device().getLedIndex(key_addr);
+  ::LEDControl.setCrgbAt(key_addr, ::LEDPaletteTheme.lookupPaletteColor(colorIndexAt(pos)));
 }
 
 void FingerPainter::toggle(void) {
   edit_mode_ = !edit_mode_;
+
+  if (edit_mode_) {
+    loadTheme();
+    findNextColors();
+  } else {
+    flush();
+  }
+}
+
+void FingerPainter::flush(void) {
+  if (!has_dirty_)
+    return;
+
+  for (uint8_t i = 0; i < theme_size_; i++) {
+    // The two LEDs of a byte are next to each other in `dirty_`, so the byte
+    // has to be written if either of their bits is set.
+    if (dirty_[i / 4] & (0b11 << (i % 4 * 2)))
+      Runtime.storage().update(color_base_ + i, theme_[i]);
+  }
+  Runtime.storage().commit();
+
+  memset(dirty_, 0, sizeof(dirty_));
+  has_dirty_ = false;
+
+  // The theme cache of LEDPaletteTheme may hold the old theme.
+  ::LEDPaletteTheme.invalidateCache();
+}
+
+void FingerPainter::loadTheme() {
+  Runtime.storage().get(color_base_, theme_);
+  memset(dirty_, 0, sizeof(dirty_));
+  has_dirty_ = false;
+}
+
+void FingerPainter::findNextColors() {
+  for (uint8_t color_index = 0; color_index < 16; color_index++) {
+    cRGB color = ::LEDPaletteTheme.lookupPaletteColor(color_index);
+
+    // Find the next color in the palette that is different, wrapping around
+    // at the end. If all of them are the same, go back to the first one.
+    next_color_[color_index] = 0;
+    for (uint8_t i = 1; i < 16; i++) {
+      uint8_t next_index = (color_index + i) % 16;
+      cRGB next_color = ::LEDPaletteTheme.lookupPaletteColor(next_index);
+      if (memcmp(&color, &next_color, sizeof(cRGB)) != 0) {
+        next_color_[color_index] = next_index;
+        break;
+      }
+    }
+  }
+}
+
+uint8_t FingerPainter::colorIndexAt(uint8_t pos) {
+  if (pos % 2)
+    return theme_[pos / 2] & ~0xf0;
+  return theme_[pos / 2] >> 4;
 }
 
 EventHandlerResult FingerPainter::onKeyEvent(KeyEvent &event) {
@@ -63,32 +137,35 @@ EventHandlerResult FingerPainter::onKeyEvent(KeyEvent &event) {
 
   // TODO(anyone): The following works only for keyboards with LEDs for each key.
 
-  uint8_t color_index = ::LEDPaletteTheme
-                        .lookupColorIndexAtPosition(color_base_,
-                                                    Runtime.device().getLedIndex(event.addr));
-
-  // Find the next color in the palette that is different.
-  // But do not loop forever!
-  bool turn_around = false;
-  cRGB old_color = ::LEDPaletteTheme.lookupPaletteColor(color_index), new_color = old_color;
-  while (memcmp(&old_color, &new_color, sizeof(cRGB)) == 0) {
-    color_index++;
-    if (color_index > 15) {
-      color_index = 0;
-      if (turn_around)
-        break;
-      turn_around = true;
-    }
-    new_color = ::LEDPaletteTheme.lookupPaletteColor(color_index);
-  }
+  uint8_t pos = Runtime.device().getLedIndex(event.addr);
+  uint8_t color_index = next_color_[colorIndexAt(pos)];
+
+  if (pos % 2)
+    theme_[pos / 2] = (theme_[pos / 2] & 0xf0) | color_index;
+  else
+    theme_[pos / 2] = (color_index << 4) | (theme_[pos / 2] & ~0xf0);
+
+  bitSet(dirty_[pos / 8], pos % 8);
+  has_dirty_ = true;
+  last_paint_time_ = Runtime.millisAtCycleStart();
 
-  ::LEDPaletteTheme.updateColorIndexAtPosition(color_base_,
-                                               Runtime.device().getLedIndex(event.addr),
-                                               color_index);
+  ::LEDControl.setCrgbAt(event.addr, ::LEDPaletteTheme.lookupPaletteColor(color_index));
 
   return EventHandlerResult::EVENT_CONSUMED;
 }
 
+EventHandlerResult FingerPainter::afterEachCycle() {
+  if (!has_dirty_)
+    return EventHandlerResult::OK;
+
+  if (Runtime.hasTimeExpired(last_paint_time_, flush_timeout))
+    flush();
+  else
+    Runtime.declareDeadline(last_paint_time_, flush_timeout);
+
+  return EventHandlerResult::OK;
+}
+
 EventHandlerResult FingerPainter::onFocusEvent(const char *command) {
   enum {
     TOGGLE,
@@ -109,10 +186,14 @@ EventHandlerResult FingerPainter::onFocusEvent(const char *command) {
     return EventHandlerResult::OK;
 
   if (sub_command == CLEAR) {
-    for (uint16_t i = 0; i < Runtime.device().numKeys() / 2; i++) {
-      Runtime.storage().update(color_base_ + i, 0);
-    }
+    // The RAM copy of the theme is cleared too, so that painting can go on
+    // from the cleared theme, and the whole of it is written in one go.
+    memset(theme_, 0, sizeof(theme_));
+    Runtime.storage().put(color_base_, theme_);
     Runtime.storage().commit();
+    memset(dirty_, 0, sizeof(dirty_));
+    has_dirty_ = false;
+    ::LEDPaletteTheme.invalidateCache();
     return EventHandlerResult::OK;
   }
 
@@ -31,19 +31,42 @@ class FingerPainter : public LEDMode {
   FingerPainter(void) {}
 
   static void toggle(void);
+  static void flush(void);
+
+  // How long painting has to pause for before the theme is written to
+  // storage, in milliseconds.
+  static uint16_t flush_timeout;
 
   EventHandlerResult onKeyEvent(KeyEvent &event);
   EventHandlerResult onFocusEvent(const char *command);
   EventHandlerResult onSetup();
   EventHandlerResult onNameQuery();
+  EventHandlerResult afterEachCycle();
 
  protected:
   void update(void) final;
   void refreshAt(KeyAddr key_addr) final;
 
  private:
+  static constexpr uint8_t theme_size_ = (kaleidoscope::Device::led_count + 1) / 2;
+
   static uint16_t color_base_;
   static bool edit_mode_;
+
+  // While editing, the theme is painted in RAM, and only written to storage
+  // once painting pauses, or edit mode ends. Each bit of `dirty_` stands for
+  // an LED whose color index changed since then.
+  static uint8_t theme_[theme_size_];
+  static uint8_t dirty_[(kaleidoscope::Device::led_count + 7) / 8];
+  static bool has_dirty_;
+  static uint16_t last_paint_time_;
+
+  // The index of the next palette color that differs from each one.
+  static uint8_t next_color_[16];
+
+  static void loadTheme();
+  static void findNextColors();
+  static uint8_t colorIndexAt(uint8_t pos);
 };
 }
 }
@@ -0,0 +1,73 @@
+/* -*- mode: c++ -*-
+ * Kaleidoscope-FlightRecorder -- Focus commands to dump the trace of recent key events
+ * Copyright (C) 2021  Keyboard.io, Inc
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Kaleidoscope-FlightRecorder.h"
+#include "Kaleidoscope-FocusSerial.h"
+
+#include "kaleidoscope/TraceRing.h"
+
+namespace kaleidoscope {
+namespace plugin {
+
+EventHandlerResult FlightRecorder::onNameQuery() {
+  return ::Focus.sendName(F("FlightRecorder"));
+}
+
+EventHandlerResult FlightRecorder::onFocusEvent(const char *command) {
+  if (::Focus.handleHelp(command, PSTR("trace.dump\ntrace.clear")))
+    return EventHandlerResult::OK;
+
+  if (strncmp_P(command, PSTR("trace."), 6) != 0)
+    return EventHandlerResult::OK;
+
+#if KALEIDOSCOPE_TRACE_RING_SIZE
+  if (strcmp_P(command + 6, PSTR("dump")) == 0) {
+    // The first line is the format version, the number of entries that follow,
+    // and the low 16 bits of the current time, to which the timestamps of the
+    // entries can be compared. The entries follow one per line, oldest first.
+    uint16_t count = trace_ring.count();
+    ::Focus.send(TraceRing::format_version, count,
+                 uint16_t(Runtime.millisAtCycleStart()));
+    for (uint16_t i = 0; i < count; i++) {
+      const TraceEntry &entry = trace_ring.entry(i);
+      ::Focus.sendRaw(::Focus.NEWLINE);
+      ::Focus.send(entry.timestamp,
+                   uint8_t(entry.event),
+                   int(entry.id),
+                   entry.addr,
+                   entry.state,
+                   entry.key,
+                   entry.handler,
+                   uint8_t(entry.result));
+    }
+  } else if (strcmp_P(command + 6, PSTR("clear")) == 0) {
+    trace_ring.clear();
+  }
+#else
+  // Without a trace ring, there is nothing to dump, which we say with a
+  // version of 0, so the host can tell that apart from an empty trace.
+  if (strcmp_P(command + 6, PSTR("dump")) == 0)
+    ::Focus.send(0);
+#endif
+
+  return EventHandlerResult::EVENT_CONSUMED;
+}
+
+}
+}
+
+kaleidoscope::plugin::FlightRecorder FlightRecorder;
@@ -0,0 +1,36 @@
+/* -*- mode: c++ -*-
+ * Kaleidoscope-FlightRecorder -- Focus commands to dump the trace of recent key events
+ * Copyright (C) 2021  Keyboard.io, Inc
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "kaleidoscope/Runtime.h"
+
+namespace kaleidoscope {
+namespace plugin {
+
+class FlightRecorder: public kaleidoscope::Plugin {
+ public:
+  FlightRecorder() {}
+
+  EventHandlerResult onNameQuery();
+  EventHandlerResult onFocusEvent(const char *command);
+};
+
+}
+}
+
+extern kaleidoscope::plugin::FlightRecorder FlightRecorder;
@@ -27,11 +27,157 @@ bool GhostInTheFirmware::is_active_ = false;
 uint16_t GhostInTheFirmware::current_pos_ = 0;
 uint16_t GhostInTheFirmware::start_time_;
 
+const GhostInTheFirmware::TimelineKey *GhostInTheFirmware::timeline;
+uint16_t GhostInTheFirmware::rate = 100;
+uint8_t GhostInTheFirmware::jitter = 0;
+uint16_t GhostInTheFirmware::repeat = 1;
+bool GhostInTheFirmware::timeline_active_ = false;
+bool GhostInTheFirmware::timeline_started_;
+uint16_t GhostInTheFirmware::timeline_pos_;
+uint16_t GhostInTheFirmware::timeline_repeats_;
+uint32_t GhostInTheFirmware::timeline_start_;
+GhostInTheFirmware::TimelineKey GhostInTheFirmware::next_key_;
+uint32_t GhostInTheFirmware::next_press_time_;
+GhostInTheFirmware::HeldKey GhostInTheFirmware::held_keys_[GHOST_MAX_HELD_KEYS];
+uint32_t GhostInTheFirmware::random_state_ = 1;
+
 void GhostInTheFirmware::activate(void) {
   is_active_ = true;
 }
 
+void GhostInTheFirmware::playTimeline(void) {
+  timeline_repeats_ = 0;
+  timeline_started_ = false;
+  timeline_active_ = true;
+}
+
+void GhostInTheFirmware::stopTimeline(void) {
+  for (HeldKey &held_key : held_keys_) {
+    if (held_key.addr.isValid())
+      releaseKey(held_key);
+  }
+  timeline_active_ = false;
+}
+
+void GhostInTheFirmware::seed(uint32_t seed) {
+  // The generator would only ever return zero if its state was zero.
+  random_state_ = seed ? seed : 1;
+}
+
+// A xorshift generator, rather than `random()`, so that the same seed gives the
+// same jitter on every device, and in the virtual build.
+uint8_t GhostInTheFirmware::jitterTime() {
+  if (jitter == 0)
+    return 0;
+
+  random_state_ ^= random_state_ << 13;
+  random_state_ ^= random_state_ >> 17;
+  random_state_ ^= random_state_ << 5;
+  return random_state_ % (uint16_t(jitter) + 1);
+}
+
+uint32_t GhostInTheFirmware::scaled(uint16_t time) {
+  // A rate of zero would stop the timeline, if it didn't divide by zero; it is
+  // played at the slowest rate there is instead.
+  uint16_t r = rate ? rate : 1;
+  return uint32_t(time) * 100 / r;
+}
+
+void GhostInTheFirmware::loadNextKey() {
+  loadFromProgmem(timeline[timeline_pos_], next_key_);
+  if (next_key_.addr.isValid())
+    next_press_time_ = scaled(next_key_.start) + jitterTime();
+}
+
+void GhostInTheFirmware::restartTimeline() {
+  timeline_pos_ = 0;
+  timeline_start_ = Runtime.millisAtCycleStart();
+  loadNextKey();
+}
+
+void GhostInTheFirmware::releaseKey(HeldKey &held_key) {
+  Runtime.handleKeyswitchEvent(KeyEvent(held_key.addr, WAS_PRESSED));
+  held_key.addr.clear();
+}
+
+bool GhostInTheFirmware::pressKey(uint32_t now) {
+  // If the key is still held from an earlier press, release it first, so that
+  // every press has a matching release.
+  HeldKey *slot = nullptr;
+  for (HeldKey &held_key : held_keys_) {
+    if (held_key.addr == next_key_.addr) {
+      releaseKey(held_key);
+      slot = &held_key;
+      break;
+    }
+    if (slot == nullptr && !held_key.addr.isValid())
+      slot = &held_key;
+  }
+
+  if (slot == nullptr)
+    return false;
+
+  Runtime.handleKeyswitchEvent(KeyEvent(next_key_.addr, IS_PRESSED));
+  slot->addr = next_key_.addr;
+  slot->release_time = now + scaled(next_key_.press_time) + jitterTime();
+  return true;
+}
+
+void GhostInTheFirmware::timelineCycle() {
+  // The timeline starts in the first cycle it's played in, so that its times
+  // don't depend on when in a cycle it was started.
+  if (!timeline_started_) {
+    restartTimeline();
+    timeline_started_ = true;
+  }
+
+  uint32_t now = Runtime.millisAtCycleStart() - timeline_start_;
+  bool holding = false;
+
+  for (HeldKey &held_key : held_keys_) {
+    if (!held_key.addr.isValid())
+      continue;
+    if (now >= held_key.release_time) {
+      releaseKey(held_key);
+    } else {
+      holding = true;
+    }
+  }
+
+  // At a high rate, or after a slow cycle, more than one key can be due, and
+  // they're all pressed in this cycle, as a real burst of keys would be.
+  while (next_key_.addr.isValid() && now >= next_press_time_) {
+    if (!pressKey(now))
+      break;
+    holding = true;
+    ++timeline_pos_;
+    loadNextKey();
+  }
+
+  // The next press or release is due at whichever of their times comes first.
+  for (HeldKey &held_key : held_keys_) {
+    if (held_key.addr.isValid())
+      Runtime.declareDeadline(timeline_start_, held_key.release_time);
+  }
+  if (next_key_.addr.isValid())
+    Runtime.declareDeadline(timeline_start_, next_press_time_);
+
+  if (next_key_.addr.isValid() || holding)
+    return;
+
+  // Every key of the timeline has been pressed and released.
+  if (repeat != 0 && ++timeline_repeats_ >= repeat) {
+    timeline_active_ = false;
+    return;
+  }
+  timeline_started_ = false;
+  Runtime.declareDeadline(Runtime.millisAtCycleStart(), 1);
+}
+
 EventHandlerResult GhostInTheFirmware::afterEachCycle() {
+  if (timeline_active_)
+    timelineCycle();
+
   if (!is_active_)
     return EventHandlerResult::OK;
 
@@ -54,7 +200,7 @@ EventHandlerResult GhostInTheFirmware::afterEachCycle() {
     }
     // If we're not at the end of the sequence, send the first keypress event,
     // and start the timer.
-    Runtime.handleKeyEvent(KeyEvent(ghost_key.addr, IS_PRESSED));
+    Runtime.handleKeyswitchEvent(KeyEvent(ghost_key.addr, IS_PRESSED));
     start_time_ = Runtime.millisAtCycleStart();
 
   } else if (ghost_key.addr.isValid()) {
@@ -62,7 +208,7 @@ EventHandlerResult GhostInTheFirmware::afterEachCycle() {
     // key is still being held.
     if (Runtime.hasTimeExpired(start_time_, ghost_key.press_time)) {
       // The key press has timed out, so we send the release event.
-      Runtime.handleKeyEvent(KeyEvent(ghost_key.addr, WAS_PRESSED));
+      Runtime.handleKeyswitchEvent(KeyEvent(ghost_key.addr, WAS_PRESSED));
       // Next, we invalidate the ghost key's address to prevent checking the
       // hold timeout again, then restart the timer for checking the delay.
       ghost_key.addr.clear();
@@ -77,6 +223,16 @@ EventHandlerResult GhostInTheFirmware::afterEachCycle() {
     ++current_pos_;
   }
 
+  // The key is released once its press time is up, and the next one pressed
+  // once the delay after it is; with the delay over, that's the next cycle.
+  if (ghost_key.delay == 0) {
+    Runtime.declareDeadline(Runtime.millisAtCycleStart(), 1);
+  } else if (ghost_key.addr.isValid()) {
+    Runtime.declareDeadline(start_time_, ghost_key.press_time);
+  } else {
+    Runtime.declareDeadline(start_time_, ghost_key.delay);
+  }
+
   return EventHandlerResult::OK;
 }
 
@@ -19,6 +19,12 @@
 
 #include "kaleidoscope/Runtime.h"
 
+// The number of keys a timeline can hold at the same time. Keys that would go
+// over this wait until one is released.
+#ifndef GHOST_MAX_HELD_KEYS
+#define GHOST_MAX_HELD_KEYS 8
+#endif
+
 namespace kaleidoscope {
 namespace plugin {
 class GhostInTheFirmware : public kaleidoscope::Plugin {
@@ -30,16 +36,65 @@ class GhostInTheFirmware : public kaleidoscope::Plugin {
   };
   static const GhostKey *ghost_keys;
 
+  // A key in a timeline: pressed `start` milliseconds after the timeline
+  // starts, and held for `press_time` milliseconds, regardless of the keys
+  // around it, so presses can overlap.
+  struct TimelineKey {
+    KeyAddr addr;
+    uint16_t start;
+    uint16_t press_time;
+  };
+  static const TimelineKey *timeline;
+
+  // The speed of the timeline, in percent of the times in it. Zero is taken to
+  // be one.
+  static uint16_t rate;
+  // The most a press or release may be delayed by, in milliseconds, chosen at
+  // random for each of them.
+  static uint8_t jitter;
+  // How many times to play the timeline; zero repeats it until `stopTimeline()`.
+  static uint16_t repeat;
+
   GhostInTheFirmware(void) {}
 
   static void activate(void);
 
+  static void playTimeline(void);
+  static void stopTimeline(void);
+  static bool isPlayingTimeline(void) {
+    return timeline_active_;
+  }
+  static void seed(uint32_t seed);
+
   EventHandlerResult afterEachCycle();
 
  private:
   static bool is_active_;
   static uint16_t current_pos_;
   static uint16_t start_time_;
+
+  struct HeldKey {
+    KeyAddr addr;
+    uint32_t release_time;
+  };
+
+  static bool timeline_active_;
+  static bool timeline_started_;
+  static uint16_t timeline_pos_;
+  static uint16_t timeline_repeats_;
+  static uint32_t timeline_start_;
+  static TimelineKey next_key_;
+  static uint32_t next_press_time_;
+  static HeldKey held_keys_[GHOST_MAX_HELD_KEYS];
+  static uint32_t random_state_;
+
+  static uint8_t jitterTime();
+  static uint32_t scaled(uint16_t time);
+  static void loadNextKey();
+  static void restartTimeline();
+  static void releaseKey(HeldKey &held_key);
+  static bool pressKey(uint32_t now);
+  static void timelineCycle();
 };
 }
 }
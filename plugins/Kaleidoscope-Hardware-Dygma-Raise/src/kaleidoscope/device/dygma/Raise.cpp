@@ -145,8 +145,7 @@ constexpr uint8_t RaiseLEDDriver::led_map[][RaiseLEDDriverProps::led_count + 1];
 constexpr uint8_t RaiseLEDDriverProps::key_led_map[];
 
 void RaiseLEDDriver::setBrightness(uint8_t brightness) {
-  RaiseHands::leftHand.setBrightness(brightness);
-  RaiseHands::rightHand.setBrightness(brightness);
+  raise::RaiseSide::setBrightness(brightness);
   for (uint8_t i = 0; i < LED_BANKS; i++) {
     isLEDChangedLeft[i] = true;
     isLEDChangedRight[i] = true;
@@ -154,7 +153,7 @@ void RaiseLEDDriver::setBrightness(uint8_t brightness) {
 }
 
 uint8_t RaiseLEDDriver::getBrightness() {
-  return RaiseHands::leftHand.getBrightness();
+  return raise::RaiseSide::getBrightness();
 }
 
 void RaiseLEDDriver::syncLeds() {
@@ -21,7 +21,6 @@
 #include <Arduino.h>
 #include "RaiseSide.h"
 
-#include "kaleidoscope/driver/color/GammaCorrection.h"
 
 namespace kaleidoscope {
 namespace device {
@@ -217,19 +216,13 @@ void RaiseSide::sendLEDData() {
   }
 }
 
-auto constexpr gamma8 = kaleidoscope::driver::color::gamma_correction;
+kaleidoscope::driver::led::ColorCorrection RaiseSide::color_correction_;
 
 void RaiseSide::sendLEDBank(uint8_t bank) {
   uint8_t data[LED_BYTES_PER_BANK + 1]; // + 1 for the update LED command itself
   data[0]  = TWI_CMD_LED_BASE + bank;
   for (uint8_t i = 0 ; i < LED_BYTES_PER_BANK; i++) {
-    uint8_t c = led_data.bytes[bank][i];
-    if (c > brightness_adjustment_)
-      c -= brightness_adjustment_;
-    else
-      c = 0;
-
-    data[i + 1] = pgm_read_byte(&gamma8[c]);
+    data[i + 1] = color_correction_.apply(led_data.bytes[bank][i]);
 
     // The Red component on the Raise hardware appears to get more voltage than
     // the others, resulting in colors slightly off. Adjust for that here by
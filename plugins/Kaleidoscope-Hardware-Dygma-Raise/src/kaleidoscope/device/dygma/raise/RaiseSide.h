@@ -22,6 +22,7 @@
 
 #include <Arduino.h>
 #include "TWI.h"
+#include "kaleidoscope/driver/led/ColorCorrection.h"
 
 struct cRGB {
   uint8_t r;
@@ -81,18 +82,19 @@ class RaiseSide {
     return twi_.crc_errors();
   }
 
-  void setBrightness(uint8_t brightness) {
-    brightness_adjustment_ = 255 - brightness;
+  // Brightness is shared by both halves.
+  static void setBrightness(uint8_t brightness) {
+    color_correction_.setBrightness(brightness);
   }
-  uint8_t getBrightness() {
-    return 255 - brightness_adjustment_;
+  static uint8_t getBrightness() {
+    return color_correction_.getBrightness();
   }
 
   LEDData_t led_data;
   bool online = false;
 
  private:
-  uint8_t brightness_adjustment_ = 0;
+  static kaleidoscope::driver::led::ColorCorrection color_correction_;
   int ad01_;
   TWI twi_;
   keydata_t key_data_;
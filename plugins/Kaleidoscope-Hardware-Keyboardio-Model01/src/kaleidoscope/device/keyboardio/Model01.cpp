@@ -62,13 +62,12 @@ void Model01Hands::setup(void) {
 bool Model01LEDDriver::isLEDChanged = true;
 
 void Model01LEDDriver::setBrightness(uint8_t brightness) {
-  Model01Hands::leftHand.setBrightness(brightness);
-  Model01Hands::rightHand.setBrightness(brightness);
+  driver::keyboardio::Model01Side::setBrightness(brightness);
   isLEDChanged = true;
 }
 
 uint8_t Model01LEDDriver::getBrightness() {
-  return Model01Hands::leftHand.getBrightness();
+  return driver::keyboardio::Model01Side::getBrightness();
 }
 
 void Model01LEDDriver::setCrgbAt(uint8_t i, cRGB crgb) {
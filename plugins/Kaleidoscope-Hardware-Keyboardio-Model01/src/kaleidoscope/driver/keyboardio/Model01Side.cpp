@@ -40,6 +40,8 @@ namespace keyboardio {
 
 uint8_t twi_uninitialized = 1;
 
+kaleidoscope::driver::led::ColorCorrection Model01Side::color_correction_;
+
 Model01Side::Model01Side(byte setAd01) {
   ad01 = setAd01;
   addr = SCANNER_I2C_ADDR_BASE | ad01;
@@ -176,13 +178,7 @@ void Model01Side::sendLEDBank(byte bank) {
      * limited to 32 levels, and those aren't nicely spread out either. For this
      * reason, we're doing our own brightness adjustment on this side, because
      * that results in a considerably smoother curve. */
-    uint8_t c = ledData.bytes[bank][i];
-    if (c > brightness_adjustment_)
-      c -= brightness_adjustment_;
-    else
-      c = 0;
-
-    data[i + 1] = pgm_read_byte(&gamma8[c]);
+    data[i + 1] = color_correction_.apply(ledData.bytes[bank][i]);
   }
   uint8_t result = twi_writeTo(addr, data, ELEMENTS(data), 1, 0);
 }
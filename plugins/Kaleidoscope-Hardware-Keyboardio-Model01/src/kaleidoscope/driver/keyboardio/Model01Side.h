@@ -25,6 +25,7 @@
 
 #include <Arduino.h>
 #include "wire-protocol-constants.h"
+#include "kaleidoscope/driver/led/ColorCorrection.h"
 
 // We allow cRGB/CRGB to be defined already when this is included.
 //
@@ -81,15 +82,16 @@ class Model01Side {
   LEDData_t ledData;
   uint8_t controllerAddress();
 
-  void setBrightness(uint8_t brightness) {
-    brightness_adjustment_ = 255 - brightness;
+  // Brightness is shared by both halves.
+  static void setBrightness(uint8_t brightness) {
+    color_correction_.setBrightness(brightness);
   }
-  uint8_t getBrightness() {
-    return 255 - brightness_adjustment_;
+  static uint8_t getBrightness() {
+    return color_correction_.getBrightness();
   }
 
  private:
-  uint8_t brightness_adjustment_ = 0;
+  static kaleidoscope::driver::led::ColorCorrection color_correction_;
   int addr;
   int ad01;
   keydata_t keyData;
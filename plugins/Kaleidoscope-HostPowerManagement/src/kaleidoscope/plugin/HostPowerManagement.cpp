@@ -19,10 +19,6 @@
 #include <Kaleidoscope-HostPowerManagement.h>
 #include <Kaleidoscope-LEDControl.h>
 
-// This is a terrible hack until Arduino#6964 gets implemented.
-// It makes the `_usbSuspendState` symbol available to us.
-extern uint8_t _usbSuspendState;
-
 namespace kaleidoscope {
 namespace plugin {
 
@@ -31,8 +27,7 @@ bool HostPowerManagement::initial_suspend_ = true;
 
 EventHandlerResult HostPowerManagement::beforeEachCycle() {
 
-#ifdef __AVR__
-  if ((_usbSuspendState & (1 << SUSPI))) {
+  if (Runtime.device().isHostSuspended()) {
     if (!initial_suspend_) {
       if (!was_suspended_) {
         was_suspended_ = true;
@@ -49,7 +44,6 @@ EventHandlerResult HostPowerManagement::beforeEachCycle() {
       hostPowerManagementEventHandler(Resume);
     }
   }
-#endif
 
   return EventHandlerResult::OK;
 }
@@ -26,7 +26,9 @@ namespace plugin {
 
 uint32_t IdleLEDs::idle_time_limit = 600000; // 10 minutes
 uint32_t IdleLEDs::start_time_     = 0;
+bool IdleLEDs::off_while_suspended = true;
 bool IdleLEDs::idle_;
+bool IdleLEDs::suspended_;
 
 uint32_t IdleLEDs::idleTimeoutSeconds() {
   return idle_time_limit / 1000;
@@ -37,13 +39,42 @@ void IdleLEDs::setIdleTimeoutSeconds(uint32_t new_limit) {
 }
 
 EventHandlerResult IdleLEDs::beforeEachCycle() {
+  // While the host is suspended, nobody is looking at the keyboard, so turn
+  // the LEDs off, however long the timeout is, unless it's zero, which turns
+  // the plugin off. When the host resumes, turn them back on, unless the
+  // timeout would have turned them off by now anyway.
+  if (off_while_suspended && idle_time_limit != 0 &&
+      Runtime.device().isHostSuspended()) {
+    if (!suspended_) {
+      suspended_ = true;
+      if (::LEDControl.isEnabled()) {
+        ::LEDControl.disable();
+        idle_ = true;
+      }
+    }
+    return EventHandlerResult::OK;
+  }
+
+  if (suspended_) {
+    suspended_ = false;
+    if (idle_ && (idle_time_limit == 0 ||
+                  !Runtime.hasTimeExpired(start_time_, idle_time_limit))) {
+      if (!::LEDControl.isEnabled())
+        ::LEDControl.enable();
+      idle_ = false;
+    }
+  }
+
   if (idle_time_limit == 0)
     return EventHandlerResult::OK;
 
-  if (::LEDControl.isEnabled() &&
-      Runtime.hasTimeExpired(start_time_, idle_time_limit)) {
-    ::LEDControl.disable();
-    idle_ = true;
+  if (::LEDControl.isEnabled()) {
+    if (Runtime.hasTimeExpired(start_time_, idle_time_limit)) {
+      ::LEDControl.disable();
+      idle_ = true;
+    } else {
+      Runtime.declareDeadline(start_time_, idle_time_limit);
+    }
   }
 
   return EventHandlerResult::OK;
@@ -28,6 +28,7 @@ class IdleLEDs: public kaleidoscope::Plugin {
   IdleLEDs(void) {}
 
   static uint32_t idle_time_limit;
+  static bool off_while_suspended;
 
   static uint32_t idleTimeoutSeconds();
   static void setIdleTimeoutSeconds(uint32_t new_limit);
@@ -37,6 +38,7 @@ class IdleLEDs: public kaleidoscope::Plugin {
 
  private:
   static bool idle_;
+  static bool suspended_;
   static uint32_t start_time_;
 };
 
@@ -23,6 +23,13 @@ namespace kaleidoscope {
 namespace plugin {
 
 uint16_t LEDPaletteTheme::palette_base_;
+cRGB LEDPaletteTheme::palette_[16];
+bool LEDPaletteTheme::palette_cached_;
+uint8_t LEDPaletteTheme::cache_generation_;
+#if KALEIDOSCOPE_LED_PALETTE_THEME_CACHE_ROW
+uint16_t LEDPaletteTheme::cached_row_base_ = -1;
+uint8_t LEDPaletteTheme::cached_row_[LEDPaletteTheme::row_size_];
+#endif
 
 uint16_t LEDPaletteTheme::reserveThemes(uint8_t max_themes) {
   if (!palette_base_)
@@ -43,6 +50,44 @@ void LEDPaletteTheme::updateHandler(uint16_t theme_base, uint8_t theme) {
   }
 }
 
+void LEDPaletteTheme::updateHandler(uint16_t theme_base, uint8_t theme, uint8_t previous_theme) {
+  if (!Runtime.has_leds)
+    return;
+
+  uint16_t map_base = theme_base + (theme * Runtime.device().led_count / 2);
+  uint16_t previous_base = theme_base + (previous_theme * Runtime.device().led_count / 2);
+
+  // Only repaint the keys whose color index differs between the two themes,
+  // the rest of the LEDs already display the right color.
+#if KALEIDOSCOPE_LED_PALETTE_THEME_CACHE_ROW
+  validateCache();
+  uint8_t previous_row[row_size_];
+  if (cached_row_base_ == previous_base)
+    memcpy(previous_row, cached_row_, row_size_);
+  else
+    Runtime.storage().get(previous_base, previous_row);
+  cacheRow(map_base);
+#endif
+
+  for (uint8_t pos = 0; pos < Runtime.device().led_count; pos += 2) {
+#if KALEIDOSCOPE_LED_PALETTE_THEME_CACHE_ROW
+    uint8_t indexes = cached_row_[pos / 2];
+    uint8_t previous_indexes = previous_row[pos / 2];
+#else
+    uint8_t indexes = Runtime.storage().read(map_base + pos / 2);
+    uint8_t previous_indexes = Runtime.storage().read(previous_base + pos / 2);
+#endif
+
+    if (indexes == previous_indexes)
+      continue;
+
+    if ((indexes ^ previous_indexes) & 0xf0)
+      ::LEDControl.setCrgbAt(pos, lookupPaletteColor(indexes >> 4));
+    if (((indexes ^ previous_indexes) & ~0xf0) && pos + 1 < Runtime.device().led_count)
+      ::LEDControl.setCrgbAt(pos + 1, lookupPaletteColor(indexes & ~0xf0));
+  }
+}
+
 void LEDPaletteTheme::refreshAt(uint16_t theme_base, uint8_t theme, KeyAddr key_addr) {
   if (!Runtime.has_leds)
     return;
@@ -58,7 +103,14 @@ void LEDPaletteTheme::refreshAt(uint16_t theme_base, uint8_t theme, KeyAddr key_
 const uint8_t LEDPaletteTheme::lookupColorIndexAtPosition(uint16_t map_base, uint16_t position) {
   uint8_t color_index;
 
+#if KALEIDOSCOPE_LED_PALETTE_THEME_CACHE_ROW
+  validateCache();
+  if (map_base != cached_row_base_)
+    cacheRow(map_base);
+  color_index = cached_row_[position / 2];
+#else
   color_index = Runtime.storage().read(map_base + position / 2);
+#endif
   if (position % 2)
     color_index &= ~0xf0;
   else
@@ -74,14 +126,44 @@ const cRGB LEDPaletteTheme::lookupColorAtPosition(uint16_t map_base, uint16_t po
 }
 
 const cRGB LEDPaletteTheme::lookupPaletteColor(uint8_t color_index) {
-  cRGB color;
+  validateCache();
+  if (!palette_cached_)
+    cachePalette();
+
+  return palette_[color_index];
+}
 
-  Runtime.storage().get(palette_base_ + color_index * sizeof(cRGB), color);
-  color.r ^= 0xff;
-  color.g ^= 0xff;
-  color.b ^= 0xff;
+void LEDPaletteTheme::cachePalette() {
+  Runtime.storage().get(palette_base_, palette_);
+  for (uint8_t i = 0; i < 16; i++) {
+    palette_[i].r ^= 0xff;
+    palette_[i].g ^= 0xff;
+    palette_[i].b ^= 0xff;
+  }
+  palette_cached_ = true;
+}
 
-  return color;
+#if KALEIDOSCOPE_LED_PALETTE_THEME_CACHE_ROW
+void LEDPaletteTheme::cacheRow(uint16_t map_base) {
+  Runtime.storage().get(map_base, cached_row_);
+  cached_row_base_ = map_base;
+}
+#endif
+
+// The caches are dropped when the storage was overwritten since they were
+// filled; `eeprom.contents` may do that behind our back.
+void LEDPaletteTheme::validateCache() {
+  if (cache_generation_ == ::EEPROMSettings.generation())
+    return;
+  invalidateCache();
+  cache_generation_ = ::EEPROMSettings.generation();
+}
+
+void LEDPaletteTheme::invalidateCache() {
+  palette_cached_ = false;
+#if KALEIDOSCOPE_LED_PALETTE_THEME_CACHE_ROW
+  cached_row_base_ = -1;
+#endif
 }
 
 void LEDPaletteTheme::updateColorIndexAtPosition(uint16_t map_base, uint16_t position, uint8_t color_index) {
@@ -97,6 +179,11 @@ void LEDPaletteTheme::updateColorIndexAtPosition(uint16_t map_base, uint16_t pos
   }
   Runtime.storage().update(map_base + position / 2, indexes);
   Runtime.storage().commit();
+
+#if KALEIDOSCOPE_LED_PALETTE_THEME_CACHE_ROW
+  if (map_base == cached_row_base_)
+    cached_row_[position / 2] = indexes;
+#endif
 }
 
 EventHandlerResult LEDPaletteTheme::onFocusEvent(const char *command) {
@@ -134,6 +221,7 @@ EventHandlerResult LEDPaletteTheme::onFocusEvent(const char *command) {
     i++;
   }
   Runtime.storage().commit();
+  palette_cached_ = false;
 
   ::LEDControl.refreshAll();
 
@@ -177,6 +265,9 @@ EventHandlerResult LEDPaletteTheme::themeFocusEvent(const char *command,
     pos++;
   }
   Runtime.storage().commit();
+#if KALEIDOSCOPE_LED_PALETTE_THEME_CACHE_ROW
+  cached_row_base_ = -1;
+#endif
 
   ::LEDControl.refreshAll();
 
@@ -20,6 +20,16 @@
 #include "kaleidoscope/Runtime.h"
 #include <Kaleidoscope-LEDControl.h>
 
+// On devices with RAM to spare, keep a copy of the most recently displayed
+// theme row too, so that repainting it does not need to touch storage at all.
+#ifndef KALEIDOSCOPE_LED_PALETTE_THEME_CACHE_ROW
+#if defined(ARDUINO_ARCH_SAMD) || defined(KALEIDOSCOPE_VIRTUAL_BUILD)
+#define KALEIDOSCOPE_LED_PALETTE_THEME_CACHE_ROW 1
+#else
+#define KALEIDOSCOPE_LED_PALETTE_THEME_CACHE_ROW 0
+#endif
+#endif
+
 namespace kaleidoscope {
 namespace plugin {
 
@@ -29,6 +39,7 @@ class LEDPaletteTheme : public kaleidoscope::Plugin {
 
   static uint16_t reserveThemes(uint8_t max_themes);
   static void updateHandler(uint16_t theme_base, uint8_t theme);
+  static void updateHandler(uint16_t theme_base, uint8_t theme, uint8_t previous_theme);
   static void refreshAt(uint16_t theme_base, uint8_t theme, KeyAddr key_addr);
 
   static const uint8_t lookupColorIndexAtPosition(uint16_t theme_base, uint16_t position);
@@ -37,6 +48,8 @@ class LEDPaletteTheme : public kaleidoscope::Plugin {
 
   static const cRGB lookupPaletteColor(uint8_t palette_index);
 
+  static void invalidateCache();
+
   EventHandlerResult onFocusEvent(const char *command);
   EventHandlerResult themeFocusEvent(const char *command,
                                      const char *expected_command,
@@ -44,6 +57,20 @@ class LEDPaletteTheme : public kaleidoscope::Plugin {
 
  private:
   static uint16_t palette_base_;
+
+  static cRGB palette_[16];
+  static bool palette_cached_;
+  static void cachePalette();
+
+  static uint8_t cache_generation_;
+  static void validateCache();
+
+#if KALEIDOSCOPE_LED_PALETTE_THEME_CACHE_ROW
+  static constexpr uint8_t row_size_ = (kaleidoscope::Device::led_count + 1) / 2;
+  static uint16_t cached_row_base_;
+  static uint8_t cached_row_[row_size_];
+  static void cacheRow(uint16_t map_base);
+#endif
 };
 
 }
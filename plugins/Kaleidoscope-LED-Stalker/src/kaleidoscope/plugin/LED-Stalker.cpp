@@ -31,7 +31,8 @@ cRGB StalkerEffect::inactive_color = (cRGB) {
 StalkerEffect::TransientLEDMode::TransientLEDMode(const StalkerEffect *parent)
   : parent_(parent),
     step_start_time_(0),
-    map_{}
+    map_{},
+    active_count_(0)
 {}
 
 EventHandlerResult StalkerEffect::onKeyEvent(KeyEvent &event) {
@@ -47,31 +48,80 @@ EventHandlerResult StalkerEffect::onKeyEvent(KeyEvent &event) {
   // The simplest thing to do is trigger on both press and release. The color
   // will fade while the key is held, and get restored to full brightness when
   // it's released.
-  ::LEDControl.get_mode<TransientLEDMode>()->map_[event.addr.toInt()] = 0xff;
+  ::LEDControl.get_mode<TransientLEDMode>()->activate(event.addr);
 
   return EventHandlerResult::OK;
 }
 
+void StalkerEffect::TransientLEDMode::activate(KeyAddr key_addr) {
+  if (!active_keys_.read(key_addr)) {
+    // If nothing was fading, the step timer is stale: restart it, so the key
+    // starts at full brightness, and fades at the usual pace from there.
+    if (active_count_ == 0)
+      step_start_time_ = Runtime.millisAtCycleStart() - parent_->step_length;
+    active_keys_.set(key_addr);
+    active_count_++;
+  }
+  map_[key_addr.toInt()] = 0xff;
+}
+
+void StalkerEffect::TransientLEDMode::setColorAt(KeyAddr key_addr, cRGB color) {
+  cRGB current = ::LEDControl.getCrgbAt(key_addr);
+
+  if (current.r == color.r && current.g == color.g && current.b == color.b)
+    return;
+
+  ::LEDControl.setCrgbAt(key_addr, color);
+}
+
+void StalkerEffect::TransientLEDMode::onActivate(void) {
+  if (!Runtime.has_leds)
+    return;
+
+  active_keys_.clear();
+  active_count_ = 0;
+  memset(map_, 0, sizeof(map_));
+
+  ::LEDControl.set_all_leds_to(parent_->inactive_color);
+}
+
+void StalkerEffect::TransientLEDMode::refreshAt(KeyAddr key_addr) {
+  if (!active_keys_.read(key_addr) || !parent_->variant) {
+    ::LEDControl.setCrgbAt(key_addr, parent_->inactive_color);
+    return;
+  }
+
+  // Compute the color on a copy of the step, so the animation does not advance.
+  uint8_t step = map_[key_addr.toInt()];
+  ::LEDControl.setCrgbAt(key_addr, parent_->variant->compute(&step));
+}
+
 void StalkerEffect::TransientLEDMode::update(void) {
   if (!Runtime.has_leds)
     return;
 
+  if (active_count_ == 0)
+    return;
+
   if (!parent_->variant)
     return;
 
   if (!Runtime.hasTimeExpired(step_start_time_, parent_->step_length))
     return;
 
-  for (auto key_addr : KeyAddr::all()) {
+  for (KeyAddr key_addr : active_keys_) {
     uint8_t step = map_[key_addr.toInt()];
-    if (step) {
-      ::LEDControl.setCrgbAt(key_addr, parent_->variant->compute(&step));
-    }
+    cRGB color = parent_->variant->compute(&step);
 
     map_[key_addr.toInt()] = step;
 
-    if (!map_[key_addr.toInt()])
-      ::LEDControl.setCrgbAt(key_addr, parent_->inactive_color);
+    if (!step) {
+      color = parent_->inactive_color;
+      active_keys_.clear(key_addr);
+      active_count_--;
+    }
+
+    setColorAt(key_addr, color);
   }
 
   step_start_time_ = Runtime.millisAtCycleStart();
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "kaleidoscope/Runtime.h"
+#include "kaleidoscope/KeyAddrBitfield.h"
 #include <Kaleidoscope-LEDControl.h>
 
 #define STALKER(v, ...) ({static kaleidoscope::plugin::stalker::v _effect __VA_ARGS__; &_effect;})
@@ -54,7 +55,9 @@ class StalkerEffect : public Plugin,
 
    protected:
 
+    void onActivate() final;
     void update() final;
+    void refreshAt(KeyAddr key_addr) final;
 
    private:
 
@@ -63,6 +66,15 @@ class StalkerEffect : public Plugin,
     uint16_t step_start_time_;
     uint8_t map_[Runtime.device().numKeys()];
 
+    // The keys that are still fading, and how many of them there are. Only
+    // these are visited on each step, and once there are none left, `update()`
+    // has nothing to do.
+    KeyAddrBitfield active_keys_;
+    uint8_t active_count_;
+
+    void activate(KeyAddr key_addr);
+    void setColorAt(KeyAddr key_addr, cRGB color);
+
     friend class StalkerEffect;
   };
 };
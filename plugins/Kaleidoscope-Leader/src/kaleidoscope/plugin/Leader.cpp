@@ -31,6 +31,8 @@ KeyEventTracker Leader::event_tracker_;
 uint8_t Leader::sequence_pos_;
 uint16_t Leader::start_time_ = 0;
 uint16_t Leader::time_out = 1000;
+uint16_t Leader::match_first_;
+uint16_t Leader::match_last_;
 const Leader::dictionary_t *Leader::dictionary;
 
 // --- helpers ---
@@ -42,38 +44,57 @@ const Leader::dictionary_t *Leader::dictionary;
 #define isActive() (sequence_[0] != Key_NoKey)
 
 // --- actions ---
-int8_t Leader::lookup(void) {
-  bool match;
-
-  for (uint8_t seq_index = 0; ; seq_index++) {
-    match = true;
+bool Leader::matchesSequence(uint16_t seq_index) {
+  // Compare the newest key first: that is the one most likely to differ, as
+  // the rest of the sequence was already matched against the entry when it
+  // made it into the range of candidates.
+  if (dictionary[seq_index].sequence[sequence_pos_].readFromProgmem() != sequence_[sequence_pos_])
+    return false;
+
+  for (uint8_t i = 0; i < sequence_pos_; i++) {
+    if (dictionary[seq_index].sequence[i].readFromProgmem() != sequence_[i])
+      return false;
+  }
 
-    if (dictionary[seq_index].sequence[0].readFromProgmem() == Key_NoKey)
-      break;
+  return true;
+}
 
-    Key seq_key;
-    for (uint8_t i = 0; i <= sequence_pos_; i++) {
-      seq_key = dictionary[seq_index].sequence[i].readFromProgmem();
+int16_t Leader::lookup(void) {
+  // Every entry that matches the sequence so far also matched it one key ago,
+  // so only the range of entries that matched last time needs to be searched.
+  // On the first key after the leader, that's the whole dictionary.
+  uint16_t first = match_first_;
+  uint16_t last = match_last_;
+  bool found = false;
+
+  if (sequence_pos_ == 1) {
+    first = 0;
+    last = UINT16_MAX;
+  }
 
-      if (sequence_[i] != seq_key) {
-        match = false;
-        break;
-      }
-    }
+  for (uint16_t seq_index = first; seq_index <= last; seq_index++) {
+    if (sequence_pos_ == 1 &&
+        dictionary[seq_index].sequence[0].readFromProgmem() == Key_NoKey)
+      break;
 
-    if (!match)
+    if (!matchesSequence(seq_index))
       continue;
 
-    seq_key
-      = dictionary[seq_index].sequence[sequence_pos_ + 1].readFromProgmem();
-    if (seq_key == Key_NoKey) {
-      return seq_index;
-    } else {
-      return PARTIAL_MATCH;
+    if (!found) {
+      match_first_ = seq_index;
+      found = true;
     }
+    match_last_ = seq_index;
   }
 
-  return NO_MATCH;
+  if (!found)
+    return NO_MATCH;
+
+  if (sequence_pos_ == LEADER_MAX_SEQUENCE_LENGTH ||
+      dictionary[match_first_].sequence[sequence_pos_ + 1].readFromProgmem() == Key_NoKey)
+    return match_first_;
+
+  return PARTIAL_MATCH;
 }
 
 // --- api ---
@@ -121,7 +142,7 @@ EventHandlerResult Leader::onKeyswitchEvent(KeyEvent &event) {
 
   start_time_ = Runtime.millisAtCycleStart();
   sequence_[sequence_pos_] = event.key;
-  int8_t action_index = lookup();
+  int16_t action_index = lookup();
 
   if (action_index == NO_MATCH) {
     reset();
@@ -144,6 +165,8 @@ EventHandlerResult Leader::afterEachCycle() {
 
   if (Runtime.hasTimeExpired(start_time_, time_out))
     reset();
+  else
+    Runtime.declareDeadline(start_time_, time_out);
 
   return EventHandlerResult::OK;
 }
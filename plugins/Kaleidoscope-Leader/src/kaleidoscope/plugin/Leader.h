@@ -56,8 +56,11 @@ class Leader : public kaleidoscope::Plugin {
   static KeyEventTracker event_tracker_;
   static uint8_t sequence_pos_;
   static uint16_t start_time_;
+  static uint16_t match_first_;
+  static uint16_t match_last_;
 
-  static int8_t lookup(void);
+  static bool matchesSequence(uint16_t seq_index);
+  static int16_t lookup(void);
 };
 }
 
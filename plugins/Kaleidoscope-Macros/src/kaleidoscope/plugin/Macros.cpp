@@ -130,7 +130,7 @@ void Macros::play(const macro_t *macro_p) {
       break;
     case MACRO_ACTION_STEP_WAIT: {
       uint8_t wait = pgm_read_byte(macro_p++);
-      delay(wait);
+      Runtime.device().delay(wait);
       break;
     }
 
@@ -173,7 +173,7 @@ void Macros::play(const macro_t *macro_p) {
         if (key == Key_NoKey)
           break;
         tap(key);
-        delay(interval);
+        Runtime.device().delay(interval);
       }
       break;
     }
@@ -184,7 +184,7 @@ void Macros::play(const macro_t *macro_p) {
         if (key.getKeyCode() == 0)
           break;
         tap(key);
-        delay(interval);
+        Runtime.device().delay(interval);
       }
       break;
     }
@@ -194,7 +194,7 @@ void Macros::play(const macro_t *macro_p) {
       return;
     }
 
-    delay(interval);
+    Runtime.device().delay(interval);
   }
 }
 
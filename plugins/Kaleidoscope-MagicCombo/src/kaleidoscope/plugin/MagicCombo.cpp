@@ -23,12 +23,28 @@ namespace plugin {
 
 uint16_t MagicCombo::min_interval = 500;
 uint16_t MagicCombo::start_time_ = 0;
+bool MagicCombo::keyswitches_changed_ = false;
+uint8_t MagicCombo::pressed_count_ = 0;
+bool MagicCombo::combo_held_ = false;
+uint8_t MagicCombo::combo_index_;
 
 EventHandlerResult MagicCombo::onNameQuery() {
   return ::Focus.sendName(F("MagicCombo"));
 }
 
-EventHandlerResult MagicCombo::afterEachCycle() {
+EventHandlerResult MagicCombo::onKeyswitchEvent(KeyEvent &event) {
+  // Which keyswitches are held only changes when one toggles on or off, so
+  // that's the only time we need to look for a matching combo.
+  keyswitches_changed_ = true;
+  return EventHandlerResult::OK;
+}
+
+bool MagicCombo::findHeldCombo(uint8_t &combo_index) {
+  uint8_t pressed_count = pressed_count_;
+
+  if (pressed_count == 0 || pressed_count > MAX_COMBO_LENGTH)
+    return false;
+
   for (byte i = 0; i < magiccombo::combos_length; i++) {
     bool match = true;
     byte j;
@@ -44,15 +60,39 @@ EventHandlerResult MagicCombo::afterEachCycle() {
         break;
     }
 
-    if (j != Runtime.device().pressedKeyswitchCount())
-      match = false;
+    if (match && j == pressed_count) {
+      combo_index = i;
+      return true;
+    }
+  }
 
-    if (match && Runtime.hasTimeExpired(start_time_, min_interval)) {
-      ComboAction action = (ComboAction) pgm_read_ptr((void const **) & (magiccombo::combos[i].action));
+  return false;
+}
 
-      (*action)(i);
-      start_time_ = Runtime.millisAtCycleStart();
-    }
+EventHandlerResult MagicCombo::afterEachCycle() {
+  // A plugin before this one may have stopped a keyswitch event from reaching
+  // `onKeyswitchEvent()`, but any press or release it swallowed still changes
+  // the number of keyswitches held. Only a release and a press both swallowed
+  // in the same cycle go unnoticed, until the next change.
+  uint8_t pressed_count = Runtime.device().pressedKeyswitchCount();
+  if (pressed_count != pressed_count_) {
+    pressed_count_ = pressed_count;
+    keyswitches_changed_ = true;
+  }
+
+  if (keyswitches_changed_) {
+    keyswitches_changed_ = false;
+    combo_held_ = findHeldCombo(combo_index_);
+  }
+
+  if (!combo_held_)
+    return EventHandlerResult::OK;
+
+  if (Runtime.hasTimeExpired(start_time_, min_interval)) {
+    ComboAction action = (ComboAction) pgm_read_ptr((void const **) & (magiccombo::combos[combo_index_].action));
+
+    (*action)(combo_index_);
+    start_time_ = Runtime.millisAtCycleStart();
   }
 
   return EventHandlerResult::OK;
@@ -49,10 +49,17 @@ class MagicCombo : public kaleidoscope::Plugin {
   static uint16_t min_interval;
 
   EventHandlerResult onNameQuery();
+  EventHandlerResult onKeyswitchEvent(KeyEvent &event);
   EventHandlerResult afterEachCycle();
 
  private:
   static uint16_t start_time_;
+  static bool keyswitches_changed_;
+  static uint8_t pressed_count_;
+  static bool combo_held_;
+  static uint8_t combo_index_;
+
+  static bool findHeldCombo(uint8_t &combo_index);
 };
 
 namespace magiccombo {
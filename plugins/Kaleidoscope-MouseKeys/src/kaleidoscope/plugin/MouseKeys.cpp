@@ -37,6 +37,12 @@ uint16_t MouseKeys_::move_start_time_;
 uint16_t MouseKeys_::accel_start_time_;
 uint16_t MouseKeys_::wheel_start_time_;
 
+uint8_t MouseKeys_::move_directions_;
+uint8_t MouseKeys_::wheel_directions_;
+
+int32_t MouseKeys_::move_x_;
+int32_t MouseKeys_::move_y_;
+
 // =============================================================================
 // Configuration functions
 
@@ -94,85 +100,25 @@ EventHandlerResult MouseKeys_::onSetup(void) {
 
 // -----------------------------------------------------------------------------
 EventHandlerResult MouseKeys_::afterEachCycle() {
-  // Check timeout for accel update interval.
-  if (Runtime.hasTimeExpired(accel_start_time_, accelDelay)) {
-    accel_start_time_ = Runtime.millisAtCycleStart();
-    // `accelStep` determines the movement speed of the mouse pointer, and gets
-    // reset to zero when no mouse movement keys is pressed (see below).
-    if (MouseWrapper.accelStep < 255 - accelSpeed) {
-      MouseWrapper.accelStep += accelSpeed;
-    }
+  // The held directions are kept up to date by `onKeyEvent()`, so when no
+  // movement or scroll wheel keys are held, there's nothing to do here.
+  if (move_directions_ != 0) {
+    updateMovement();
+    moveCursor();
+    // The cursor moves a little every cycle, and can send a report in any of
+    // them, so none of them may be skipped.
+    Runtime.declareDeadline(Runtime.millisAtCycleStart(), 1);
+  } else if (move_x_ != 0 || move_y_ != 0) {
+    // The keys were released in this cycle; send what's left of the movement
+    // up to then, and drop the fraction of a pixel that remains.
+    moveCursor();
+    move_x_ = 0;
+    move_y_ = 0;
   }
 
-  // Check timeout for position update interval.
-  bool update_position = Runtime.hasTimeExpired(move_start_time_, speedDelay);
-  if (update_position) {
-    move_start_time_ = Runtime.millisAtCycleStart();
-    // Determine which mouse movement directions are active by searching through
-    // all the currently active keys for mouse movement keys, and adding them to
-    // a bitfield (`directions`).
-    uint8_t directions = 0;
-    int8_t vx = 0;
-    int8_t vy = 0;
-    for (Key key : live_keys.all()) {
-      if (isMouseKey(key) && isMouseMoveKey(key)) {
-        directions |= key.getKeyCode();
-      }
-    }
-
-    if (directions == 0) {
-      // If there are no mouse movement keys held, reset speed to zero.
-      MouseWrapper.accelStep = 0;
-    } else {
-      // For each active direction, add the mouse movement speed.
-      if (directions & KEY_MOUSE_LEFT)
-        vx -= speed;
-      if (directions & KEY_MOUSE_RIGHT)
-        vx += speed;
-      if (directions & KEY_MOUSE_UP)
-        vy -= speed;
-      if (directions & KEY_MOUSE_DOWN)
-        vy += speed;
-
-      // Prepare the mouse report.
-      MouseWrapper.move(vx, vy);
-      // Send the report.
-      Runtime.hid().mouse().sendReport();
-    }
-  }
-
-  // Check timeout for scroll report interval.
-  bool update_wheel = Runtime.hasTimeExpired(wheel_start_time_, wheelDelay);
-  if (update_wheel) {
-    wheel_start_time_ = Runtime.millisAtCycleStart();
-    // Determine which scroll wheel keys are active, and add their directions to
-    // a bitfield (`directions`).
-    uint8_t directions = 0;
-    int8_t vx = 0;
-    int8_t vy = 0;
-    for (Key key : live_keys.all()) {
-      if (isMouseKey(key) && isMouseWheelKey(key)) {
-        directions |= key.getKeyCode();
-      }
-    }
-
-    if (directions != 0) {
-      // Horizontal scroll wheel:
-      if (directions & KEY_MOUSE_LEFT)
-        vx -= wheelSpeed;
-      if (directions & KEY_MOUSE_RIGHT)
-        vx += wheelSpeed;
-      // Vertical scroll wheel (note coordinates are opposite movement):
-      if (directions & KEY_MOUSE_UP)
-        vy += wheelSpeed;
-      if (directions & KEY_MOUSE_DOWN)
-        vy -= wheelSpeed;
-
-      // Add scroll wheel changes to HID report.
-      Runtime.hid().mouse().move(0, 0, vy, vx);
-      // Send the report.
-      Runtime.hid().mouse().sendReport();
-    }
+  if (wheel_directions_ != 0) {
+    scrollWheel();
+    Runtime.declareDeadline(wheel_start_time_, wheelDelay);
   }
 
   return EventHandlerResult::OK;
@@ -193,17 +139,139 @@ EventHandlerResult MouseKeys_::onKeyEvent(KeyEvent &event) {
 
   } else if (isMouseMoveKey(event.key)) {
     // No report is sent here; that's handled in `afterEachCycle()`.
-    move_start_time_ = Runtime.millisAtCycleStart() - speedDelay;
-    accel_start_time_ = Runtime.millisAtCycleStart();
+    uint8_t directions = heldDirections(event);
+    if (move_directions_ != 0 && directions != move_directions_) {
+      // Up to the start of this cycle, the cursor kept moving the way it did
+      // in the last one.
+      updateMovement();
+    }
+    if (move_directions_ == 0 && directions != 0) {
+      // The cursor starts moving from a standstill. It moves one step right
+      // away, then accelerates from there.
+      move_start_time_ = Runtime.millisAtCycleStart() - speedDelay;
+      accel_start_time_ = Runtime.millisAtCycleStart();
+      MouseWrapper.accelStep = 0;
+    }
+    move_directions_ = directions;
 
   } else if (isMouseWheelKey(event.key)) {
     // No report is sent here; that's handled in `afterEachCycle()`.
-    wheel_start_time_ = Runtime.millisAtCycleStart() - wheelDelay;
+    wheel_directions_ = heldDirections(event);
+    if (keyToggledOn(event.state))
+      wheel_start_time_ = Runtime.millisAtCycleStart() - wheelDelay;
   }
 
   return EventHandlerResult::EVENT_CONSUMED;
 }
 
+// =============================================================================
+// Movement helper functions
+
+// -----------------------------------------------------------------------------
+// Returns the combined directions of all the held mouse keys of the same kind
+// (cursor movement or scroll wheel) as the one in `event`. The Live Keys array
+// hasn't been updated for `event` yet, so its key is taken from the event.
+uint8_t MouseKeys_::heldDirections(const KeyEvent &event) const {
+  bool wheel = isMouseWheelKey(event.key);
+  uint8_t directions = 0;
+  for (KeyAddr key_addr : KeyAddr::all()) {
+    if (key_addr == event.addr)
+      continue;
+    Key key = live_keys[key_addr];
+    if (isMouseKey(key) && (wheel ? isMouseWheelKey(key) : isMouseMoveKey(key)))
+      directions |= key.getKeyCode();
+  }
+  if (keyToggledOn(event.state) && event.addr.isValid())
+    directions |= event.key.getKeyCode();
+  return directions & (KEY_MOUSE_UP | KEY_MOUSE_DOWN | KEY_MOUSE_LEFT | KEY_MOUSE_RIGHT);
+}
+
+// -----------------------------------------------------------------------------
+// Adds the distance the cursor travels in `elapsed` milliseconds at its current
+// velocity to the pending movement.
+void MouseKeys_::integrateMovement(uint16_t elapsed) {
+  int16_t vx = 0;
+  int16_t vy = 0;
+  if (move_directions_ & KEY_MOUSE_LEFT)
+    vx -= speed;
+  if (move_directions_ & KEY_MOUSE_RIGHT)
+    vx += speed;
+  if (move_directions_ & KEY_MOUSE_UP)
+    vy -= speed;
+  if (move_directions_ & KEY_MOUSE_DOWN)
+    vy += speed;
+
+  move_x_ += int32_t(MouseWrapper.velocity(vx, speedDelay)) * elapsed;
+  move_y_ += int32_t(MouseWrapper.velocity(vy, speedDelay)) * elapsed;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the distance the cursor traveled since the last update, in the
+// directions currently held, to the pending movement.
+void MouseKeys_::updateMovement() {
+  uint16_t now = Runtime.millisAtCycleStart();
+
+  // Acceleration steps are applied at the time they were due, rather than at
+  // the start of the cycle in which we notice them, so that the path of the
+  // cursor doesn't depend on how long each cycle takes.
+  if (accelSpeed != 0) {
+    while (MouseWrapper.accelStep < 255 - accelSpeed) {
+      uint16_t step_time = accel_start_time_ + accelDelay;
+      if (uint16_t(step_time - move_start_time_) > uint16_t(now - move_start_time_))
+        break;
+      integrateMovement(step_time - move_start_time_);
+      move_start_time_ = step_time;
+      accel_start_time_ = step_time;
+      MouseWrapper.accelStep += accelSpeed;
+    }
+  }
+  integrateMovement(now - move_start_time_);
+  move_start_time_ = now;
+}
+
+// -----------------------------------------------------------------------------
+void MouseKeys_::moveCursor() {
+  // Only whole pixels are sent; the rest is kept for later. Anything beyond
+  // what fits in one report is dropped, rather than sent in later ones.
+  int32_t x = move_x_ / 256;
+  int32_t y = move_y_ / 256;
+  if (x == 0 && y == 0)
+    return;
+  move_x_ -= x * 256;
+  move_y_ -= y * 256;
+  x = constrain(x, -127, 127);
+  y = constrain(y, -127, 127);
+
+  MouseWrapper.end_warping();
+  Runtime.hid().mouse().move(x, y);
+  Runtime.hid().mouse().sendReport();
+}
+
+// -----------------------------------------------------------------------------
+void MouseKeys_::scrollWheel() {
+  if (!Runtime.hasTimeExpired(wheel_start_time_, wheelDelay))
+    return;
+  wheel_start_time_ = Runtime.millisAtCycleStart();
+
+  int8_t vx = 0;
+  int8_t vy = 0;
+  // Horizontal scroll wheel:
+  if (wheel_directions_ & KEY_MOUSE_LEFT)
+    vx -= wheelSpeed;
+  if (wheel_directions_ & KEY_MOUSE_RIGHT)
+    vx += wheelSpeed;
+  // Vertical scroll wheel (note coordinates are opposite movement):
+  if (wheel_directions_ & KEY_MOUSE_UP)
+    vy += wheelSpeed;
+  if (wheel_directions_ & KEY_MOUSE_DOWN)
+    vy -= wheelSpeed;
+
+  // Add scroll wheel changes to HID report.
+  Runtime.hid().mouse().move(0, 0, vy, vx);
+  // Send the report.
+  Runtime.hid().mouse().sendReport();
+}
+
 // =============================================================================
 // HID report helper functions
 
@@ -47,12 +47,27 @@ class MouseKeys_ : public kaleidoscope::Plugin {
   static uint16_t accel_start_time_;
   static uint16_t wheel_start_time_;
 
+  // The directions of the movement and scroll wheel keys currently held,
+  // updated by `onKeyEvent()`.
+  static uint8_t move_directions_;
+  static uint8_t wheel_directions_;
+
+  // Cursor movement that hasn't been sent yet, in 1/256ths of a pixel.
+  static int32_t move_x_;
+  static int32_t move_y_;
+
   bool isMouseKey(const Key &key) const;
   bool isMouseButtonKey(const Key &key) const;
   bool isMouseMoveKey(const Key &key) const;
   bool isMouseWarpKey(const Key &key) const;
   bool isMouseWheelKey(const Key &key) const;
 
+  uint8_t heldDirections(const KeyEvent &event) const;
+  void integrateMovement(uint16_t elapsed);
+  void updateMovement();
+  void moveCursor();
+  void scrollWheel();
+
   void sendMouseButtonReport(const KeyEvent &event) const;
   void sendMouseWarpReport(const KeyEvent &event) const;
 
@@ -110,6 +110,22 @@ uint8_t MouseWrapper_::acceleration(uint8_t cycles) {
   }
 }
 
+// Returns the velocity of a cursor that moves `speed` subpixels, scaled by the
+// current acceleration and capped at `speedLimit`, every `interval`
+// milliseconds. The result is in 1/256ths of a pixel per millisecond.
+int16_t MouseWrapper_::velocity(int16_t speed, uint16_t interval) {
+  if (speed == 0)
+    return 0;
+
+  int32_t subpixels = int32_t(speed) * acceleration(accelStep);
+  if (subpixels > speedLimit) subpixels = speedLimit;
+  else if (subpixels < -speedLimit) subpixels = -speedLimit;
+
+  if (interval == 0)
+    interval = 1;
+  return subpixels * 256 / subpixelsPerPixel / interval;
+}
+
 void MouseWrapper_::move(int8_t x, int8_t y) {
   int16_t moveX = 0;
   int16_t moveY = 0;
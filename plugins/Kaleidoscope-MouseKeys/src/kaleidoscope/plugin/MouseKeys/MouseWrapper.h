@@ -46,6 +46,7 @@ class MouseWrapper_ {
   MouseWrapper_() {}
 
   static void move(int8_t x, int8_t y);
+  static int16_t velocity(int16_t speed, uint16_t interval);
   static void warp(uint8_t warp_cmd);
   static void end_warping();
   static void reset_warping();
@@ -341,10 +341,14 @@ EventHandlerResult OneShot::afterEachCycle() {
       // by another key press.
       if (oneshot_expired)
         releaseKey(key_addr);
+      else
+        Runtime.declareDeadline(start_time_, timeout_);
     } else {
       // Cancel "pending" state of keys held longer than the hold timeout.
       if (hold_expired)
         temp_addrs_.clear(key_addr);
+      else
+        Runtime.declareDeadline(start_time_, hold_timeout_);
     }
   }
 
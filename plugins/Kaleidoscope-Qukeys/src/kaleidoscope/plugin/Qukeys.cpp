@@ -91,6 +91,12 @@ EventHandlerResult Qukeys::afterEachCycle() {
   // Process as many events as we can from the queue.
   while (processQueue());
 
+  // That may have flushed every event, in which case there is no timeout left
+  // to check.
+  if (event_queue_.isEmpty()) {
+    return EventHandlerResult::OK;
+  }
+
   // If we get here, that means that the first event in the queue is a qukey
   // press. All that's left to do is to check if it's been held long enough that
   // it has timed out.
@@ -101,6 +107,12 @@ EventHandlerResult Qukeys::afterEachCycle() {
                     queue_head_.primary_key : queue_head_.alternate_key;
     flushEvent(event_key);
   }
+
+  // Whatever is still queued waits on one of several timers (hold, minimum
+  // hold, overlap, tap-repeat), so rather than work out which one expires
+  // first, we ask for every cycle to run until the queue is empty again.
+  if (!event_queue_.isEmpty())
+    Runtime.declareDeadline(Runtime.millisAtCycleStart(), 1);
   return EventHandlerResult::OK;
 }
 
@@ -170,6 +182,7 @@ bool Qukeys::processQueue() {
                               minimum_prior_interval_) &&
       !qukey_is_spacecadet) {
     flushEvent(queue_head_.primary_key);
+    return true;
   }
 
   // Now we search the queue for events that will let us decide if the qukey
@@ -23,12 +23,28 @@ namespace kaleidoscope {
 namespace plugin {
 
 const ShapeShifter::dictionary_t *ShapeShifter::dictionary = nullptr;
+KeyFilter<> ShapeShifter::dictionary_filter_;
+const ShapeShifter::dictionary_t *ShapeShifter::filtered_dictionary_ = nullptr;
+
+void ShapeShifter::updateDictionaryFilter() {
+  dictionary_filter_.clear();
+  for (uint8_t i = 0; ; i++) {
+    Key orig = dictionary[i].original.readFromProgmem();
+    if (orig == Key_NoKey)
+      break;
+    dictionary_filter_.add(orig);
+  }
+  filtered_dictionary_ = dictionary;
+}
 
 EventHandlerResult ShapeShifter::onKeyEvent(KeyEvent &event) {
   if (dictionary == nullptr)
     return EventHandlerResult::OK;
 
-  if (!dictionary)
+  if (filtered_dictionary_ != dictionary)
+    updateDictionaryFilter();
+
+  if (!dictionary_filter_.mayContain(event.key))
     return EventHandlerResult::OK;
 
   Key orig, repl;
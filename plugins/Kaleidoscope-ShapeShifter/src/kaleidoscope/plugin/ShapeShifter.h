@@ -18,6 +18,7 @@
 #pragma once
 
 #include "kaleidoscope/Runtime.h"
+#include "kaleidoscope/KeyFilter.h"
 
 namespace kaleidoscope {
 namespace plugin {
@@ -33,6 +34,15 @@ class ShapeShifter : public kaleidoscope::Plugin {
   static const dictionary_t *dictionary;
 
   EventHandlerResult onKeyEvent(KeyEvent &event);
+
+ private:
+  // A filter of the original keys of `dictionary`, so that keys not in it can
+  // be let through without searching it. It is rebuilt whenever `dictionary`
+  // is set to a different array.
+  static KeyFilter<> dictionary_filter_;
+  static const dictionary_t *filtered_dictionary_;
+
+  static void updateDictionaryFilter();
 };
 }
 
@@ -56,6 +56,9 @@ int8_t SpaceCadet::pending_map_index_ = -1;
 
 KeyEventTracker SpaceCadet::event_tracker_;
 
+KeyFilter<> SpaceCadet::map_filter_;
+const SpaceCadet::KeyBinding *SpaceCadet::filtered_map_ = nullptr;
+
 // =============================================================================
 // SpaceCadet functions
 
@@ -175,6 +178,8 @@ EventHandlerResult SpaceCadet::afterEachCycle() {
   if (Runtime.hasTimeExpired(start_time, pending_timeout)) {
     // The timer has expired; release the pending event unchanged.
     flushQueue();
+  } else {
+    Runtime.declareDeadline(start_time, pending_timeout);
   }
   return EventHandlerResult::OK;
 }
@@ -182,7 +187,21 @@ EventHandlerResult SpaceCadet::afterEachCycle() {
 // =============================================================================
 // Private helper function(s)
 
+void SpaceCadet::updateMapFilter() const {
+  map_filter_.clear();
+  for (uint8_t i = 0; !map[i].isEmpty(); ++i) {
+    map_filter_.add(map[i].input);
+  }
+  filtered_map_ = map;
+}
+
 int8_t SpaceCadet::getSpaceCadetKeyIndex(Key key) const {
+  if (filtered_map_ != map)
+    updateMapFilter();
+
+  if (!map_filter_.mayContain(key))
+    return -1;
+
   for (uint8_t i = 0; !map[i].isEmpty(); ++i) {
     if (map[i].input == key) {
       return i;
@@ -21,6 +21,7 @@
 #include "kaleidoscope/Runtime.h"
 #include "kaleidoscope/KeyEventTracker.h"
 #include "kaleidoscope/KeyAddrEventQueue.h"
+#include "kaleidoscope/KeyFilter.h"
 #include <Kaleidoscope-Ranges.h>
 
 #ifndef SPACECADET_MAP_END
@@ -72,6 +73,10 @@ class SpaceCadet : public kaleidoscope::Plugin {
   static bool active() {
     return (mode_ == Mode::ON || mode_ == Mode::NO_DELAY);
   }
+  // Call this after changing the input keys of the current `map` in place.
+  static void refreshMap() {
+    filtered_map_ = nullptr;
+  }
 
   // Publically accessible variables
   static uint16_t time_out;  //  The global timeout in milliseconds
@@ -99,7 +104,14 @@ class SpaceCadet : public kaleidoscope::Plugin {
 
   static int8_t pending_map_index_;
 
+  // A filter of the input keys of `map`, so that keys that aren't SpaceCadet
+  // keys - which is most of them - can be let through without searching the
+  // map. It is rebuilt whenever `map` is set to a different array.
+  static KeyFilter<> map_filter_;
+  static const KeyBinding *filtered_map_;
+
   int8_t getSpaceCadetKeyIndex(Key key) const;
+  void updateMapFilter() const;
 
   void flushEvent(bool is_tap = false);
   void flushQueue();
@@ -24,7 +24,29 @@ namespace plugin {
 namespace steno {
 
 uint8_t GeminiPR::keys_held_;
-uint8_t GeminiPR::state_[6];
+bool GeminiPR::stroke_pending_;
+uint8_t GeminiPR::state_[packet_size];
+uint8_t GeminiPR::queue_[GEMINIPR_QUEUE_SIZE][packet_size];
+uint8_t GeminiPR::queue_head_;
+uint8_t GeminiPR::queue_count_;
+GeminiPR::StrokeMode GeminiPR::stroke_mode = GeminiPR::StrokeMode::ALL_UP;
+GeminiPR::transport_t GeminiPR::transport = GeminiPR::serialTransport;
+
+// Each packet byte holds seven keys, most significant bit first, with the top
+// bit of the first byte marking the start of the packet. The byte and the mask
+// of each key are worked out here once, so that handling an event needs no
+// division.
+#define KEY_MASKS(index)                                                       \
+  {index, 1 << 6}, {index, 1 << 5}, {index, 1 << 4}, {index, 1 << 3},          \
+  {index, 1 << 2}, {index, 1 << 1}, {index, 1 << 0}
+
+static const uint8_t key_masks[][2] PROGMEM = {
+  KEY_MASKS(0), KEY_MASKS(1), KEY_MASKS(2),
+  KEY_MASKS(3), KEY_MASKS(4), KEY_MASKS(5)
+};
+
+static_assert(sizeof(key_masks) / sizeof(key_masks[0]) == geminipr::END - geminipr::START + 1,
+              "There must be a mask for every steno key");
 
 EventHandlerResult GeminiPR::onNameQuery() {
   return ::Focus.sendName(F("GeminiPR"));
@@ -34,24 +56,74 @@ EventHandlerResult GeminiPR::onKeyEvent(KeyEvent &event) {
   if (event.key < geminipr::START || event.key > geminipr::END)
     return EventHandlerResult::OK;
 
+  uint8_t key = event.key.getRaw() - geminipr::START;
+  uint8_t byte_index = pgm_read_byte(&key_masks[key][0]);
+  uint8_t mask = pgm_read_byte(&key_masks[key][1]);
+
   if (keyToggledOn(event.state)) {
-    uint8_t key = event.key.getRaw() - geminipr::START;
     ++keys_held_;
 
-    state_[key / 7] |= 1 << (6 - (key % 7));
+    state_[byte_index] |= mask;
+    stroke_pending_ = true;
   } else {
     --keys_held_;
 
-    if (keys_held_ == 0) {
-      state_[0] |= 0x80;
-      Runtime.serialPort().write(state_, sizeof(state_));
-      memset(state_, 0, sizeof(state_));
+    if (stroke_mode == StrokeMode::FIRST_UP) {
+      // Only a key of the stroke being entered ends it; keys left over from
+      // the previous stroke are just released.
+      if (state_[byte_index] & mask)
+        sendStroke();
+    } else if (keys_held_ == 0 && stroke_pending_) {
+      sendStroke();
     }
   }
 
   return EventHandlerResult::EVENT_CONSUMED;
 }
 
+EventHandlerResult GeminiPR::afterEachCycle() {
+  if (queue_count_ != 0)
+    flushQueue();
+
+  // Strokes the host wasn't ready for are retried every cycle until it is.
+  if (queue_count_ != 0)
+    Runtime.declareDeadline(Runtime.millisAtCycleStart(), 1);
+
+  return EventHandlerResult::OK;
+}
+
+bool GeminiPR::serialTransport(const uint8_t *packet, uint8_t size) {
+  if (Runtime.serialPort().availableForWrite() < size)
+    return false;
+
+  Runtime.serialPort().write(packet, size);
+  return true;
+}
+
+void GeminiPR::sendStroke() {
+  state_[0] |= 0x80;
+
+  // If the queue is full, the host hasn't been reading strokes for a while, and
+  // the new one is dropped rather than waiting for it.
+  if (queue_count_ < GEMINIPR_QUEUE_SIZE) {
+    uint8_t tail = (queue_head_ + queue_count_) % GEMINIPR_QUEUE_SIZE;
+    memcpy(queue_[tail], state_, packet_size);
+    ++queue_count_;
+  }
+
+  memset(state_, 0, sizeof(state_));
+  stroke_pending_ = false;
+
+  flushQueue();
+}
+
+void GeminiPR::flushQueue() {
+  while (queue_count_ > 0 && (*transport)(queue_[queue_head_], packet_size)) {
+    queue_head_ = (queue_head_ + 1) % GEMINIPR_QUEUE_SIZE;
+    --queue_count_;
+  }
+}
+
 }
 }
 }
@@ -22,6 +22,11 @@
 
 #define S(n) Key(kaleidoscope::plugin::steno::geminipr::n)
 
+// The number of strokes that can wait for the transport to accept them.
+#ifndef GEMINIPR_QUEUE_SIZE
+#define GEMINIPR_QUEUE_SIZE 4
+#endif
+
 namespace kaleidoscope {
 namespace plugin {
 namespace steno {
@@ -29,12 +34,39 @@ class GeminiPR : public kaleidoscope::Plugin {
  public:
   GeminiPR(void) {}
 
+  static constexpr uint8_t packet_size = 6;
+
+  // When a stroke is sent: either once all of its keys are released, or as
+  // soon as the first one is. With `FIRST_UP`, keys pressed after that start
+  // the next stroke, even if some keys of the previous one are still held.
+  enum class StrokeMode : uint8_t {
+    ALL_UP,
+    FIRST_UP,
+  };
+  static StrokeMode stroke_mode;
+
+  // Takes a packet to send to the host, and returns `false` if it can't do so
+  // without blocking; the packet will be offered again in the next cycle.
+  typedef bool (*transport_t)(const uint8_t *packet, uint8_t size);
+  static transport_t transport;
+
+  static bool serialTransport(const uint8_t *packet, uint8_t size);
+
   EventHandlerResult onNameQuery();
   EventHandlerResult onKeyEvent(KeyEvent &event);
+  EventHandlerResult afterEachCycle();
 
  private:
   static uint8_t keys_held_;
-  static uint8_t state_[6];
+  static bool stroke_pending_;
+  static uint8_t state_[packet_size];
+
+  static uint8_t queue_[GEMINIPR_QUEUE_SIZE][packet_size];
+  static uint8_t queue_head_;
+  static uint8_t queue_count_;
+
+  static void sendStroke();
+  static void flushQueue();
 };
 
 namespace geminipr {
@@ -29,10 +29,75 @@ namespace plugin {
 char Syster::symbol_[SYSTER_MAX_SYMBOL_LENGTH + 1];
 uint8_t Syster::symbol_pos_;
 bool Syster::is_active_;
+uint16_t Syster::match_first_;
+uint16_t Syster::match_last_;
+const Syster::dictionary_t *Syster::dictionary;
 
 // --- helpers ---
 #define isSyster(k) (k == kaleidoscope::ranges::SYSTER)
 
+bool Syster::matchesSymbol(uint16_t index) {
+  if (symbol_pos_ > SYSTER_DICT_SYMBOL_LENGTH)
+    return false;
+
+  // Compare the newest character first: that is the one most likely to differ,
+  // as the rest of the symbol was already matched against the entry when it
+  // made it into the range of candidates.
+  const char *symbol = dictionary[index].symbol;
+  uint8_t last = symbol_pos_ - 1;
+  if (pgm_read_byte(&symbol[last]) != symbol_[last])
+    return false;
+
+  for (uint8_t i = 0; i < last; i++) {
+    if (pgm_read_byte(&symbol[i]) != symbol_[i])
+      return false;
+  }
+
+  return true;
+}
+
+bool Syster::narrowMatches(uint16_t first, uint16_t last) {
+  bool found = false;
+
+  for (uint16_t index = first; index <= last; index++) {
+    if (pgm_read_byte(&dictionary[index].symbol[0]) == 0)
+      break;
+
+    if (!matchesSymbol(index))
+      continue;
+
+    if (!found) {
+      match_first_ = index;
+      found = true;
+    }
+    match_last_ = index;
+  }
+
+  // With no candidates left, the range is left empty, so that neither the
+  // characters that follow nor the lookup at the end search the dictionary.
+  if (!found) {
+    match_first_ = 1;
+    match_last_ = 0;
+  }
+
+  return found;
+}
+
+int16_t Syster::lookup() {
+  if (dictionary == nullptr || symbol_pos_ == 0 ||
+      symbol_pos_ > SYSTER_DICT_SYMBOL_LENGTH)
+    return -1;
+
+  // Every entry in the range of candidates starts with the symbol typed so
+  // far, so the one that ends right after it is an exact match.
+  for (uint16_t index = match_first_; index <= match_last_; index++) {
+    if (pgm_read_byte(&dictionary[index].symbol[symbol_pos_]) == 0)
+      return index;
+  }
+
+  return -1;
+}
+
 // --- api ---
 void Syster::reset(void) {
   symbol_pos_ = 0;
@@ -101,7 +166,16 @@ EventHandlerResult Syster::onKeyEvent(KeyEvent &event) {
       // Then we null-terminate the `symbol_` string, and call the user-defined
       // symbol action.
       symbol_[symbol_pos_] = 0;
-      systerAction(SymbolAction, symbol_);
+      int16_t index = lookup();
+      if (index >= 0) {
+        // If the symbol is in the dictionary, call its action directly.
+        symbol_action_t action =
+          (symbol_action_t) pgm_read_ptr((void const **) & (dictionary[index].action));
+        (*action)(index);
+      } else {
+        // Otherwise, the user-defined symbol action gets a chance to handle it.
+        systerAction(SymbolAction, symbol_);
+      }
 
       // Finally, we're done, so we reset, deactivating Syster until the next
       // press of a Syster key.
@@ -120,12 +194,44 @@ EventHandlerResult Syster::onKeyEvent(KeyEvent &event) {
       if (symbol_pos_ > 0)
         --symbol_pos_;
 
+      // A shorter symbol may have more candidates in the dictionary than the
+      // current range, so search it all again.
+      if (dictionary != nullptr && symbol_pos_ > 0)
+        narrowMatches(0, UINT16_MAX);
+
     } else {
       // An ordinary keypress, with Syster active.  We add its corresponding
       // character to the symbol string.
       const char c = keyToChar(event.key);
-      if (c)
-        symbol_[symbol_pos_++] = c;
+      if (!c)
+        return EventHandlerResult::OK;
+
+      // If the symbol string is full, the character would be typed without
+      // being recorded, and erasing it later would leave the two out of sync,
+      // so it is suppressed instead.
+      if (symbol_pos_ == SYSTER_MAX_SYMBOL_LENGTH)
+        return EventHandlerResult::ABORT;
+
+      symbol_[symbol_pos_++] = c;
+
+      if (dictionary != nullptr) {
+        // Every entry that starts with the symbol typed so far also started
+        // with it one character ago, so only the range of entries that
+        // matched last time needs to be searched. On the first character,
+        // that's the whole dictionary.
+        uint16_t first = match_first_;
+        uint16_t last = match_last_;
+        if (symbol_pos_ == 1) {
+          first = 0;
+          last = UINT16_MAX;
+        }
+
+        // If no symbol in the dictionary starts like this, the range of
+        // candidates ends up empty, and the symbol is handed to
+        // `systerAction()` when the spacebar is pressed, as without a
+        // dictionary.
+        narrowMatches(first, last);
+      }
     }
   }
 
@@ -135,28 +241,19 @@ EventHandlerResult Syster::onKeyEvent(KeyEvent &event) {
 } // namespace plugin
 
 void eraseChars(int8_t n) {
-  // For the `event.addr`, we could track the address of the Syster key, but it
-  // might be on a layer that's no longer active by the time this gets
-  // called. We could search the active keymap for an existing `Key_Backspace`,
-  // but there might not be one. We could hijack the first idle key we find in
-  // the keymap, but we probably don't need to. Even if some other plugin reacts
-  // by inserting another event between these two, it's very unlikely that will
-  // cause a user-visible error.
-  auto event = KeyEvent(KeyAddr::none(), INJECTED, Key_Backspace);
+  // The backspaces only undo characters Syster already let through, so there's
+  // nothing for other plugins to do with them. Instead of running each press
+  // and release through `Runtime.handleKeyEvent()`, and with it every plugin's
+  // event handler, they go straight to the HID report, with one report for
+  // each press and each release, on top of whatever keys are held.
+  auto &keyboard = Runtime.hid().keyboard();
   while (n > 0) {
-    event.state = IS_PRESSED | INJECTED;
-    Runtime.handleKeyEvent(event);
-    event.state = WAS_PRESSED | INJECTED;
-    Runtime.handleKeyEvent(event);
+    keyboard.pressRawKey(Key_Backspace);
+    keyboard.sendReport();
+    keyboard.releaseRawKey(Key_Backspace);
+    keyboard.sendReport();
     --n;
   }
-  Runtime.handleKeyEvent(event);
-  // Change the event from a press to a release, but use the same id. This does
-  // come with a small risk that another plugin will be tracking events, but
-  // also ignoring event ids that it has seen before, but it's more likely to
-  // avoid an error than to cause one.
-  event.state = WAS_PRESSED | INJECTED;
-  Runtime.handleKeyEvent(event);
 }
 
 } // namespace kaleidoscope
@@ -22,6 +22,15 @@
 
 #define SYSTER_MAX_SYMBOL_LENGTH 32
 
+// Symbols in a dictionary are stored in fixed-size arrays, so this is kept
+// shorter than `SYSTER_MAX_SYMBOL_LENGTH` to save PROGMEM. A symbol that does
+// not fit is a compile error.
+#ifndef SYSTER_DICT_SYMBOL_LENGTH
+#define SYSTER_DICT_SYMBOL_LENGTH 12
+#endif
+
+#define SYSTER_DICT(...) { __VA_ARGS__, {"", NULL} }
+
 #define SYSTER Key(kaleidoscope::ranges::SYSTER)
 
 namespace kaleidoscope {
@@ -35,7 +44,14 @@ class Syster : public kaleidoscope::Plugin {
     SymbolAction
   } action_t;
 
+  typedef void (*symbol_action_t)(uint8_t symbol_index);
+  typedef struct {
+    char symbol[SYSTER_DICT_SYMBOL_LENGTH + 1];
+    symbol_action_t action;
+  } dictionary_t;
+
   Syster() {}
+  static const dictionary_t *dictionary;
 
   static void reset();
 
@@ -48,6 +64,12 @@ class Syster : public kaleidoscope::Plugin {
   static char symbol_[SYSTER_MAX_SYMBOL_LENGTH + 1];
   static uint8_t symbol_pos_;
   static bool is_active_;
+  static uint16_t match_first_;
+  static uint16_t match_last_;
+
+  static bool matchesSymbol(uint16_t index);
+  static bool narrowMatches(uint16_t first, uint16_t last);
+  static int16_t lookup();
 };
 
 } // namespace plugin
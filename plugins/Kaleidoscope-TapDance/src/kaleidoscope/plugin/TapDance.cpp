@@ -139,6 +139,8 @@ EventHandlerResult TapDance::afterEachCycle() {
     tapDanceAction(td_id, td_addr, tap_count_, Timeout);
     flushQueue();
     tap_count_ = 0;
+  } else {
+    Runtime.declareDeadline(start_time, time_out);
   }
   return EventHandlerResult::OK;
 }
@@ -119,6 +119,8 @@ EventHandlerResult Turbo::afterEachCycle() {
       // Send the re-populated keyboard report.
       Runtime.hid().keyboard().sendReport();
     }
+    if (active_)
+      Runtime.declareDeadline(start_time_, interval_);
   }
   return EventHandlerResult::OK;
 }
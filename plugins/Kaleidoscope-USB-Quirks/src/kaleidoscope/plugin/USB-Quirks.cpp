@@ -25,7 +25,7 @@ void USBQuirks::toggleKeyboardProtocol() {
 
   Runtime.detachFromHost();
   Runtime.hid().keyboard().setDefaultProtocol(new_protocol);
-  delay(1000);
+  Runtime.device().delay(1000);
   Runtime.attachToHost();
 }
 
@@ -20,7 +20,23 @@
 namespace kaleidoscope {
 namespace plugin {
 
-uint8_t Unicode::input_delay_;
+// The delays between two parts of the sequence, for each host OS. `type()`
+// never sends more than one report per cycle, even without a delay.
+uint8_t Unicode::input_delay_[hostos::OTHER + 1];
+
+uint32_t Unicode::queue_[];
+uint8_t Unicode::queue_head_;
+uint8_t Unicode::queue_count_;
+
+Unicode::Phase Unicode::phase_ = Unicode::Phase::START;
+int8_t Unicode::digit_;
+Key Unicode::held_keys_[];
+uint16_t Unicode::last_report_time_;
+
+KeyEvent Unicode::held_events_[];
+uint8_t Unicode::held_events_head_;
+uint8_t Unicode::held_events_count_;
+KeyEventTracker Unicode::event_tracker_;
 
 void Unicode::start(void) {
   switch (::HostOS.os()) {
@@ -63,7 +79,7 @@ void Unicode::input(void) {
     unicodeCustomInput();
     break;
   }
-  delay(input_delay_);
+  kaleidoscope::Runtime.device().delay(input_delay());
 }
 
 void Unicode::end(void) {
@@ -122,14 +138,185 @@ void Unicode::typeCode(uint32_t unicode) {
       kaleidoscope::Runtime.hid().keyboard().sendReport();
       on_zero_start = false;
     }
-    delay(5);
+    kaleidoscope::Runtime.device().delay(5);
   }
 }
 
+// Code points passed to `type()` are queued, and typed one report at a time
+// from `afterEachCycle()`, waiting at least `input_delay()` milliseconds
+// between two reports, so the rest of the firmware keeps running meanwhile. If
+// the queue is full, rather than drop the code point, the queue is typed out
+// and the code point after it the old, blocking way.
 void Unicode::type(uint32_t unicode) {
-  start();
-  typeCode(unicode);
-  end();
+  if (queue_count_ == UNICODE_QUEUE_SIZE) {
+    while (queue_count_ != 0) {
+      kaleidoscope::Runtime.device().delay(input_delay());
+      typeNextReport();
+    }
+    kaleidoscope::Runtime.device().delay(input_delay());
+    start();
+    typeCode(unicode);
+    end();
+    return;
+  }
+
+  queue_[(queue_head_ + queue_count_) % UNICODE_QUEUE_SIZE] = unicode;
+  queue_count_++;
+}
+
+// While typing, the keys of the sequence are only in the keyboard report until
+// the next key event rebuilds it, and any other key would be mixed into the
+// sequence anyway. So keyswitch events are held back until the queue is empty,
+// then let through in the order they came in, one per cycle.
+EventHandlerResult Unicode::onKeyswitchEvent(KeyEvent &event) {
+  if (event_tracker_.shouldIgnore(event))
+    return EventHandlerResult::OK;
+
+  if (!isTyping() && held_events_count_ == 0)
+    return EventHandlerResult::OK;
+
+  // Rather than lose an event, let it through, and garble the sequence.
+  if (held_events_count_ == UNICODE_EVENT_QUEUE_SIZE)
+    return EventHandlerResult::OK;
+
+  held_events_[(held_events_head_ + held_events_count_) % UNICODE_EVENT_QUEUE_SIZE] = event;
+  held_events_count_++;
+  return EventHandlerResult::ABORT;
+}
+
+void Unicode::releaseHeldEvent() {
+  KeyEvent event = held_events_[held_events_head_];
+  held_events_head_ = (held_events_head_ + 1) % UNICODE_EVENT_QUEUE_SIZE;
+  held_events_count_--;
+  Runtime.handleKeyswitchEvent(event);
+}
+
+EventHandlerResult Unicode::afterEachCycle() {
+  if (queue_count_ != 0 &&
+      Runtime.hasTimeExpired(last_report_time_, input_delay())) {
+    typeNextReport();
+    last_report_time_ = Runtime.millisAtCycleStart();
+  } else if (queue_count_ == 0 && held_events_count_ != 0) {
+    releaseHeldEvent();
+  }
+
+  // The next report is due once the input delay is over; the key events held
+  // back are let through one each cycle, so none of those may be skipped.
+  if (queue_count_ != 0) {
+    Runtime.declareDeadline(last_report_time_, input_delay());
+  } else if (held_events_count_ != 0) {
+    Runtime.declareDeadline(Runtime.millisAtCycleStart(), 1);
+  }
+
+  return EventHandlerResult::OK;
+}
+
+Key Unicode::digitKey(uint8_t digit) {
+  if (::HostOS.os() == hostos::WINDOWS)
+    return hexToKeysWithNumpad(digit);
+  return hexToKey(digit);
+}
+
+bool Unicode::isHeld(Key key) {
+  for (Key held_key : held_keys_) {
+    if (held_key == key)
+      return true;
+  }
+  return false;
+}
+
+// Replaces the keys held by `type()` with the given ones, and sends a report.
+// Keys held both before and after stay held.
+void Unicode::holdKeys(Key key1, Key key2, Key key3) {
+  for (Key key : held_keys_) {
+    if (key != Key_NoKey)
+      kaleidoscope::Runtime.hid().keyboard().releaseRawKey(key);
+  }
+  held_keys_[0] = key1;
+  held_keys_[1] = key2;
+  held_keys_[2] = key3;
+  for (Key key : held_keys_) {
+    if (key != Key_NoKey)
+      kaleidoscope::Runtime.hid().keyboard().pressRawKey(key);
+  }
+  kaleidoscope::Runtime.hid().keyboard().sendReport();
+}
+
+// Sends the next report for the code point at the head of the queue. To keep
+// the number of reports down, the release of a key is sent together with the
+// press of the next one, unless they're the same key.
+void Unicode::typeNextReport() {
+  uint32_t unicode = queue_[queue_head_];
+  hostos::Type os = ::HostOS.os();
+  Key modifier = (os == hostos::WINDOWS || os == hostos::OSX) ? Key_LeftAlt : Key_NoKey;
+
+  bool custom = profile(os) == hostos::OTHER;
+
+  switch (phase_) {
+  case Phase::START_HEX:
+    holdKeys(Key_LeftAlt, Key_KeypadAdd);
+    phase_ = Phase::DIGITS;
+    return;
+
+  case Phase::START:
+    digit_ = 7;
+    while (digit_ > 3 && ((unicode >> (digit_ * 4)) & 0xF) == 0)
+      digit_--;
+
+    phase_ = Phase::DIGITS;
+    switch (os) {
+    case hostos::LINUX:
+      holdKeys(Key_LeftControl, Key_LeftShift, Key_U);
+      return;
+    case hostos::WINDOWS:
+      holdKeys(Key_LeftAlt);
+      phase_ = Phase::START_HEX;
+      return;
+    case hostos::OSX:
+      // Alt is pressed together with the first digit.
+      break;
+    default:
+      unicodeCustomStart();
+      return;
+    }
+  // fall through
+
+  case Phase::DIGITS: {
+    Key key = digitKey((unicode >> (digit_ * 4)) & 0xF);
+    if (isHeld(key)) {
+      // The same digit twice in a row: release it first.
+      holdKeys(modifier);
+      return;
+    }
+    if (custom)
+      unicodeCustomInput();
+    holdKeys(modifier, key);
+    if (--digit_ < 0)
+      phase_ = Phase::END;
+    return;
+  }
+
+  case Phase::END:
+    phase_ = Phase::RELEASE;
+    if (os == hostos::LINUX) {
+      holdKeys(Key_Spacebar);
+    } else {
+      holdKeys(modifier);
+    }
+    return;
+
+  case Phase::RELEASE:
+    if (custom) {
+      unicodeCustomEnd();
+    } else {
+      holdKeys();
+    }
+    break;
+  }
+
+  phase_ = Phase::START;
+  queue_head_ = (queue_head_ + 1) % UNICODE_QUEUE_SIZE;
+  queue_count_--;
 }
 
 }
@@ -18,8 +18,17 @@
 #pragma once
 
 #include "kaleidoscope/Runtime.h"
+#include "kaleidoscope/KeyEventTracker.h"
 #include <Kaleidoscope-HostOS.h>
 
+#ifndef UNICODE_QUEUE_SIZE
+#define UNICODE_QUEUE_SIZE 8
+#endif
+
+#ifndef UNICODE_EVENT_QUEUE_SIZE
+#define UNICODE_EVENT_QUEUE_SIZE 8
+#endif
+
 namespace kaleidoscope {
 namespace plugin {
 class Unicode : public kaleidoscope::Plugin {
@@ -34,13 +43,64 @@ class Unicode : public kaleidoscope::Plugin {
   static void typeCode(uint32_t unicode);
 
   static void input_delay(uint8_t delay) {
-    input_delay_ = delay;
+    for (uint8_t &d : input_delay_)
+      d = delay;
+  }
+  static void input_delay(hostos::Type os, uint8_t delay) {
+    input_delay_[profile(os)] = delay;
   }
   static uint8_t input_delay() {
-    return input_delay_;
+    return input_delay(::HostOS.os());
+  }
+  static uint8_t input_delay(hostos::Type os) {
+    return input_delay_[profile(os)];
   }
+
+  static bool isTyping() {
+    return queue_count_ != 0;
+  }
+
+  EventHandlerResult onKeyswitchEvent(KeyEvent &event);
+  EventHandlerResult afterEachCycle();
+
  private:
-  static uint8_t input_delay_;
+  // The phases of typing a single code point with `type()`.
+  enum class Phase : uint8_t {
+    START,
+    START_HEX,
+    DIGITS,
+    END,
+    RELEASE,
+  };
+
+  // One timing profile for each of `LINUX`, `OSX` and `WINDOWS`, and one for
+  // everything else.
+  static uint8_t input_delay_[hostos::OTHER + 1];
+  static uint8_t profile(hostos::Type os) {
+    return os < hostos::OTHER ? os : hostos::OTHER;
+  }
+
+  static uint32_t queue_[UNICODE_QUEUE_SIZE];
+  static uint8_t queue_head_;
+  static uint8_t queue_count_;
+
+  static Phase phase_;
+  static int8_t digit_;
+  static Key held_keys_[3];
+  static uint16_t last_report_time_;
+
+  // Key events that came in while typing, to be let through once done.
+  static KeyEvent held_events_[UNICODE_EVENT_QUEUE_SIZE];
+  static uint8_t held_events_head_;
+  static uint8_t held_events_count_;
+  static KeyEventTracker event_tracker_;
+
+  static Key digitKey(uint8_t digit);
+  static void holdKeys(Key key1 = Key_NoKey, Key key2 = Key_NoKey,
+                       Key key3 = Key_NoKey);
+  static bool isHeld(Key key);
+  static void typeNextReport();
+  static void releaseHeldEvent();
 };
 }
 }
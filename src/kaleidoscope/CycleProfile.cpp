@@ -0,0 +1,68 @@
+/* Kaleidoscope - Firmware for computer input devices
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "kaleidoscope/CycleProfile.h"
+
+#if KALEIDOSCOPE_CYCLE_PROFILE
+
+#include "kaleidoscope/Runtime.h"
+
+namespace kaleidoscope {
+
+constexpr uint8_t CycleProfile::phase_count;
+
+CycleProfile cycle_profile;
+
+void CycleProfile::charge() {
+  uint32_t now = Runtime.device().micros();
+  this_cycle_[uint8_t(phase_)] += now - phase_start_;
+  phase_start_ = now;
+}
+
+void CycleProfile::startCycle() {
+  phase_ = CyclePhase::BeforeEachCycle;
+  phase_start_ = Runtime.device().micros();
+}
+
+CyclePhase CycleProfile::enter(CyclePhase phase) {
+  charge();
+  CyclePhase outer = phase_;
+  phase_ = phase;
+  return outer;
+}
+
+void CycleProfile::endCycle() {
+  charge();
+  for (uint8_t i = 0; i < phase_count; i++) {
+    total_[i] += this_cycle_[i];
+    if (this_cycle_[i] > max_[i])
+      max_[i] = this_cycle_[i];
+    this_cycle_[i] = 0;
+  }
+  cycles_++;
+}
+
+void CycleProfile::reset() {
+  for (uint8_t i = 0; i < phase_count; i++) {
+    total_[i] = 0;
+    max_[i] = 0;
+  }
+  cycles_ = 0;
+}
+
+}  // namespace kaleidoscope
+
+#endif
@@ -0,0 +1,124 @@
+/* Kaleidoscope - Firmware for computer input devices
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>  // for uint8_t, uint32_t, uint64_t
+
+// Whether to time the phases of each cycle, for `CycleTimeReport` to show where
+// the time goes. It reads the microsecond clock a few times per cycle, and once
+// more per key event, which real keyboards can do without, so it is off by
+// default there; turn it on by defining this to 1 in the build flags (e.g.
+// `LOCAL_CFLAGS`). The virtual device always profiles.
+#ifndef KALEIDOSCOPE_CYCLE_PROFILE
+#ifdef KALEIDOSCOPE_VIRTUAL_BUILD
+#define KALEIDOSCOPE_CYCLE_PROFILE 1
+#else
+#define KALEIDOSCOPE_CYCLE_PROFILE 0
+#endif
+#endif
+
+#if KALEIDOSCOPE_CYCLE_PROFILE
+
+namespace kaleidoscope {
+
+enum class CyclePhase : uint8_t {
+  // The `beforeEachCycle()` handlers.
+  BeforeEachCycle,
+  // Scanning the keyswitches, not counting the events found.
+  ScanMatrix,
+  // Handling key events, and sending the reports they lead to, wherever they
+  // come from.
+  EventHandling,
+  // The `afterEachCycle()` handlers, not counting events or LED updates they
+  // run.
+  AfterEachCycle,
+  // LEDControl updating the LEDs, and computing the next frame.
+  LEDSync,
+};
+
+// Charges every microsecond of a cycle to exactly one phase: when one phase
+// runs inside another (events handled during a scan, say), the outer one is
+// paused until the inner one is done. At the end of each cycle, the time of
+// each phase goes into a running total (for the mean) and maximum.
+class CycleProfile {
+ public:
+  static constexpr uint8_t phase_count = uint8_t(CyclePhase::LEDSync) + 1;
+
+  // Called by `Runtime.loop()` at the start and end of every cycle.
+  void startCycle();
+  void endCycle();
+
+  // Starts charging time to `phase`, and returns the phase that was running
+  // before, for `CyclePhaseScope` to go back to.
+  CyclePhase enter(CyclePhase phase);
+
+  // The number of cycles since the last `reset()`.
+  uint32_t cycles() const {
+    return cycles_;
+  }
+  // The mean and longest time, in microseconds, a phase took per cycle.
+  uint32_t mean(CyclePhase phase) const {
+    return cycles_ ? total_[uint8_t(phase)] / cycles_ : 0;
+  }
+  uint32_t longest(CyclePhase phase) const {
+    return max_[uint8_t(phase)];
+  }
+
+  void reset();
+
+ private:
+  CyclePhase phase_ = CyclePhase::BeforeEachCycle;
+  uint32_t phase_start_ = 0;
+  uint32_t cycles_ = 0;
+  uint32_t this_cycle_[phase_count] = {};
+  // 32 bits of microseconds would only last for an hour.
+  uint64_t total_[phase_count] = {};
+  uint32_t max_[phase_count] = {};
+
+  void charge();
+};
+
+extern CycleProfile cycle_profile;
+
+// Charges the time until the end of the enclosing scope to a phase, then goes
+// back to the one that was running before.
+class CyclePhaseScope {
+ public:
+  explicit CyclePhaseScope(CyclePhase phase)
+    : outer_(cycle_profile.enter(phase)) {}
+  ~CyclePhaseScope() {
+    cycle_profile.enter(outer_);
+  }
+
+ private:
+  CyclePhase outer_;
+};
+
+}  // namespace kaleidoscope
+
+#define _CYCLE_PHASE(PHASE)                                                   \
+  kaleidoscope::cycle_profile.enter(kaleidoscope::CyclePhase::PHASE)
+#define _CYCLE_PHASE_SCOPE(PHASE)                                             \
+  kaleidoscope::CyclePhaseScope cycle_phase_scope__(                          \
+    kaleidoscope::CyclePhase::PHASE)
+
+#else
+
+#define _CYCLE_PHASE(PHASE)
+#define _CYCLE_PHASE_SCOPE(PHASE)
+
+#endif
@@ -152,7 +152,13 @@ class KeyAddrEventQueue {
 
   // Only call this after `EventTracker::shouldIgnore()` returns `true`.
   bool shouldAbort(const KeyEvent& event) const {
-    return (length_ != 0) && (event.id() - event_ids_[0] >= 0);
+    if (length_ == 0)
+      return false;
+    // The difference has to wrap around like the IDs themselves do; otherwise,
+    // an event flushed just before the IDs wrapped looks newer than the ones
+    // still in the queue, and gets aborted.
+    KeyEventId offset = event.id() - event_ids_[0];
+    return offset >= 0;
   }
 };
 
@@ -0,0 +1,68 @@
+/* Kaleidoscope - Firmware for computer input devices
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "kaleidoscope/key_defs.h"
+
+namespace kaleidoscope {
+
+// ================================================================================
+// An approximate set of `Key` values, for plugins that have a table of keys to
+// search on every key event, and want to skip the search for keys that can't be
+// in it. Each key sets a single bit in a small bitmap, chosen by hashing the
+// key, so `mayContain()` can answer `false` with certainty, but may also answer
+// `true` for a key that was never added. A positive answer must be confirmed by
+// searching the table itself.
+//
+// The more keys are added, the more bits are set, and the less useful the
+// filter becomes: with the default of 64 bits, it works best for tables of a
+// couple dozen keys or less.
+template <uint16_t _bits = 64>
+class KeyFilter {
+
+ public:
+
+  static constexpr uint16_t size = _bits;
+  static_assert(size % 8 == 0, "KeyFilter size must be a multiple of 8 bits");
+
+  static constexpr uint16_t bitIndex(Key key) {
+    // Most keys in a table are plain keyboard keys, which differ only in their
+    // keycode, so the keycode is used as-is, and the flags are mixed in to
+    // tell modified variants apart.
+    return (key.getKeyCode() + key.getFlags() * 97) % size;
+  }
+
+  void clear() {
+    memset(data_, 0, sizeof(data_));
+  }
+  void add(Key key) {
+    uint16_t i = bitIndex(key);
+    bitSet(data_[i / 8], i % 8);
+  }
+  bool mayContain(Key key) const {
+    uint16_t i = bitIndex(key);
+    return bitRead(data_[i / 8], i % 8);
+  }
+
+ private:
+
+  uint8_t data_[size / 8] = {};
+};
+
+} // namespace kaleidoscope
@@ -18,10 +18,13 @@
 #include "kaleidoscope/LiveKeys.h"
 #include "kaleidoscope/layers.h"
 #include "kaleidoscope/keyswitch_state.h"
+#include "kaleidoscope/CycleProfile.h"
+#include "kaleidoscope/TraceRing.h"
 
 namespace kaleidoscope {
 
 uint32_t Runtime_::millis_at_cycle_start_;
+uint32_t Runtime_::millis_until_deadline_;
 KeyAddr Runtime_::last_addr_toggled_on_ = KeyAddr::none();
 
 Runtime_::Runtime_(void) {
@@ -54,7 +57,11 @@ Runtime_::setup(void) {
 // ----------------------------------------------------------------------------
 void
 Runtime_::loop(void) {
-  millis_at_cycle_start_ = millis();
+  millis_at_cycle_start_ = device().millis();
+  millis_until_deadline_ = UINT32_MAX;
+#if KALEIDOSCOPE_CYCLE_PROFILE
+  cycle_profile.startCycle();
+#endif
 
   kaleidoscope::Hooks::beforeEachCycle();
 
@@ -78,14 +85,20 @@ Runtime_::loop(void) {
   // possible for more than one event to be handled like this in any given
   // cycle, resulting in multiple HID reports, but guaranteeing that only one
   // event is being handled at a time.
+  _CYCLE_PHASE(ScanMatrix);
   device().scanMatrix();
 
+  _CYCLE_PHASE(AfterEachCycle);
   kaleidoscope::Hooks::afterEachCycle();
+#if KALEIDOSCOPE_CYCLE_PROFILE
+  cycle_profile.endCycle();
+#endif
 }
 
 // ----------------------------------------------------------------------------
 void
 Runtime_::handleKeyswitchEvent(KeyEvent event) {
+  _CYCLE_PHASE_SCOPE(EventHandling);
 
   // This function strictly handles physical key events. Any event without a
   // valid `KeyAddr` gets ignored.
@@ -116,6 +129,10 @@ Runtime_::handleKeyswitchEvent(KeyEvent event) {
 
   // Run the plugin event handlers
   auto result = Hooks::onKeyswitchEvent(event);
+#if KALEIDOSCOPE_TRACE_RING_SIZE
+  trace_ring.record(millis_at_cycle_start_, TraceEvent::KeyswitchEvent,
+                    event, result);
+#endif
 
   // If an event handler changed `event.key` to `Key_Masked` in order to mask
   // that keyswitch, we need to propagate that, but since `handleKeyEvent()`
@@ -148,6 +165,7 @@ Runtime_::handleKeyswitchEvent(KeyEvent event) {
 // ----------------------------------------------------------------------------
 void
 Runtime_::handleKeyEvent(KeyEvent event) {
+  _CYCLE_PHASE_SCOPE(EventHandling);
 
   // For events that didn't begin with `handleKeyswitchEvent()`, we need to look
   // up the `Key` value from the keymap (maybe overridden by `live_keys`).
@@ -160,6 +178,10 @@ Runtime_::handleKeyEvent(KeyEvent event) {
   // If any `onKeyEvent()` handler returns `ABORT`, we return before updating
   // the Live Keys state array; as if the event didn't happen.
   auto result = Hooks::onKeyEvent(event);
+#if KALEIDOSCOPE_TRACE_RING_SIZE
+  trace_ring.record(millis_at_cycle_start_, TraceEvent::KeyEvent,
+                    event, result);
+#endif
   if (result == EventHandlerResult::ABORT)
     return;
 
@@ -344,7 +366,12 @@ Runtime_::sendKeyboardReport(const KeyEvent &event) {
 #endif
 
   // Call new pre-report handlers:
-  if (Hooks::beforeReportingState(event) == EventHandlerResult::ABORT)
+  auto result = Hooks::beforeReportingState(event);
+#if KALEIDOSCOPE_TRACE_RING_SIZE
+  trace_ring.record(millis_at_cycle_start_, TraceEvent::KeyboardReport,
+                    event, result);
+#endif
+  if (result == EventHandlerResult::ABORT)
     return;
 
   // Finally, send the report:
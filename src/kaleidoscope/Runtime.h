@@ -127,6 +127,38 @@ class Runtime_ {
     return (elapsed_time >= ttl);
   }
 
+  /** Declares a pending timer.
+   *
+   * Plugins that have nothing to do until a timer expires can call this every
+   * cycle while the timer is running, with the same arguments they pass to
+   * `hasTimeExpired()`. The earliest deadline declared during a cycle tells
+   * the simulator how many of the cycles that follow it may skip when no keys
+   * change, so that tests of long timeouts need not run every one of them. A
+   * plugin that reacts to the passage of time without declaring its timers
+   * will see those timers expire late under the simulator's fast-forward, but
+   * works as before otherwise.
+   */
+  template <typename _Timestamp, typename _Timeout>
+  static void declareDeadline(_Timestamp start_time, _Timeout ttl) {
+    _Timestamp current_time = millis_at_cycle_start_;
+    _Timestamp elapsed_time = current_time - start_time;
+    // The timeout is often a literal, which would make this a comparison of
+    // signed and unsigned.
+    _Timestamp timeout = static_cast<_Timestamp>(ttl);
+    uint32_t remaining = (elapsed_time >= timeout) ? 0 : timeout - elapsed_time;
+    if (remaining < millis_until_deadline_)
+      millis_until_deadline_ = remaining;
+  }
+
+  /** Returns the time left until the earliest deadline declared this cycle.
+   *
+   * It is counted from the start of the cycle, and is `UINT32_MAX` if no
+   * plugin declared a deadline.
+   */
+  static uint32_t millisUntilDeadline() {
+    return millis_until_deadline_;
+  }
+
   EventHandlerResult onFocusEvent(const char *command) {
     return kaleidoscope::Hooks::onFocusEvent(command);
   }
@@ -206,6 +238,7 @@ class Runtime_ {
 
  private:
   static uint32_t millis_at_cycle_start_;
+  static uint32_t millis_until_deadline_;
   static KeyAddr last_addr_toggled_on_;
 };
 
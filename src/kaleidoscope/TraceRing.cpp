@@ -0,0 +1,31 @@
+/* Kaleidoscope - Firmware for computer input devices
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "kaleidoscope/TraceRing.h"
+
+#if KALEIDOSCOPE_TRACE_RING_SIZE
+
+namespace kaleidoscope {
+
+constexpr uint8_t TraceRing::format_version;
+constexpr uint8_t TraceRing::no_handler;
+constexpr uint16_t TraceRing::size;
+
+TraceRing trace_ring;
+
+}  // namespace kaleidoscope
+
+#endif
@@ -0,0 +1,128 @@
+/* Kaleidoscope - Firmware for computer input devices
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>                          // for uint8_t, uint16_t
+
+#include "kaleidoscope/KeyEvent.h"           // for KeyEvent
+#include "kaleidoscope/event_handler_result.h"  // for EventHandlerResult
+
+// The number of entries in the trace ring, which records the last few key
+// events, and what became of them, so that they can be dumped over Focus after
+// something went wrong. It has to be a power of two. Each entry takes ten bytes
+// of RAM, so the ring is off by default on real keyboards; turn it on by
+// defining this in the build flags (e.g. `LOCAL_CFLAGS`). The virtual device
+// has RAM to spare, so it always records.
+#ifndef KALEIDOSCOPE_TRACE_RING_SIZE
+#ifdef KALEIDOSCOPE_VIRTUAL_BUILD
+#define KALEIDOSCOPE_TRACE_RING_SIZE 256
+#else
+#define KALEIDOSCOPE_TRACE_RING_SIZE 0
+#endif
+#endif
+
+#if KALEIDOSCOPE_TRACE_RING_SIZE
+
+namespace kaleidoscope {
+
+enum class TraceEvent : uint8_t {
+  None,
+  // After the `onKeyswitchEvent()` handlers ran.
+  KeyswitchEvent,
+  // After the `onKeyEvent()` handlers ran.
+  KeyEvent,
+  // After a keyboard report was sent for an event, or not, if a
+  // `beforeReportingState()` handler aborted it.
+  KeyboardReport,
+};
+
+// One entry of the trace. The layout is what `trace.dump` sends, and what
+// `bin/decode-trace` expects, so change all three together, and bump
+// `TraceRing::format_version`.
+struct TraceEntry {
+  // The low 16 bits of `Runtime.millisAtCycleStart()`.
+  uint16_t timestamp;
+  TraceEvent event;
+  KeyEventId id;
+  uint8_t addr;
+  uint8_t state;
+  uint16_t key;
+  // The index of the plugin - in `KALEIDOSCOPE_INIT_PLUGINS()` order - whose
+  // handler stopped the event, or `TraceRing::no_handler`.
+  uint8_t handler;
+  EventHandlerResult result;
+};
+
+class TraceRing {
+ public:
+  static constexpr uint8_t format_version = 1;
+  static constexpr uint8_t no_handler = 0xff;
+  static constexpr uint16_t size = KALEIDOSCOPE_TRACE_RING_SIZE;
+
+  static_assert((size & (size - 1)) == 0,
+                "KALEIDOSCOPE_TRACE_RING_SIZE must be a power of two");
+
+  // Called by the event dispatcher when a hook has run, with the index of the
+  // plugin that ended it, if any.
+  void setHandler(uint8_t index) {
+    handler_ = index;
+  }
+  uint8_t handler() const {
+    return handler_;
+  }
+
+  void record(uint32_t now, TraceEvent event, const KeyEvent &key_event,
+              EventHandlerResult result) {
+    TraceEntry &entry = entries_[head_ & (size - 1)];
+    entry.timestamp = now;
+    entry.event = event;
+    entry.id = key_event.id();
+    entry.addr = key_event.addr.toInt();
+    entry.state = key_event.state;
+    entry.key = key_event.key.getRaw();
+    entry.handler = handler_;
+    entry.result = result;
+    if (++head_ == 2 * size)
+      head_ = size;
+  }
+
+  // The number of entries in the ring, up to `size`.
+  uint16_t count() const {
+    return head_ < size ? head_ : size;
+  }
+  // The `index`th oldest entry still in the ring.
+  const TraceEntry &entry(uint16_t index) const {
+    return entries_[(head_ - count() + index) & (size - 1)];
+  }
+
+  void clear() {
+    head_ = 0;
+  }
+
+ private:
+  TraceEntry entries_[size];
+  // The number of entries recorded since the last `clear()`. Once the ring is
+  // full, it stays between `size` and `2 * size`, so it doesn't overflow.
+  uint16_t head_ = 0;
+  uint8_t handler_ = no_handler;
+};
+
+extern TraceRing trace_ring;
+
+}  // namespace kaleidoscope
+
+#endif
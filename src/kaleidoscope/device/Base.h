@@ -144,6 +144,13 @@ class Base {
     return led_driver_;
   }
 
+  /**
+   * Returns the MCU driver
+   */
+  MCU &mcu() {
+    return mcu_;
+  }
+
   /**
    * Returns the short name of the device.
    */
@@ -279,8 +286,52 @@ class Base {
   void attachToHost() {
     mcu_.attachToHost();
   }
+  /**
+   * Check whether the host has suspended the device.
+   *
+   * @returns true if the host suspended the USB bus, false otherwise, or if
+   * the MCU has no way of telling.
+   */
+  bool isHostSuspended() {
+    return mcu_.isHostSuspended();
+  }
   /** @} */
 
+  /**
+   * Return the number of milliseconds since the device started.
+   *
+   * Plugins should use `Runtime.millisAtCycleStart()` instead, which is read
+   * from here at the start of every cycle.
+   */
+  uint32_t millis() {
+    return mcu_.millis();
+  }
+
+  /**
+   * Return the number of microseconds since the device started, for measuring
+   * how long things take.
+   */
+  uint32_t micros() {
+    return mcu_.micros();
+  }
+
+  /**
+   * Wait for `ms` milliseconds, blocking the rest of the firmware.
+   *
+   * Plugins that have to block should wait with these, rather than with
+   * `::delay()` and `::delayMicroseconds()`, so that the time passes on the
+   * device's clock in the simulator too.
+   */
+  void delay(uint32_t ms) {
+    mcu_.delay(ms);
+  }
+  /**
+   * Wait for `us` microseconds, blocking the rest of the firmware.
+   */
+  void delayMicroseconds(uint16_t us) {
+    mcu_.delayMicroseconds(us);
+  }
+
   /**
    * @defgroup kaleidoscope_hardware_keyswitch_state Kaleidoscope::Hardware/Key-switch state
    *
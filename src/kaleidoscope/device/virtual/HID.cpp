@@ -27,6 +27,7 @@
 #include "HID.h"
 
 #include "HIDReportObserver.h"
+#include "kaleidoscope/device/virtual/HIDCounters.h"
 
 #if defined(USBCON)
 
@@ -61,6 +62,7 @@ void HID_::AppendDescriptor(HIDSubDescriptor *node) {
 }
 
 int HID_::SendReport(uint8_t id, const void *data, int len) {
+  kaleidoscope::device::virt::HIDCounters::countReport(len);
   HIDReportObserver::observeReport(id, data, len, 0);
   return 1;
 }
@@ -0,0 +1,61 @@
+/* Kaleidoscope - Firmware for computer input devices
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef KALEIDOSCOPE_VIRTUAL_BUILD
+
+#include <stdint.h>
+
+namespace kaleidoscope {
+namespace device {
+namespace virt {
+
+// Keeps count of the HID reports sent to the (virtual) host, and of their
+// size, so that tests can measure how much USB traffic a plugin generates.
+// Every report, whatever its type, goes through `HID_::SendReport()`, which
+// does the counting.
+//
+class HIDCounters {
+ public:
+
+  static void countReport(int len) {
+    report_count_++;
+    bytes_sent_ += len;
+  }
+
+  static uint32_t reportCount() {
+    return report_count_;
+  }
+  static uint32_t bytesSent() {
+    return bytes_sent_;
+  }
+  static void resetCounters() {
+    report_count_ = 0;
+    bytes_sent_ = 0;
+  }
+
+ private:
+
+  static uint32_t report_count_;
+  static uint32_t bytes_sent_;
+};
+
+} // namespace virt
+} // namespace device
+} // namespace kaleidoscope
+
+#endif // ifdef KALEIDOSCOPE_VIRTUAL_BUILD
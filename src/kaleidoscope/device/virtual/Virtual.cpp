@@ -19,6 +19,7 @@
 
 #include "kaleidoscope/device/virtual/Virtual.h"
 #include "kaleidoscope/device/virtual/DefaultHIDReportConsumer.h"
+#include "kaleidoscope/device/virtual/HIDCounters.h"
 #include "kaleidoscope/device/virtual/Logging.h"
 
 #include "kaleidoscope/keyswitch_state.h"
@@ -54,6 +55,11 @@ namespace virt {
 
 using namespace kaleidoscope::logging; // NOLINT(build/namespaces)
 
+// Defined here rather than in HID.cpp, which stands in for a part of
+// KeyboardioHID.
+uint32_t HIDCounters::report_count_ = 0;
+uint32_t HIDCounters::bytes_sent_ = 0;
+
 //##############################################################################
 // VirtualKeyScanner
 //##############################################################################
@@ -314,6 +320,8 @@ bool VirtualKeyScanner::anythingHeld() {
 // VirtualLEDDriver
 //##############################################################################
 
+VirtualLEDDriver::SyncHook VirtualLEDDriver::sync_hook_ = nullptr;
+
 void VirtualLEDDriver::setup() {
   for (int i = 0; i < led_count; i++) {
     led_states_[i] = CRGB(0, 0, 0);
@@ -321,6 +329,8 @@ void VirtualLEDDriver::setup() {
 }
 
 void VirtualLEDDriver::syncLeds() {
+  sync_count_++;
+
   // log format: red.green.blue where values are written in hex; followed by a space, followed by the next LED
   std::stringstream ss;
   ss << std::hex;
@@ -332,6 +342,9 @@ void VirtualLEDDriver::syncLeds() {
 
   ss << std::endl;
   logLEDStates(ss.str());
+
+  if (sync_hook_)
+    sync_hook_(led_states_, led_count);
 }
 
 void VirtualLEDDriver::setCrgbAt(uint8_t i, cRGB color) {
@@ -339,6 +352,7 @@ void VirtualLEDDriver::setCrgbAt(uint8_t i, cRGB color) {
     log_error("Virtual::setCrgbAt: Index %d out of bounds\n", i);
     return;
   }
+  write_count_++;
   led_states_[i] = color;
 }
 
@@ -350,6 +364,22 @@ cRGB VirtualLEDDriver::getCrgbAt(uint8_t i) const {
   return led_states_[i];
 }
 
+cRGB VirtualLEDDriver::getCorrectedCrgbAt(uint8_t i) const {
+  cRGB color = getCrgbAt(i);
+
+  color.r = color_correction_.apply(color.r);
+  color.g = color_correction_.apply(color.g);
+  color.b = color_correction_.apply(color.b);
+
+  return color;
+}
+
+//##############################################################################
+// VirtualMCU
+//##############################################################################
+
+uint8_t VirtualMCU::host_keyboard_leds_ = 0;
+
 } // namespace virt
 } // namespace device
 
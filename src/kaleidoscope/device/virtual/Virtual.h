@@ -23,6 +23,7 @@
 
 #include "kaleidoscope/driver/bootloader/None.h"
 #include "kaleidoscope/driver/led/Base.h"
+#include "kaleidoscope/driver/led/ColorCorrection.h"
 
 namespace kaleidoscope {
 namespace device {
@@ -53,6 +54,7 @@ class VirtualKeyScanner
   void setup();
   void readMatrix();
   void scanMatrix() {
+    scan_count_++;
     this->readMatrix();
     this->actOnMatrixScan();
   }
@@ -71,6 +73,15 @@ class VirtualKeyScanner
   void setKeystate(KeyAddr keyAddr, KeyState ks);
   KeyState getKeystate(KeyAddr keyAddr) const;
 
+  // The number of times the matrix was scanned. On the physical keyboard, each
+  // scan is a transaction on the bus the keyscanners are attached to.
+  uint32_t scanCount() const {
+    return scan_count_;
+  }
+  void resetCounters() {
+    scan_count_ = 0;
+  }
+
  private:
 
   bool anythingHeld();
@@ -85,6 +96,8 @@ class VirtualKeyScanner
   KeyState keystates_[matrix_rows * matrix_columns]; // NOLINT(runtime/arrays)
   KeyState keystates_prev_[matrix_rows * matrix_columns]; // NOLINT(runtime/arrays)
 
+  uint32_t scan_count_ = 0;
+
 };
 
 class VirtualLEDDriver
@@ -101,9 +114,215 @@ class VirtualLEDDriver
   void setCrgbAt(uint8_t i, cRGB color);
   cRGB getCrgbAt(uint8_t i) const;
 
+  void setBrightness(uint8_t brightness) {
+    color_correction_.setBrightness(brightness);
+  }
+  uint8_t getBrightness() const {
+    return color_correction_.getBrightness();
+  }
+
+  // The color the hardware would display at index `i`, with brightness and
+  // gamma correction applied.
+  cRGB getCorrectedCrgbAt(uint8_t i) const;
+
+  // Called with the contents of the LED buffer every time it is synced, so
+  // that the frames sent to the (virtual) hardware can be recorded.
+  typedef void (*SyncHook)(const cRGB *led_states, uint8_t led_count);
+  static void setSyncHook(SyncHook hook) {
+    sync_hook_ = hook;
+  }
+
+  // The number of times `setCrgbAt()` was called, so that tests can measure
+  // how much work an LED mode does, and the number of times the LEDs were
+  // synced, each of which sends the whole buffer to the hardware.
+  uint32_t writeCount() const {
+    return write_count_;
+  }
+  uint32_t syncCount() const {
+    return sync_count_;
+  }
+  void resetCounters() {
+    write_count_ = 0;
+    sync_count_ = 0;
+  }
+
  private:
 
   cRGB led_states_[led_count]; // NOLINT(runtime/arrays)
+  driver::led::ColorCorrection color_correction_;
+  uint32_t write_count_ = 0;
+  uint32_t sync_count_ = 0;
+
+  static SyncHook sync_hook_;
+};
+
+// Storage that behaves exactly like the storage of the physical keyboard, but
+// keeps count of how many reads were made, how many bytes were read and
+// written, and how many times changes were committed, so that tests can measure
+// how much storage traffic a plugin generates.
+//
+class VirtualStorage : public kaleidoscope::DeviceProps::Storage {
+ public:
+
+  typedef kaleidoscope::DeviceProps::Storage ParentType;
+
+  template<typename T>
+  T& get(uint16_t offset, T& t) {
+    read_count_++;
+    bytes_read_ += sizeof(T);
+    return ParentType::get(offset, t);
+  }
+
+  uint8_t read(int idx) {
+    read_count_++;
+    bytes_read_++;
+    return ParentType::read(idx);
+  }
+
+  template<typename T>
+  const T& put(uint16_t offset, T& t) {
+    bytes_written_ += sizeof(T);
+    return ParentType::put(offset, t);
+  }
+
+  void update(int idx, uint8_t val) {
+    bytes_written_++;
+    ParentType::update(idx, val);
+  }
+
+  void commit() {
+    commit_count_++;
+    ParentType::commit();
+  }
+
+  uint32_t readCount() const {
+    return read_count_;
+  }
+  uint32_t bytesRead() const {
+    return bytes_read_;
+  }
+  uint32_t bytesWritten() const {
+    return bytes_written_;
+  }
+  uint32_t commitCount() const {
+    return commit_count_;
+  }
+  void resetCounters() {
+    read_count_ = 0;
+    bytes_read_ = 0;
+    bytes_written_ = 0;
+    commit_count_ = 0;
+  }
+
+ private:
+
+  uint32_t read_count_ = 0;
+  uint32_t bytes_read_ = 0;
+  uint32_t bytes_written_ = 0;
+  uint32_t commit_count_ = 0;
+};
+
+// The clock of the virtual device, in microseconds. Reading it has no side
+// effects: time only passes when the simulator, or a test, says so, however
+// often the firmware looks at the clock. `millis()` and `micros()` wrap around
+// the way they do on a real MCU.
+class VirtualClock {
+ public:
+  uint32_t millis() const {
+    return now_ / 1000;
+  }
+  uint32_t micros() const {
+    return now_;
+  }
+
+  void advance(uint64_t micros) {
+    now_ += micros;
+  }
+  void set(uint64_t micros) {
+    now_ = micros;
+  }
+
+ private:
+  uint64_t now_ = 0;
+};
+
+// An MCU without a USB bus of its own: the host is never suspended, unless a
+// test says so, which lets tests exercise the suspend & resume code paths. The
+// same goes for the keyboard LEDs (Num Lock, Caps Lock, ...) the host would
+// set; they are all off unless a test turns them on.
+//
+// Its clock is a `VirtualClock`, rather than the one of the virtual core, which
+// moves every time it is read. Waiting with `delay()` moves it ahead, without
+// waiting.
+//
+class VirtualMCU : public kaleidoscope::driver::mcu::Base<kaleidoscope::driver::mcu::BaseProps> {
+ public:
+
+  bool isHostSuspended() {
+    return host_suspended_;
+  }
+  void setHostSuspended(bool suspended) {
+    host_suspended_ = suspended;
+  }
+
+  // Static, because the HID drivers that report them have no way to get at
+  // the device's MCU.
+  static uint8_t hostKeyboardLEDs() {
+    return host_keyboard_leds_;
+  }
+  static void setHostKeyboardLEDs(uint8_t leds) {
+    host_keyboard_leds_ = leds;
+  }
+
+  uint32_t millis() {
+    return clock_.millis();
+  }
+  uint32_t micros() {
+    return clock_.micros();
+  }
+  void delay(uint32_t ms) {
+    clock_.advance(uint64_t(ms) * 1000);
+  }
+  void delayMicroseconds(uint16_t us) {
+    clock_.advance(us);
+  }
+  VirtualClock &clock() {
+    return clock_;
+  }
+
+ private:
+
+  bool host_suspended_ = false;
+  VirtualClock clock_;
+
+  static uint8_t host_keyboard_leds_;
+};
+
+// The keyboards of the physical device, except that the state of the keyboard
+// LEDs comes from the virtual MCU, rather than from a host.
+//
+class VirtualBootKeyboard : public driver::hid::keyboardio::BootKeyboardWrapper {
+ public:
+  uint8_t getLeds() {
+    return VirtualMCU::hostKeyboardLEDs();
+  }
+};
+
+class VirtualNKROKeyboard : public driver::hid::keyboardio::NKROKeyboardWrapper {
+ public:
+  uint8_t getLeds() {
+    return VirtualMCU::hostKeyboardLEDs();
+  }
+};
+
+struct VirtualKeyboardProps : public driver::hid::keyboardio::KeyboardProps {
+  typedef VirtualBootKeyboard BootKeyboard;
+  typedef VirtualNKROKeyboard NKROKeyboard;
+};
+
+struct VirtualHIDProps : public driver::hid::KeyboardioProps {
+  typedef VirtualKeyboardProps KeyboardProps;
+  typedef driver::hid::keyboardio::Keyboard<KeyboardProps> Keyboard;
 };
 
 // This overrides only the drivers and keeps the driver props of
@@ -122,14 +341,20 @@ struct VirtualProps : public kaleidoscope::DeviceProps {
   typedef VirtualLEDDriver
   LEDDriver;
 
-  typedef kaleidoscope::driver::mcu::None MCU;
+  typedef VirtualMCU
+  MCU;
+
+  typedef VirtualHIDProps
+  HIDProps;
+  typedef driver::hid::Keyboardio<HIDProps>
+  HID;
 
   typedef kaleidoscope::driver::bootloader::None
   BootLoader;
 
   typedef typename kaleidoscope::DeviceProps::StorageProps
   StorageProps;
-  typedef typename kaleidoscope::DeviceProps::Storage
+  typedef VirtualStorage
   Storage;
 };
 
@@ -0,0 +1,88 @@
+/* -*- mode: c++ -*-
+ * kaleidoscope::driver::led::ColorCorrection -- Brightness & gamma correction
+ * Copyright (C) 2021  Keyboard.io, Inc
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "kaleidoscope/driver/color/GammaCorrection.h"
+
+// Where RAM is plentiful, precompute the corrected value of every possible
+// color component whenever the brightness changes, so that transmitting the
+// LED data is a single table lookup per byte. On AVR, the 256 bytes are better
+// spent elsewhere, and we compute the same values on the fly: that costs a few
+// more cycles per byte, next to nothing compared to sending the byte over TWI.
+#ifndef KALEIDOSCOPE_LED_COLOR_CORRECTION_TABLE
+#if defined(ARDUINO_ARCH_SAMD) || defined(KALEIDOSCOPE_VIRTUAL_BUILD)
+#define KALEIDOSCOPE_LED_COLOR_CORRECTION_TABLE 1
+#else
+#define KALEIDOSCOPE_LED_COLOR_CORRECTION_TABLE 0
+#endif
+#endif
+
+namespace kaleidoscope {
+namespace driver {
+namespace led {
+
+// The output stage shared by LED drivers: it maps the color components stored
+// in the LED buffers to the values sent to the hardware, applying the current
+// brightness first, and gamma correction second.
+class ColorCorrection {
+ public:
+  ColorCorrection() {
+    setBrightness(255);
+  }
+
+  static uint8_t correct(uint8_t component, uint8_t brightness) {
+    uint8_t adjustment = 255 - brightness;
+
+    if (component > adjustment)
+      component -= adjustment;
+    else
+      component = 0;
+
+    return pgm_read_byte(&driver::color::gamma_correction[component]);
+  }
+
+  void setBrightness(uint8_t brightness) {
+    brightness_ = brightness;
+#if KALEIDOSCOPE_LED_COLOR_CORRECTION_TABLE
+    for (uint16_t c = 0; c < 256; c++)
+      table_[c] = correct(c, brightness);
+#endif
+  }
+  uint8_t getBrightness() const {
+    return brightness_;
+  }
+
+  uint8_t apply(uint8_t component) const {
+#if KALEIDOSCOPE_LED_COLOR_CORRECTION_TABLE
+    return table_[component];
+#else
+    return correct(component, brightness_);
+#endif
+  }
+
+ private:
+  uint8_t brightness_;
+#if KALEIDOSCOPE_LED_COLOR_CORRECTION_TABLE
+  uint8_t table_[256];
+#endif
+};
+
+}
+}
+}
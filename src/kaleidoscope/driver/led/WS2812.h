@@ -35,6 +35,7 @@
 
 #include "kaleidoscope/hardware/avr/pins_and_ports.h"
 #include "kaleidoscope/driver/led/Color.h"
+#include "kaleidoscope/driver/led/ColorCorrection.h"
 #include "ws2812/config.h"
 
 namespace kaleidoscope {
@@ -56,7 +57,11 @@ class WS2812 {
 
     DDR_OUTPUT(pin);
 
-    sendArrayWithMask(pinmask_);
+    if (corrected_) {
+      sendCorrected();
+    } else {
+      sendArrayWithMask(reinterpret_cast<uint8_t *>(leds_), pinmask_);
+    }
     _delay_us(50);
     modified_ = false;
   }
@@ -79,13 +84,37 @@ class WS2812 {
     return leds_[index];
   }
 
+  void setBrightness(uint8_t brightness) {
+    modified_ = true;
+    corrected_ = true;
+    color_correction_.setBrightness(brightness);
+  }
+  uint8_t getBrightness() {
+    return color_correction_.getBrightness();
+  }
+
  private:
   Color leds_[ledCount]; // NOLINT(runtime/arrays)
+  ColorCorrection color_correction_;
   uint8_t pinmask_;
   bool modified_ = false;
+  // Until a brightness is set, colors are sent as they are, without gamma
+  // correction either.
+  bool corrected_ = false;
+
+  // Corrects the colors up front, so that the timing-critical loop of
+  // `sendArrayWithMask()`, which runs with interrupts disabled, only has to send
+  // bytes. Kept out of line, so that the copy is only on the stack while a
+  // brightness is set, rather than on every sync.
+  __attribute__((noinline)) void sendCorrected() {
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(leds_);
+    uint8_t corrected[ledCount * sizeof(Color)]; // NOLINT(runtime/arrays)
+    for (uint16_t i = 0; i < sizeof(corrected); i++)
+      corrected[i] = color_correction_.apply(data[i]);
+    sendArrayWithMask(corrected, pinmask_);
+  }
 
-  void sendArrayWithMask(uint8_t maskhi) {
-    uint8_t *data = reinterpret_cast<uint8_t *>(leds_);
+  void sendArrayWithMask(const uint8_t *data, uint8_t maskhi) {
     uint16_t datalen = ledCount * sizeof(Color);
     uint8_t curbyte, ctr, masklo;
     uint8_t sreg_prev;
@@ -97,7 +126,7 @@ class WS2812 {
     cli();
 
     while (datalen--) {
-      curbyte = (*data++);
+      curbyte = *data++;
 
       asm volatile(
         "       ldi   %0,8  \n\t"
@@ -19,6 +19,12 @@
 
 #include "kaleidoscope/driver/mcu/Base.h"
 
+#ifndef KALEIDOSCOPE_VIRTUAL_BUILD
+// This is a terrible hack until Arduino#6964 gets implemented.
+// It makes the `_usbSuspendState` symbol available to us.
+extern uint8_t _usbSuspendState;
+#endif
+
 namespace kaleidoscope {
 namespace driver {
 namespace mcu {
@@ -38,6 +44,9 @@ class ATmega32U4 : public kaleidoscope::driver::mcu::Base<_Props> {
   void attachToHost() {
     UDCON &= ~_BV(DETACH);
   }
+  bool isHostSuspended() {
+    return (_usbSuspendState & (1 << SUSPI));
+  }
 
   static void disableJTAG() {
     /* These two lines here are the result of many hours spent chasing ghosts.
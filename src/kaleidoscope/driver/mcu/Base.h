@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <Arduino.h>
+
 namespace kaleidoscope {
 namespace driver {
 namespace mcu {
@@ -43,6 +45,46 @@ class Base {
    * Must restore the link detachFromHost severed.
    */
   void attachToHost() {}
+  /**
+   * Check whether the host has suspended the device.
+   *
+   * Must return true while the USB bus is suspended, and false otherwise.
+   */
+  bool isHostSuspended() {
+    return false;
+  }
+
+  /**
+   * Return the number of milliseconds since the MCU started.
+   *
+   * This is the clock the whole firmware runs on.
+   */
+  uint32_t millis() {
+    return ::millis();
+  }
+
+  /**
+   * Return the number of microseconds since the MCU started.
+   *
+   * Only meant for measuring how long things take; it wraps around after a
+   * bit more than an hour.
+   */
+  uint32_t micros() {
+    return ::micros();
+  }
+
+  /**
+   * Wait for `ms` milliseconds, doing nothing else meanwhile.
+   */
+  void delay(uint32_t ms) {
+    ::delay(ms);
+  }
+  /**
+   * Wait for `us` microseconds, doing nothing else meanwhile.
+   */
+  void delayMicroseconds(uint16_t us) {
+    ::delayMicroseconds(us);
+  }
 };
 
 }
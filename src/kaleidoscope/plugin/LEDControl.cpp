@@ -17,6 +17,7 @@
 #include "Kaleidoscope-LEDControl.h"
 #include "Kaleidoscope-FocusSerial.h"
 #include "kaleidoscope_internal/LEDModeManager.h"
+#include "kaleidoscope/CycleProfile.h"
 #include "kaleidoscope/keyswitch_state.h"
 #include "kaleidoscope/LiveKeys.h"
 
@@ -159,6 +160,9 @@ void LEDControl::enable() {
   enabled_ = true;
   refreshAll();
   Runtime.device().syncLeds();
+  // We just synced, and the timer was not kept running while disabled, so
+  // restart it, lest we try to make up for all the skipped syncs at once.
+  last_sync_time_ = Runtime.millisAtCycleStart();
 }
 
 EventHandlerResult LEDControl::onKeyEvent(KeyEvent &event) {
@@ -203,6 +207,7 @@ EventHandlerResult LEDControl::afterEachCycle() {
     return EventHandlerResult::OK;
 
   if (Runtime.hasTimeExpired(last_sync_time_, sync_interval_)) {
+    _CYCLE_PHASE_SCOPE(LEDSync);
 #ifndef NDEPRECATED
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
@@ -213,6 +218,7 @@ EventHandlerResult LEDControl::afterEachCycle() {
     last_sync_time_ += sync_interval_;
     update();
   }
+  Runtime.declareDeadline(last_sync_time_, sync_interval_);
 
   return EventHandlerResult::OK;
 }
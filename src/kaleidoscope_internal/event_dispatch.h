@@ -39,6 +39,7 @@
 #include "kaleidoscope_internal/eventhandler_signature_check.h"
 #include "kaleidoscope/event_handlers.h"
 #include "kaleidoscope_internal/sketch_exploration/sketch_exploration.h"
+#include "kaleidoscope/TraceRing.h"
 
 // Some words about the design of hook routing:
 //
@@ -162,14 +163,33 @@
                                                                           __NL__ \
    }
 
+// When the trace ring is on, the dispatcher tells it which plugin - by its
+// index in the list - ended a hook early, so that the trace can show who
+// swallowed an event. The index is a compile time constant in each step of
+// the loop, so this costs a single store per hook call.
+#if KALEIDOSCOPE_TRACE_RING_SIZE
+#define _TRACE_PLUGIN_INDEX_INIT                                            \
+   uint8_t plugin_index__ = 0;
+#define _TRACE_PLUGIN_INDEX_NEXT                                            \
+   plugin_index__++;
+#define _TRACE_HANDLER(INDEX)                                               \
+   kaleidoscope::trace_ring.setHandler(INDEX);
+#else
+#define _TRACE_PLUGIN_INDEX_INIT
+#define _TRACE_PLUGIN_INDEX_NEXT
+#define _TRACE_HANDLER(INDEX)
+#endif
+
 #define _INLINE_EVENT_HANDLER_FOR_PLUGIN(PLUGIN)                            \
                                                                      __NL__ \
    result = EventHandler__::call(PLUGIN, hook_args...);              __NL__ \
                                                                      __NL__ \
    if (EventHandler__::shouldExitIfResultNotOk() &&                  __NL__ \
        result != kaleidoscope::EventHandlerResult::OK) {             __NL__ \
+      _TRACE_HANDLER(plugin_index__)                                 __NL__ \
       return result;                                                 __NL__ \
-   }                                                                 __NL__
+   }                                                                 __NL__ \
+   _TRACE_PLUGIN_INDEX_NEXT                                          __NL__
 
 // _KALEIDOSCOPE_INIT_PLUGINS builds the loops that execute the plugins'
 // implementations of the various event handlers.
@@ -191,8 +211,10 @@
     static kaleidoscope::EventHandlerResult apply(Args__&&... hook_args) {    __NL__ \
                                                                               __NL__ \
       kaleidoscope::EventHandlerResult result;                                __NL__ \
+      _TRACE_PLUGIN_INDEX_INIT                                                __NL__ \
       MAP(_INLINE_EVENT_HANDLER_FOR_PLUGIN, __VA_ARGS__)                      __NL__ \
                                                                               __NL__ \
+      _TRACE_HANDLER(kaleidoscope::TraceRing::no_handler)                     __NL__ \
       return result;                                                          __NL__ \
     }                                                                         __NL__ \
   };                                                                          __NL__ \
@@ -0,0 +1,141 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/Benchmark.h"
+
+#include "testing/State.h"
+
+// Out of order due to macro conflicts.
+#include "testing/fix-macros.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include "gtest/gtest.h"
+
+namespace kaleidoscope {
+namespace testing {
+
+void Benchmark::Start() {
+  State::Snapshot();
+
+  cycles_ = 0;
+  events_ = 0;
+  pending_events_ = 0;
+  nsec_total_ = 0;
+  nsec_event_cycles_ = 0;
+  wall_nsec_total_ = 0;
+  keyboard_reports_ = 0;
+  mouse_reports_ = 0;
+  led_frames_ = 0;
+}
+
+void Benchmark::Press(KeyAddr key_addr) {
+  sim_.Press(key_addr);
+  events_++;
+  pending_events_++;
+}
+
+void Benchmark::Release(KeyAddr key_addr) {
+  sim_.Release(key_addr);
+  events_++;
+  pending_events_++;
+}
+
+void Benchmark::RunCycle() {
+  auto before = OperationCounts::Current();
+  auto start = std::chrono::steady_clock::now();
+  sim_.RunCycle();
+  auto end = std::chrono::steady_clock::now();
+
+  uint64_t nsec = costs_.Cost(OperationCounts::Current() - before);
+  nsec_total_ += nsec;
+  wall_nsec_total_ +=
+    std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  cycles_++;
+
+  // The keyscanner picks up every pending state change in a single cycle, so
+  // that cycle is charged to the events.
+  if (pending_events_ > 0) {
+    nsec_event_cycles_ += nsec;
+    pending_events_ = 0;
+  }
+}
+
+void Benchmark::RunCycles(size_t n) {
+  for (size_t i = 0; i < n; ++i) RunCycle();
+}
+
+void Benchmark::RunForMillis(size_t t) {
+  auto start_time = Kaleidoscope.millisAtCycleStart();
+  while (Kaleidoscope.millisAtCycleStart() - start_time < t) {
+    RunCycle();
+  }
+}
+
+void Benchmark::Finish() {
+  auto state = State::Snapshot();
+  keyboard_reports_ = state->HIDReports()->Keyboard().size();
+  mouse_reports_ = state->HIDReports()->Mouse().size();
+  led_frames_ = state->LEDs()->FramesSynced();
+
+  const ::testing::TestInfo *info =
+    ::testing::UnitTest::GetInstance()->current_test_info();
+  std::string name = std::string(info->test_suite_name()) + "." + info->name();
+
+  ::testing::Test::RecordProperty("cycles", std::to_string(cycles_));
+  ::testing::Test::RecordProperty("events", std::to_string(events_));
+  ::testing::Test::RecordProperty(
+    "nsec_per_cycle", std::to_string(cycles_ ? nsec_total_ / cycles_ : 0));
+  ::testing::Test::RecordProperty(
+    "nsec_per_event", std::to_string(events_ ? nsec_event_cycles_ / events_ : 0));
+  ::testing::Test::RecordProperty("costs", costs_.name);
+  ::testing::Test::RecordProperty(
+    "wall_nsec_per_cycle", std::to_string(cycles_ ? wall_nsec_total_ / cycles_ : 0));
+  ::testing::Test::RecordProperty("keyboard_reports", std::to_string(keyboard_reports_));
+  ::testing::Test::RecordProperty("mouse_reports", std::to_string(mouse_reports_));
+  ::testing::Test::RecordProperty("led_frames", std::to_string(led_frames_));
+
+  writeResults(name);
+}
+
+void Benchmark::writeResults(const std::string &name) const {
+  const char *dir = std::getenv("KALEIDOSCOPE_BENCHMARK_DIR");
+  if (dir == nullptr || *dir == '\0')
+    return;
+
+  std::ofstream out(std::string(dir) + "/" + name + ".json");
+  if (!out) {
+    ADD_FAILURE() << "Could not write benchmark results to " << dir;
+    return;
+  }
+
+  out << "{\n"
+      << "  \"name\": \"" << name << "\",\n"
+      << "  \"cycles\": " << cycles_ << ",\n"
+      << "  \"events\": " << events_ << ",\n"
+      << "  \"costs\": \"" << costs_.name << "\",\n"
+      << "  \"metrics\": {\n"
+      << "    \"nsec_per_cycle\": " << (cycles_ ? nsec_total_ / cycles_ : 0) << ",\n"
+      << "    \"nsec_per_event\": " << (events_ ? nsec_event_cycles_ / events_ : 0) << ",\n"
+      << "    \"keyboard_reports\": " << keyboard_reports_ << ",\n"
+      << "    \"mouse_reports\": " << mouse_reports_ << ",\n"
+      << "    \"led_frames\": " << led_frames_ << "\n"
+      << "  }\n"
+      << "}\n";
+}
+
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,104 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "testing/Cost.h"
+#include "testing/SimHarness.h"
+
+// Out of order due to macro conflicts.
+#include "testing/fix-macros.h"
+
+namespace kaleidoscope {
+namespace testing {
+
+// A scripted workload run through the simulator, costing every cycle of the
+// whole firmware - `Kaleidoscope.loop()` and every plugin hook along the way.
+//
+// The cost of a cycle is that of the operations it did (see `OperationCounts`)
+// on the MCU of the given `CostTable`, so the results are the same on every
+// run, and every machine. The wall-clock time of the cycles is recorded too,
+// for information only.
+//
+// Key events fed through `Press()` & `Release()` are counted, and the cycles
+// that follow them are costed separately, so the cost of processing an event
+// can be told apart from the cost of an idle cycle. `Finish()` counts the HID
+// reports and LED frames produced since `Start()`, records every metric as a
+// gtest property, and, if the `KALEIDOSCOPE_BENCHMARK_DIR` environment
+// variable is set, writes them to `<Suite>.<Test>.json` in that directory, for
+// `testing/bin/compare-benchmarks` to compare against a baseline.
+class Benchmark {
+ public:
+  explicit Benchmark(SimHarness &sim,
+                     const CostTable &costs = atmega32u4_costs)
+    : sim_(sim), costs_(costs) {}
+
+  // Discards any reports and LED frames produced before the workload, and
+  // resets all counters.
+  void Start();
+
+  void Press(KeyAddr key_addr);
+  void Release(KeyAddr key_addr);
+
+  void RunCycle();
+  void RunCycles(size_t n);
+  void RunForMillis(size_t t);
+
+  // Ends the workload, and reports its results under the name of the running
+  // test.
+  void Finish();
+
+  size_t Cycles() const {
+    return cycles_;
+  }
+  size_t Events() const {
+    return events_;
+  }
+  size_t KeyboardReports() const {
+    return keyboard_reports_;
+  }
+  size_t MouseReports() const {
+    return mouse_reports_;
+  }
+  size_t LEDFrames() const {
+    return led_frames_;
+  }
+
+ private:
+  SimHarness &sim_;
+  const CostTable &costs_;
+
+  size_t cycles_ = 0;
+  size_t events_ = 0;
+  size_t pending_events_ = 0;
+
+  uint64_t nsec_total_ = 0;
+  uint64_t nsec_event_cycles_ = 0;
+  uint64_t wall_nsec_total_ = 0;
+
+  size_t keyboard_reports_ = 0;
+  size_t mouse_reports_ = 0;
+  size_t led_frames_ = 0;
+
+  void writeResults(const std::string &name) const;
+};
+
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,108 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/Cost.h"
+
+#include "kaleidoscope/Runtime.h"
+#include "kaleidoscope/device/virtual/HIDCounters.h"
+
+namespace kaleidoscope {
+namespace testing {
+
+OperationCounts OperationCounts::Current() {
+  auto &device = Runtime.device();
+  OperationCounts counts;
+
+  counts.matrix_scans = device.keyScanner().scanCount();
+  counts.storage_reads = device.storage().readCount();
+  counts.storage_bytes_read = device.storage().bytesRead();
+  counts.storage_bytes_written = device.storage().bytesWritten();
+  counts.storage_commits = device.storage().commitCount();
+  counts.hid_reports = device::virt::HIDCounters::reportCount();
+  counts.hid_bytes_sent = device::virt::HIDCounters::bytesSent();
+  counts.led_writes = device.ledDriver().writeCount();
+  counts.led_syncs = device.ledDriver().syncCount();
+
+  return counts;
+}
+
+OperationCounts OperationCounts::operator-(const OperationCounts &other) const {
+  OperationCounts diff;
+
+  diff.matrix_scans = matrix_scans - other.matrix_scans;
+  diff.storage_reads = storage_reads - other.storage_reads;
+  diff.storage_bytes_read = storage_bytes_read - other.storage_bytes_read;
+  diff.storage_bytes_written = storage_bytes_written - other.storage_bytes_written;
+  diff.storage_commits = storage_commits - other.storage_commits;
+  diff.hid_reports = hid_reports - other.hid_reports;
+  diff.hid_bytes_sent = hid_bytes_sent - other.hid_bytes_sent;
+  diff.led_writes = led_writes - other.led_writes;
+  diff.led_syncs = led_syncs - other.led_syncs;
+
+  return diff;
+}
+
+void PrintTo(const OperationCounts &counts, std::ostream *os) {
+  *os << "{matrix_scans: " << counts.matrix_scans
+      << ", storage_reads: " << counts.storage_reads
+      << ", storage_bytes_read: " << counts.storage_bytes_read
+      << ", storage_bytes_written: " << counts.storage_bytes_written
+      << ", storage_commits: " << counts.storage_commits
+      << ", hid_reports: " << counts.hid_reports
+      << ", hid_bytes_sent: " << counts.hid_bytes_sent
+      << ", led_writes: " << counts.led_writes
+      << ", led_syncs: " << counts.led_syncs << "}";
+}
+
+uint64_t CostTable::Cost(const OperationCounts &counts) const {
+  return uint64_t(matrix_scan) * counts.matrix_scans +
+         uint64_t(storage_byte_read) * counts.storage_bytes_read +
+         uint64_t(storage_byte_written) * counts.storage_bytes_written +
+         uint64_t(storage_commit) * counts.storage_commits +
+         uint64_t(hid_report) * counts.hid_reports +
+         uint64_t(led_sync) * counts.led_syncs;
+}
+
+// One byte on a 400kHz TWI bus takes nine clocks: 22.5us. A scan reads five
+// bytes from each of the two keyscanners, plus an address byte for each; a sync
+// sends three bytes for each of the 64 LEDs, in eight banks of eight, each with
+// a command byte. Writing a byte of EEPROM takes 3.4ms, during which the CPU
+// can't touch EEPROM again, and there is nothing to commit. Loading a report
+// into the USB endpoint's buffer takes a few tens of microseconds.
+const CostTable atmega32u4_costs = {
+  "ATmega32U4",
+  12 * 22500,          // matrix_scan
+  1000,                // storage_byte_read
+  3400000,             // storage_byte_written
+  0,                   // storage_commit
+  50000,               // hid_report
+  (64 * 3 + 8) * 22500 // led_sync
+};
+
+// Storage is a copy in RAM of a few flash rows, so reads and writes are cheap,
+// but a commit erases and rewrites every row, at several milliseconds each.
+const CostTable samd_costs = {
+  "SAMD21",
+  12 * 22500,          // matrix_scan
+  100,                 // storage_byte_read
+  100,                 // storage_byte_written
+  20000000,            // storage_commit
+  20000,               // hid_report
+  (64 * 3 + 8) * 22500 // led_sync
+};
+
+}  // namespace testing
+}  // namespace kaleidoscope
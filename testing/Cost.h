@@ -0,0 +1,78 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+namespace kaleidoscope {
+namespace testing {
+
+// The operations that cost next to nothing on the virtual device, but take a
+// long time on a real keyboard: scanning the matrix and syncing the LEDs (both
+// over a bus, on most keyboards), reading and writing storage, and sending HID
+// reports. The counts are those kept by the drivers of the virtual device.
+//
+// Take a snapshot before and after a workload, and the difference is what the
+// workload cost:
+//
+//   auto before = OperationCounts::Current();
+//   sim_.Press(key_addr_Fn);
+//   RunCycle();
+//   EXPECT_THAT(OperationCounts::Current() - before, StorageReadsAtMost(1));
+struct OperationCounts {
+  uint32_t matrix_scans = 0;
+  uint32_t storage_reads = 0;
+  uint32_t storage_bytes_read = 0;
+  uint32_t storage_bytes_written = 0;
+  uint32_t storage_commits = 0;
+  uint32_t hid_reports = 0;
+  uint32_t hid_bytes_sent = 0;
+  uint32_t led_writes = 0;
+  uint32_t led_syncs = 0;
+
+  static OperationCounts Current();
+
+  OperationCounts operator-(const OperationCounts &other) const;
+};
+
+void PrintTo(const OperationCounts &counts, std::ostream *os);
+
+// What each operation would cost on a real MCU, in nanoseconds. These are
+// estimates, good enough to tell whether a change made a code path cheaper or
+// more expensive on a given target, not to predict its actual run time.
+struct CostTable {
+  const char *name;
+  uint32_t matrix_scan;
+  uint32_t storage_byte_read;
+  uint32_t storage_byte_written;
+  uint32_t storage_commit;
+  uint32_t hid_report;
+  uint32_t led_sync;
+
+  uint64_t Cost(const OperationCounts &counts) const;
+};
+
+// An ATmega32U4 at 16MHz, with two keyscanners and the LEDs on a 400kHz TWI
+// bus, like the Model01.
+extern const CostTable atmega32u4_costs;
+// A SAMD21 at 48MHz, with storage emulated in flash, like the Raise, on the
+// same bus as above.
+extern const CostTable samd_costs;
+
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,208 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/KeyStorm.h"
+
+#include "kaleidoscope/LiveKeys.h"
+#include "testing/State.h"
+
+// Out of order due to macro conflicts.
+#include "testing/fix-macros.h"
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace kaleidoscope {
+namespace testing {
+
+KeyStorm::KeyStorm(SimHarness &sim, uint32_t seed)
+  : sim_(sim), seed_(seed), state_(seed ? seed : 1) {
+  for (KeyAddr key_addr : KeyAddr::all())
+    keys_.push_back(key_addr);
+  pressed_.assign(keys_.size(), false);
+  State::Snapshot();
+}
+
+uint32_t KeyStorm::SeedFromEnvironment(uint32_t default_seed) {
+  const char *seed = std::getenv("KALEIDOSCOPE_STORM_SEED");
+  if (seed == nullptr || *seed == '\0')
+    return default_seed;
+  return std::strtoul(seed, nullptr, 0);
+}
+
+void KeyStorm::SetKeys(const std::vector<KeyAddr> &keys) {
+  keys_ = keys;
+  pressed_.assign(keys_.size(), false);
+}
+
+void KeyStorm::SetConcurrency(uint8_t min, uint8_t max) {
+  min_concurrency_ = min;
+  max_concurrency_ = max;
+}
+
+void KeyStorm::SetGap(uint16_t min, uint16_t max) {
+  min_gap_ = min;
+  max_gap_ = max;
+}
+
+void KeyStorm::Run(size_t bursts) {
+  std::vector<size_t> order(keys_.size());
+  for (size_t i = 0; i < order.size(); i++)
+    order[i] = i;
+
+  for (size_t burst = 0; burst < bursts; burst++) {
+    size_t count = std::min<size_t>(between(min_concurrency_, max_concurrency_),
+                                    keys_.size());
+
+    // Pick `count` different keys, by shuffling just as much of the list as
+    // needed.
+    for (size_t i = 0; i < count; i++) {
+      size_t j = between(i, order.size() - 1);
+      std::swap(order[i], order[j]);
+
+      size_t k = order[i];
+      if (pressed_[k]) {
+        sim_.Release(keys_[k]);
+      } else {
+        sim_.Press(keys_[k]);
+      }
+      pressed_[k] = !pressed_[k];
+      events_++;
+    }
+
+    runCycle();
+    for (uint16_t gap = between(min_gap_, max_gap_); gap > 0; gap--)
+      runCycle();
+  }
+}
+
+void KeyStorm::Settle(size_t settle_time) {
+  for (size_t k = 0; k < keys_.size(); k++) {
+    if (pressed_[k]) {
+      sim_.Release(keys_[k]);
+      pressed_[k] = false;
+      events_++;
+    }
+  }
+
+  auto start_time = Kaleidoscope.millisAtCycleStart();
+  do {
+    runCycle();
+  } while (Kaleidoscope.millisAtCycleStart() - start_time < settle_time);
+}
+
+void KeyStorm::Check(size_t settle_time, const CostTable &costs,
+                     uint64_t max_cycle_nsec) {
+  SCOPED_TRACE("KALEIDOSCOPE_STORM_SEED=" + std::to_string(seed_));
+
+  Settle(settle_time);
+  auto state = State::Snapshot();
+
+  EXPECT_THAT(ActiveKeys(), ::testing::IsEmpty())
+      << "No keys are stuck in `live_keys`";
+
+  // Walk the reports in order, and pair each keycode that shows up in one with
+  // the first later one it's gone from. Whatever is left was never released.
+  const auto &reports = state->HIDReports()->Keyboard();
+  EXPECT_FALSE(reports.empty());
+  std::map<uint8_t, size_t> pressed_in;
+  for (size_t i = 0; i < reports.size(); i++) {
+    std::vector<uint8_t> keycodes = reports[i].ActiveKeycodes();
+    for (auto it = pressed_in.begin(); it != pressed_in.end();) {
+      if (std::find(keycodes.begin(), keycodes.end(), it->first) == keycodes.end()) {
+        it = pressed_in.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    for (uint8_t keycode : keycodes)
+      pressed_in.emplace(keycode, i);
+  }
+  for (const auto &pressed : pressed_in) {
+    ADD_FAILURE() << "Keycode " << int(pressed.first) << ", pressed in report "
+                  << pressed.second << " (at "
+                  << reports[pressed.second].Timestamp()
+                  << "ms), is never released";
+  }
+
+  OperationCounts worst = WorstCycle(costs);
+  EXPECT_LE(costs.Cost(worst), max_cycle_nsec)
+      << "No cycle does runaway work; the worst one on " << costs.name
+      << " was " << ::testing::PrintToString(worst);
+
+  ::testing::Test::RecordProperty("seed", std::to_string(seed_));
+  ::testing::Test::RecordProperty("cycles", std::to_string(Cycles()));
+  ::testing::Test::RecordProperty("events", std::to_string(events_));
+  ::testing::Test::RecordProperty("nsec_worst_cycle", std::to_string(costs.Cost(worst)));
+  ::testing::Test::RecordProperty("nsec_p99_cycle",
+                                  std::to_string(PercentileCycleCost(costs, 99)));
+}
+
+OperationCounts KeyStorm::WorstCycle(const CostTable &costs) const {
+  OperationCounts worst;
+  for (const OperationCounts &counts : cycle_counts_) {
+    if (costs.Cost(counts) > costs.Cost(worst))
+      worst = counts;
+  }
+  return worst;
+}
+
+uint64_t KeyStorm::PercentileCycleCost(const CostTable &costs,
+                                       uint8_t percentile) const {
+  if (cycle_counts_.empty())
+    return 0;
+  std::vector<uint64_t> sorted;
+  for (const OperationCounts &counts : cycle_counts_)
+    sorted.push_back(costs.Cost(counts));
+  size_t index = (sorted.size() - 1) * percentile / 100;
+  std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+  return sorted[index];
+}
+
+// xorshift32: cheap, and the same sequence on every platform, unlike the
+// distributions of <random>.
+uint32_t KeyStorm::next() {
+  state_ ^= state_ << 13;
+  state_ ^= state_ >> 17;
+  state_ ^= state_ << 5;
+  return state_;
+}
+
+uint32_t KeyStorm::between(uint32_t min, uint32_t max) {
+  if (max <= min)
+    return min;
+  return min + next() % (max - min + 1);
+}
+
+void KeyStorm::runCycle() {
+  auto before = OperationCounts::Current();
+  sim_.RunCycle();
+  cycle_counts_.push_back(OperationCounts::Current() - before);
+}
+
+std::vector<KeyAddr> ActiveKeys() {
+  std::vector<KeyAddr> active;
+  for (KeyAddr key_addr : KeyAddr::all()) {
+    if (live_keys[key_addr] != Key_Inactive)
+      active.push_back(key_addr);
+  }
+  return active;
+}
+
+}  // namespace testing
+}  // namespace kaleidoscope
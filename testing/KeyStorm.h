@@ -0,0 +1,111 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "testing/Cost.h"
+#include "testing/SimHarness.h"
+
+// Out of order due to macro conflicts.
+#include "testing/fix-macros.h"
+
+namespace kaleidoscope {
+namespace testing {
+
+// Random storms of key presses and releases, fed to the firmware through the
+// simulator.
+//
+// A storm is a number of bursts. In each burst, between `min` and `max` keys
+// of the chosen set change state - held keys are released, the others pressed
+// - all within a single scan, followed by a random number of idle cycles. The
+// operations of every cycle are counted (see `testing/Cost.h`), so the worst
+// case and the percentiles of the cost of a cycle can be checked, the same on
+// every machine.
+//
+// Any reports sent before the storm is created are discarded, so that
+// `Check()` only looks at the ones the storm caused.
+//
+// The whole storm is determined by the seed, so a failing storm can be
+// replayed by running it again with the same seed: `SeedFromEnvironment()`
+// lets the `KALEIDOSCOPE_STORM_SEED` environment variable override a test's
+// default seed.
+class KeyStorm {
+ public:
+  KeyStorm(SimHarness &sim, uint32_t seed);
+
+  static uint32_t SeedFromEnvironment(uint32_t default_seed);
+
+  // The keys the storm presses and releases. All of them, by default.
+  void SetKeys(const std::vector<KeyAddr> &keys);
+  // How many keys change state in each burst.
+  void SetConcurrency(uint8_t min, uint8_t max);
+  // How many cycles to run between bursts, besides the one of the burst itself.
+  void SetGap(uint16_t min, uint16_t max);
+
+  void Run(size_t bursts);
+  // Releases every key the storm left pressed, and runs the firmware for
+  // `settle_time` milliseconds, to give any pending timeouts time to expire.
+  void Settle(size_t settle_time);
+
+  // Settles the storm, then checks that it left nothing behind: no key active
+  // in `live_keys`, and every keycode pressed in a keyboard report released in
+  // a later one. It also checks that no cycle would take longer than
+  // `max_cycle_nsec` with the given costs, and records the seed and the cost
+  // of the storm as properties of the running test.
+  void Check(size_t settle_time, const CostTable &costs, uint64_t max_cycle_nsec);
+
+  uint32_t Seed() const {
+    return seed_;
+  }
+  size_t Cycles() const {
+    return cycle_counts_.size();
+  }
+  size_t Events() const {
+    return events_;
+  }
+  // The operations of the cycle that costs the most with the given costs.
+  OperationCounts WorstCycle(const CostTable &costs) const;
+  uint64_t PercentileCycleCost(const CostTable &costs, uint8_t percentile) const;
+
+ private:
+  SimHarness &sim_;
+  uint32_t seed_;
+  uint32_t state_;
+
+  std::vector<KeyAddr> keys_;
+  std::vector<bool> pressed_;
+  uint8_t min_concurrency_ = 8;
+  uint8_t max_concurrency_ = 15;
+  uint16_t min_gap_ = 0;
+  uint16_t max_gap_ = 20;
+
+  size_t events_ = 0;
+  std::vector<OperationCounts> cycle_counts_;
+
+  uint32_t next();
+  uint32_t between(uint32_t min, uint32_t max);
+  void runCycle();
+};
+
+// Returns every key that is still active in `live_keys`.
+std::vector<KeyAddr> ActiveKeys();
+
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,86 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/LEDState.h"
+
+#include "testing/fix-macros.h"
+
+namespace kaleidoscope {
+namespace testing {
+
+LEDFrame::LEDFrame(const cRGB* led_states) {
+  for (uint8_t i = 0; i < kLEDCount; i++)
+    led_states_[i] = led_states[i];
+  timestamp_ = Runtime.millisAtCycleStart();
+}
+
+uint32_t LEDFrame::Timestamp() const {
+  return timestamp_;
+}
+
+const cRGB& LEDFrame::At(uint8_t led_index) const {
+  return led_states_.at(led_index);
+}
+
+const cRGB& LEDFrame::At(KeyAddr key_addr) const {
+  return At(Runtime.device().getLedIndex(key_addr));
+}
+
+const cRGB& LEDState::At(uint8_t led_index) const {
+  return buffer_.At(led_index);
+}
+
+const cRGB& LEDState::At(KeyAddr key_addr) const {
+  return buffer_.At(key_addr);
+}
+
+const std::vector<LEDFrame>& LEDState::Frames() const {
+  return frames_;
+}
+
+const LEDFrame& LEDState::Frame(size_t i) const {
+  return frames_.at(i);
+}
+
+size_t LEDState::FramesSynced() const {
+  return frames_.size();
+}
+
+namespace internal {
+
+std::vector<LEDFrame> LEDStateBuilder::frames_;
+
+// static
+void LEDStateBuilder::ProcessLEDFrame(const cRGB* led_states, uint8_t led_count) {
+  frames_.emplace_back(led_states);
+}
+
+// static
+std::unique_ptr<LEDState> LEDStateBuilder::Snapshot() {
+  std::array<cRGB, LEDFrame::kLEDCount> buffer;
+  for (uint8_t i = 0; i < LEDFrame::kLEDCount; i++)
+    buffer[i] = Runtime.device().getCrgbAt(i);
+
+  std::unique_ptr<LEDState> state(new LEDState(LEDFrame(buffer.data())));
+  state->frames_ = std::move(frames_);
+  frames_.clear();
+
+  return state;
+}
+
+}  // namespace internal
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,87 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Kaleidoscope.h"
+
+// Out of order due to macro conflicts.
+#include "testing/fix-macros.h"
+#include <memory>
+
+namespace kaleidoscope {
+namespace testing {
+namespace internal {
+class LEDStateBuilder;
+}
+
+// A copy of the colors of every LED, along with the time it was taken.
+class LEDFrame {
+ public:
+  static constexpr uint8_t kLEDCount = kaleidoscope::Device::led_count;
+
+  explicit LEDFrame(const cRGB* led_states);
+
+  uint32_t Timestamp() const;
+  const cRGB& At(uint8_t led_index) const;
+  const cRGB& At(KeyAddr key_addr) const;
+
+ private:
+  uint32_t timestamp_;
+  std::array<cRGB, kLEDCount> led_states_;
+};
+
+class LEDState {
+ public:
+  // The contents of the LED buffer at the time of the snapshot, regardless of
+  // whether they were synced to the hardware yet.
+  const cRGB& At(uint8_t led_index) const;
+  const cRGB& At(KeyAddr key_addr) const;
+
+  // The frames synced to the hardware since the previous snapshot.
+  const std::vector<LEDFrame>& Frames() const;
+  const LEDFrame& Frame(size_t i) const;
+  size_t FramesSynced() const;
+
+ private:
+  friend class internal::LEDStateBuilder;
+
+  explicit LEDState(const LEDFrame& buffer) : buffer_(buffer) {}
+
+  LEDFrame buffer_;
+  std::vector<LEDFrame> frames_;
+};
+
+namespace internal {
+
+class LEDStateBuilder {
+ public:
+  static void ProcessLEDFrame(const cRGB* led_states, uint8_t led_count);
+
+  static std::unique_ptr<LEDState> Snapshot();
+
+ private:
+  static std::vector<LEDFrame> frames_;
+};
+
+}  // namespace internal
+}  // namespace testing
+}  // namespace kaleidoscope
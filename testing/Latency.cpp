@@ -0,0 +1,178 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/Latency.h"
+
+#include "testing/State.h"
+
+// Out of order due to macro conflicts.
+#include "testing/fix-macros.h"
+#include <algorithm>
+#include <set>
+
+namespace kaleidoscope {
+namespace testing {
+
+void LatencyHistogram::Add(uint32_t millis, uint32_t cycles) {
+  millis_.push_back(millis);
+  cycles_.push_back(cycles);
+}
+
+// The nearest-rank percentile: the smallest sample that is at least as large as
+// `percentile` percent of them.
+static uint32_t percentileOf(std::vector<uint32_t> samples, uint8_t percentile) {
+  if (samples.empty())
+    return 0;
+  size_t rank = (samples.size() * percentile + 99) / 100;
+  size_t index = rank > 0 ? rank - 1 : 0;
+  std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+  return samples[index];
+}
+
+uint32_t LatencyHistogram::Percentile(uint8_t percentile) const {
+  return percentileOf(millis_, percentile);
+}
+
+uint32_t LatencyHistogram::PercentileCycles(uint8_t percentile) const {
+  return percentileOf(cycles_, percentile);
+}
+
+std::map<uint32_t, size_t> LatencyHistogram::Buckets() const {
+  std::map<uint32_t, size_t> buckets;
+  for (uint32_t millis : millis_)
+    buckets[millis]++;
+  return buckets;
+}
+
+void PrintTo(const LatencyHistogram &histogram, std::ostream *os) {
+  *os << histogram.Count() << " samples, p50 " << histogram.Percentile(50)
+      << "ms, p99 " << histogram.Percentile(99) << "ms, max " << histogram.Max()
+      << "ms (" << histogram.PercentileCycles(100) << " cycles) {";
+  const char *separator = "";
+  for (auto bucket : histogram.Buckets()) {
+    *os << separator << bucket.first << "ms: " << bucket.second;
+    separator = ", ";
+  }
+  *os << "}";
+}
+
+std::ostream &operator<<(std::ostream &os, const LatencyHistogram &histogram) {
+  PrintTo(histogram, &os);
+  return os;
+}
+
+void LatencyProbe::Start() {
+  State::Snapshot();
+
+  changes_.clear();
+  cycle_timestamps_.clear();
+  presses_ = LatencyHistogram();
+  releases_ = LatencyHistogram();
+  all_ = LatencyHistogram();
+  per_key_.clear();
+  unmatched_ = 0;
+}
+
+void LatencyProbe::Press(KeyAddr key_addr, Key key) {
+  sim_.Press(key_addr);
+  tag(key_addr, key, true);
+}
+
+void LatencyProbe::Release(KeyAddr key_addr, Key key) {
+  sim_.Release(key_addr);
+  tag(key_addr, key, false);
+}
+
+void LatencyProbe::tag(KeyAddr key_addr, Key key, bool pressed) {
+  Change change;
+  change.key_addr = key_addr;
+  change.keycode = key.getKeyCode();
+  change.pressed = pressed;
+  change.timestamp = Runtime.millisAtCycleStart();
+  change.cycle = cycle_timestamps_.size();
+  changes_.push_back(change);
+}
+
+void LatencyProbe::RunCycle() {
+  sim_.RunCycle();
+  cycle_timestamps_.push_back(Runtime.millisAtCycleStart());
+}
+
+void LatencyProbe::RunCycles(size_t n) {
+  for (size_t i = 0; i < n; ++i) RunCycle();
+}
+
+void LatencyProbe::RunForMillis(size_t t) {
+  auto start_time = Runtime.millisAtCycleStart();
+  while (Runtime.millisAtCycleStart() - start_time < t) {
+    RunCycle();
+  }
+}
+
+void LatencyProbe::Finish() {
+  auto state = State::Snapshot();
+  const auto &reports = state->HIDReports()->Keyboard();
+
+  // The keycodes held in each report, and in the one before it, which for the
+  // first report is assumed to have been empty.
+  std::vector<std::set<uint8_t>> keycodes(reports.size() + 1);
+  for (size_t i = 0; i < reports.size(); i++) {
+    auto active = reports[i].ActiveKeycodes();
+    keycodes[i + 1].insert(active.begin(), active.end());
+  }
+
+  for (const Change &change : changes_) {
+    // Reports from the cycle the change followed were sent before it.
+    auto first = std::upper_bound(
+                   reports.begin(), reports.end(), change.timestamp,
+    [](uint32_t timestamp, const KeyboardReport & report) {
+      return timestamp < report.Timestamp();
+    });
+
+    bool matched = false;
+    for (size_t i = first - reports.begin(); i < reports.size(); i++) {
+      bool before = keycodes[i].count(change.keycode);
+      bool after = keycodes[i + 1].count(change.keycode);
+      if (before == after || after != change.pressed)
+        continue;
+
+      uint32_t report_time = reports[i].Timestamp();
+      size_t report_cycle = std::lower_bound(cycle_timestamps_.begin(),
+                                             cycle_timestamps_.end(),
+                                             report_time) - cycle_timestamps_.begin();
+      uint32_t millis = report_time - change.timestamp;
+      uint32_t cycles = report_cycle + 1 - change.cycle;
+
+      (change.pressed ? presses_ : releases_).Add(millis, cycles);
+      all_.Add(millis, cycles);
+      per_key_[change.key_addr.toInt()].Add(millis, cycles);
+      matched = true;
+      break;
+    }
+
+    if (!matched)
+      unmatched_++;
+  }
+}
+
+const LatencyHistogram &LatencyProbe::ForKey(KeyAddr key_addr) const {
+  static const LatencyHistogram empty;
+  auto it = per_key_.find(key_addr.toInt());
+  return it == per_key_.end() ? empty : it->second;
+}
+
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,141 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <vector>
+
+#include "testing/SimHarness.h"
+
+// Out of order due to macro conflicts.
+#include "testing/fix-macros.h"
+#include "gtest/gtest.h"
+
+namespace kaleidoscope {
+namespace testing {
+
+// A collection of latencies, in milliseconds and in cycles.
+class LatencyHistogram {
+ public:
+  void Add(uint32_t millis, uint32_t cycles);
+
+  size_t Count() const {
+    return millis_.size();
+  }
+  // The latency that `percentile` percent of the samples are at or under, or 0
+  // if there are none.
+  uint32_t Percentile(uint8_t percentile) const;
+  uint32_t PercentileCycles(uint8_t percentile) const;
+  uint32_t Max() const {
+    return Percentile(100);
+  }
+
+  // The number of samples for each latency, in milliseconds.
+  std::map<uint32_t, size_t> Buckets() const;
+
+ private:
+  std::vector<uint32_t> millis_;
+  std::vector<uint32_t> cycles_;
+};
+
+void PrintTo(const LatencyHistogram &histogram, std::ostream *os);
+std::ostream &operator<<(std::ostream &os, const LatencyHistogram &histogram);
+
+// Measures the latency between a change in a keyswitch's state, and the first
+// keyboard report that reflects it - what a user of delay-type plugins, like
+// Qukeys or SpaceCadet, feels.
+//
+// Every `Press()` and `Release()` is tagged with the time of the cycle before
+// it, when the change physically happened, and with the key it is expected to
+// produce. `Finish()` then matches each press with the first later report in
+// which that key's keycode appears, and each release with the first in which it
+// disappears. A change with no such report counts as unmatched. The earliest a
+// change can show up is in the next cycle, so the latency is never less than
+// the cycle time. Run the cycles through the probe, so that it can count them.
+class LatencyProbe {
+ public:
+  explicit LatencyProbe(SimHarness &sim) : sim_(sim) {}
+
+  // Discards any reports produced before the workload, and all samples.
+  void Start();
+
+  void Press(KeyAddr key_addr, Key key);
+  void Release(KeyAddr key_addr, Key key);
+
+  void RunCycle();
+  void RunCycles(size_t n);
+  void RunForMillis(size_t t);
+
+  // Matches every change since `Start()` to the reports produced since then.
+  void Finish();
+
+  const LatencyHistogram &Presses() const {
+    return presses_;
+  }
+  const LatencyHistogram &Releases() const {
+    return releases_;
+  }
+  // Both presses and releases.
+  const LatencyHistogram &All() const {
+    return all_;
+  }
+  // Both presses and releases of a single keyswitch.
+  const LatencyHistogram &ForKey(KeyAddr key_addr) const;
+  size_t Unmatched() const {
+    return unmatched_;
+  }
+
+ private:
+  struct Change {
+    KeyAddr key_addr;
+    uint8_t keycode;
+    bool pressed;
+    uint32_t timestamp;
+    size_t cycle;
+  };
+
+  SimHarness &sim_;
+
+  std::vector<Change> changes_;
+  std::vector<uint32_t> cycle_timestamps_;
+
+  LatencyHistogram presses_;
+  LatencyHistogram releases_;
+  LatencyHistogram all_;
+  std::map<uint16_t, LatencyHistogram> per_key_;
+  size_t unmatched_ = 0;
+
+  void tag(KeyAddr key_addr, Key key, bool pressed);
+};
+
+}  // namespace testing
+}  // namespace kaleidoscope
+
+// Check the latencies gathered by a `LatencyProbe`, printing the whole
+// histogram if they are too long:
+//
+//   EXPECT_P99_LATENCY_LE(probe.Presses(), 10) << "Presses show up in 10ms";
+#define EXPECT_LATENCY_PERCENTILE_LE(histogram, percentile, millis)     \
+  EXPECT_LE((histogram).Percentile(percentile), (millis))               \
+      << "Latencies: " << (histogram) << "\n"
+#define EXPECT_P99_LATENCY_LE(histogram, millis)                        \
+  EXPECT_LATENCY_PERCENTILE_LE(histogram, 99, millis)
+#define EXPECT_MAX_LATENCY_LE(histogram, millis)                        \
+  EXPECT_LATENCY_PERCENTILE_LE(histogram, 100, millis)
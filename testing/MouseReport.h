@@ -0,0 +1,49 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "HID-Settings.h"
+#include "MultiReport/Mouse.h"
+
+namespace kaleidoscope {
+namespace testing {
+
+class MouseReport {
+ public:
+  typedef HID_MouseReport_Data_t ReportData;
+
+  static constexpr uint8_t kHidReportType = HID_REPORTID_MOUSE;
+
+  MouseReport(const void* data);
+
+  uint32_t Timestamp() const;
+  std::vector<uint8_t> Buttons() const;
+  int8_t XAxis() const;
+  int8_t YAxis() const;
+  int8_t VWheel() const;
+  int8_t HWheel() const;
+
+ private:
+  uint32_t timestamp_;
+  ReportData report_data_;
+};
+
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,115 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/Parallel.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <deque>
+#include <sstream>
+
+namespace kaleidoscope {
+namespace testing {
+
+namespace {
+
+struct Worker {
+  pid_t pid;
+  int output;
+};
+
+Worker Start(const SimulationJob &job) {
+  int fds[2];
+  if (pipe(fds) != 0)
+    return Worker{-1, -1};
+
+  // Anything still buffered would be written out once more by the child.
+  std::fflush(nullptr);
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    std::ostringstream out;
+    // An exception let out of here would unwind into the child's copy of the
+    // caller, and carry on running the rest of the tests there.
+    try {
+      job(out);
+    } catch (...) {
+      _exit(1);
+    }
+    const std::string output = out.str();
+    for (size_t written = 0; written < output.size();) {
+      ssize_t n = write(fds[1], output.data() + written, output.size() - written);
+      if (n <= 0)
+        _exit(1);
+      written += n;
+    }
+    // Skip the destructors and exit handlers, which belong to the parent.
+    _exit(0);
+  }
+
+  close(fds[1]);
+  if (pid < 0) {
+    close(fds[0]);
+    return Worker{-1, -1};
+  }
+  return Worker{pid, fds[0]};
+}
+
+JobResult Finish(const Worker &worker) {
+  JobResult result;
+  if (worker.pid < 0)
+    return result;
+
+  char buffer[4096];
+  ssize_t n;
+  while ((n = read(worker.output, buffer, sizeof(buffer))) > 0)
+    result.output.append(buffer, n);
+  close(worker.output);
+
+  int status;
+  if (waitpid(worker.pid, &status, 0) == worker.pid)
+    result.completed = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  return result;
+}
+
+}  // namespace
+
+std::vector<JobResult> RunInParallel(const std::vector<SimulationJob> &jobs,
+                                     unsigned workers) {
+  if (workers == 0) {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    workers = processors > 0 ? processors : 1;
+  }
+
+  std::vector<JobResult> results;
+  std::deque<Worker> running;
+  size_t next = 0;
+  while (results.size() < jobs.size()) {
+    while (next < jobs.size() && running.size() < workers)
+      running.push_back(Start(jobs[next++]));
+    // The oldest job is collected first, so results come in order; the others
+    // keep running in the meantime.
+    results.push_back(Finish(running.front()));
+    running.pop_front();
+  }
+  return results;
+}
+
+}  // namespace testing
+}  // namespace kaleidoscope
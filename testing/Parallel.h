@@ -0,0 +1,50 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace kaleidoscope {
+namespace testing {
+
+// A simulation that can run on its own, writing what it finds to `out`.
+typedef std::function<void(std::ostream &out)> SimulationJob;
+
+struct JobResult {
+  std::string output;
+  // False if the job crashed, threw, or exited before it finished.
+  bool completed = false;
+};
+
+// Runs `jobs` side by side, on at most `workers` processors at a time (all of
+// them, if zero), and returns what each one wrote, in the same order.
+//
+// The firmware keeps its state in globals: the virtual device, the keymap,
+// every plugin. So each job runs in a process of its own, forked from this one,
+// with a copy of all of that as it was when `RunInParallel()` was called.
+// Nothing a job changes reaches the caller, or any other job; that includes
+// gtest assertions, so a job should write what it finds, and the caller check
+// that. A job should set up everything it depends on (plugin settings, the
+// cycle time) itself, rather than rely on what the jobs before it did.
+std::vector<JobResult> RunInParallel(const std::vector<SimulationJob> &jobs,
+                                     unsigned workers = 0);
+
+}  // namespace testing
+}  // namespace kaleidoscope
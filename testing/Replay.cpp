@@ -0,0 +1,454 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/Replay.h"
+
+#include "HIDReportObserver.h"
+#include "testing/State.h"
+
+// Out of order due to macro conflicts.
+#include "testing/fix-macros.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <utility>
+
+namespace kaleidoscope {
+namespace testing {
+
+namespace {
+
+constexpr char binary_magic[] = {'K', 'T', 'R', '\x01'};
+
+const char *const type_names[] = {
+  "press", "release", "leds", "suspend", "resume"
+};
+constexpr uint8_t type_count = sizeof(type_names) / sizeof(type_names[0]);
+
+}  // namespace
+
+bool ReplayEvent::operator==(const ReplayEvent &other) const {
+  return time == other.time && type == other.type &&
+         key_addr == other.key_addr && leds == other.leds;
+}
+
+// -----------------------------------------------------------------------------
+// EventTrace
+
+bool EventTrace::Read(std::istream &in) {
+  events_.clear();
+  error_.clear();
+
+  char magic[sizeof(binary_magic)];
+  in.read(magic, sizeof(magic));
+  if (in.gcount() == sizeof(magic) &&
+      std::equal(magic, magic + sizeof(magic), binary_magic))
+    return readBinary(in);
+
+  // Not a binary trace, so start over and read it as text.
+  in.clear();
+  in.seekg(0);
+  return readText(in);
+}
+
+bool EventTrace::ReadFile(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    events_.clear();
+    error_ = "Could not open " + path;
+    return false;
+  }
+  return Read(in);
+}
+
+bool EventTrace::readText(std::istream &in) {
+  std::string line;
+  for (size_t line_number = 1; std::getline(in, line); line_number++) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields(line);
+
+    ReplayEvent event = {};
+    std::string name;
+    if (!(fields >> event.time))
+      continue;  // Blank or comment
+
+    fields >> name;
+    uint8_t type = std::find(type_names, type_names + type_count, name) - type_names;
+    event.type = ReplayEvent::Type(type);
+
+    unsigned row = 0, col = 0, leds = 0;
+    bool valid = type < type_count;
+    if (event.type == ReplayEvent::Type::Press ||
+        event.type == ReplayEvent::Type::Release) {
+      valid = valid && (fields >> row >> col) &&
+              row < KeyAddr::rows && col < KeyAddr::cols;
+      event.key_addr = KeyAddr(row, col);
+    } else if (event.type == ReplayEvent::Type::HostLEDs) {
+      valid = valid && (fields >> leds) && leds <= 0xff;
+      event.leds = leds;
+    }
+
+    std::string rest;
+    if (!valid || (fields >> rest)) {
+      error_ = "Malformed event on line " + std::to_string(line_number) +
+               ": " + line;
+      return false;
+    }
+    if (!add(event, line_number))
+      return false;
+  }
+  return true;
+}
+
+bool EventTrace::readBinary(std::istream &in) {
+  uint8_t record[8];
+  for (size_t index = 0;
+       in.read(reinterpret_cast<char *>(record), sizeof(record));
+       index++) {
+    ReplayEvent event = {};
+    event.time = uint32_t(record[0]) | uint32_t(record[1]) << 8 |
+                 uint32_t(record[2]) << 16 | uint32_t(record[3]) << 24;
+    event.type = ReplayEvent::Type(record[4]);
+    bool valid = record[4] < type_count;
+    if (event.type == ReplayEvent::Type::Press ||
+        event.type == ReplayEvent::Type::Release) {
+      valid = valid && record[5] < KeyAddr::rows && record[6] < KeyAddr::cols;
+      event.key_addr = KeyAddr(record[5], record[6]);
+    }
+    if (!valid) {
+      error_ = "Malformed event #" + std::to_string(index);
+      return false;
+    }
+    event.leds = record[7];
+    if (!add(event, index))
+      return false;
+  }
+  if (in.gcount() != 0) {
+    error_ = "Truncated event at the end of the trace";
+    return false;
+  }
+  return true;
+}
+
+bool EventTrace::add(const ReplayEvent &event, size_t position) {
+  if (!events_.empty() && event.time < events_.back().time) {
+    error_ = "Event " + std::to_string(position) + " is out of order";
+    return false;
+  }
+  events_.push_back(event);
+  return true;
+}
+
+void EventTrace::WriteText(std::ostream &out) const {
+  for (const ReplayEvent &event : events_) {
+    out << event.time << " " << type_names[uint8_t(event.type)];
+    if (event.type == ReplayEvent::Type::Press ||
+        event.type == ReplayEvent::Type::Release) {
+      out << " " << int(event.key_addr.row()) << " " << int(event.key_addr.col());
+    } else if (event.type == ReplayEvent::Type::HostLEDs) {
+      out << " " << int(event.leds);
+    }
+    out << "\n";
+  }
+}
+
+void EventTrace::WriteBinary(std::ostream &out) const {
+  out.write(binary_magic, sizeof(binary_magic));
+  for (const ReplayEvent &event : events_) {
+    bool has_addr = event.type == ReplayEvent::Type::Press ||
+                    event.type == ReplayEvent::Type::Release;
+    char record[8] = {
+      char(event.time),
+      char(event.time >> 8),
+      char(event.time >> 16),
+      char(event.time >> 24),
+      char(event.type),
+      char(has_addr ? event.key_addr.row() : 0),
+      char(has_addr ? event.key_addr.col() : 0),
+      char(event.leds),
+    };
+    out.write(record, sizeof(record));
+  }
+}
+
+void EventTrace::Press(uint32_t time, KeyAddr key_addr) {
+  events_.push_back({time, ReplayEvent::Type::Press, key_addr, 0});
+}
+
+void EventTrace::Release(uint32_t time, KeyAddr key_addr) {
+  events_.push_back({time, ReplayEvent::Type::Release, key_addr, 0});
+}
+
+void EventTrace::SetHostLEDs(uint32_t time, uint8_t leds) {
+  events_.push_back({time, ReplayEvent::Type::HostLEDs, KeyAddr{}, leds});
+}
+
+void EventTrace::Suspend(uint32_t time) {
+  events_.push_back({time, ReplayEvent::Type::Suspend, KeyAddr{}, 0});
+}
+
+void EventTrace::Resume(uint32_t time) {
+  events_.push_back({time, ReplayEvent::Type::Resume, KeyAddr{}, 0});
+}
+
+// -----------------------------------------------------------------------------
+// Replay
+
+constexpr int Replay::format_version;
+
+void Replay::Run(const EventTrace &trace, std::ostream &out) {
+  auto &device = Kaleidoscope.device();
+  HIDReportObserver::resetHook(&internal::HIDStateBuilder::ProcessHidReport);
+  device.ledDriver().setSyncHook(&internal::LEDStateBuilder::ProcessLEDFrame);
+
+  for (KeyAddr key_addr : KeyAddr::all())
+    sim_.Release(key_addr);
+  device.mcu().setHostSuspended(false);
+  device.mcu().setHostKeyboardLEDs(0);
+
+  // Let the releases through, and any timers they started run out.
+  runFor(settle_time_);
+
+  // Start on a round number of the virtual clock, so that anything that runs
+  // on a fixed period from power-on, like LED syncs, falls on the same times
+  // in every replay of a trace (as long as the cycle time divides 1024).
+  uint32_t next_cycle = Runtime.millisAtCycleStart() + sim_.CycleTime();
+  if (next_cycle % 1024 != 0)
+    runFor(1024 - next_cycle % 1024);
+  State::Snapshot();
+
+  // Time zero is the start of the next cycle, which sees the events at zero.
+  start_time_ = Runtime.millisAtCycleStart() + sim_.CycleTime();
+  uint32_t first_scan = device.keyScanner().scanCount();
+  last_led_frame_.clear();
+
+  out << "# kaleidoscope replay " << format_version << "\n";
+  for (const ReplayEvent &event : trace.Events()) {
+    runUntil(event.time);
+    apply(event);
+    writeOutput(out);
+  }
+  runUntil(trace.Duration() + settle_time_ + 1);
+  writeOutput(out);
+
+  cycles_ = device.keyScanner().scanCount() - first_scan;
+}
+
+void Replay::runFor(uint32_t millis) {
+  if (fast_forward_) {
+    sim_.FastForward(millis);
+  } else {
+    sim_.RunForMillis(millis);
+  }
+}
+
+// Runs cycles up to, but not including, the first one that starts at or after
+// `time`, so that the next cycle is the one that sees an event at that time.
+// Before the first cycle, `now` is minus one cycle; unsigned arithmetic takes
+// care of that.
+void Replay::runUntil(uint32_t time) {
+  uint32_t now = Runtime.millisAtCycleStart() - start_time_;
+  if (time <= now + sim_.CycleTime())
+    return;
+
+  uint32_t gap = time - now;
+  uint32_t cycles = (gap - 1) / sim_.CycleTime();
+  if (fast_forward_) {
+    sim_.FastForward(cycles * sim_.CycleTime());
+  } else {
+    sim_.RunCycles(cycles);
+  }
+}
+
+void Replay::apply(const ReplayEvent &event) {
+  auto &mcu = Kaleidoscope.device().mcu();
+  switch (event.type) {
+  case ReplayEvent::Type::Press:
+    sim_.Press(event.key_addr);
+    break;
+  case ReplayEvent::Type::Release:
+    sim_.Release(event.key_addr);
+    break;
+  case ReplayEvent::Type::HostLEDs:
+    mcu.setHostKeyboardLEDs(event.leds);
+    break;
+  case ReplayEvent::Type::Suspend:
+    mcu.setHostSuspended(true);
+    break;
+  case ReplayEvent::Type::Resume:
+    mcu.setHostSuspended(false);
+    break;
+  }
+}
+
+namespace {
+
+template <typename Codes>
+std::string hexList(const Codes &codes, int width) {
+  std::ostringstream line;
+  line << std::hex << std::setfill('0');
+  for (auto code : codes)
+    line << " " << std::setw(width) << int(code);
+  return line.str();
+}
+
+}  // namespace
+
+// Writes everything sent to the host since the last call, in the order it
+// was sent, as far as timestamps tell.
+void Replay::writeOutput(std::ostream &out) {
+  auto state = State::Snapshot();
+  const HIDState *hid = state->HIDReports();
+  std::vector<std::pair<uint32_t, std::string>> lines;
+
+  for (const auto &report : hid->Keyboard())
+    lines.emplace_back(report.Timestamp(),
+                       "keyboard" + hexList(report.ActiveKeycodes(), 2));
+  for (const auto &report : hid->ConsumerControl())
+    lines.emplace_back(report.Timestamp(),
+                       "consumer" + hexList(report.ActiveKeycodes(), 4));
+  for (const auto &report : hid->SystemControl()) {
+    std::vector<uint8_t> codes;
+    if (report.ActiveKeycode() != 0)
+      codes.push_back(report.ActiveKeycode());
+    lines.emplace_back(report.Timestamp(), "system" + hexList(codes, 2));
+  }
+  for (const auto &report : hid->Mouse()) {
+    std::ostringstream line;
+    line << "mouse" << hexList(report.Buttons(), 2) << " /"
+         << std::dec << " " << int(report.XAxis()) << " " << int(report.YAxis())
+         << " " << int(report.VWheel()) << " " << int(report.HWheel());
+    lines.emplace_back(report.Timestamp(), line.str());
+  }
+  for (const auto &report : hid->AbsoluteMouse()) {
+    std::ostringstream line;
+    line << "absolute-mouse" << hexList(report.Buttons(), 2) << " /"
+         << std::dec << " " << report.XAxis() << " " << report.YAxis()
+         << " " << int(report.Wheel());
+    lines.emplace_back(report.Timestamp(), line.str());
+  }
+
+  for (const LEDFrame &frame : state->LEDs()->Frames()) {
+    std::vector<uint8_t> bytes;
+    for (uint8_t i = 0; i < LEDFrame::kLEDCount; i++) {
+      const cRGB &color = frame.At(i);
+      bytes.insert(bytes.end(), {color.r, color.g, color.b});
+    }
+    if (bytes == last_led_frame_)
+      continue;
+
+    std::ostringstream line;
+    line << "leds" << std::hex << std::setfill('0');
+    for (size_t i = 0; i < bytes.size(); i++)
+      line << (i % 3 ? "" : " ") << std::setw(2) << int(bytes[i]);
+    lines.emplace_back(frame.Timestamp(), line.str());
+    last_led_frame_ = std::move(bytes);
+  }
+
+  std::stable_sort(lines.begin(), lines.end(),
+                   [](const std::pair<uint32_t, std::string> &a,
+  const std::pair<uint32_t, std::string> &b) {
+    return a.first < b.first;
+  });
+  for (const auto &line : lines)
+    out << line.first - start_time_ << " " << line.second << "\n";
+}
+
+// -----------------------------------------------------------------------------
+
+void ReplayFromEnvironment() {
+  const char *trace_path = std::getenv("KALEIDOSCOPE_REPLAY");
+  if (trace_path == nullptr)
+    return;
+
+  EventTrace trace;
+  if (!trace.ReadFile(trace_path)) {
+    std::cerr << trace_path << ": " << trace.Error() << std::endl;
+    exit(1);
+  }
+
+  SimHarness sim;
+  Replay replay(sim);
+  replay.SetFastForward(std::getenv("KALEIDOSCOPE_REPLAY_FAST_FORWARD") != nullptr);
+
+  const char *output_path = std::getenv("KALEIDOSCOPE_REPLAY_OUTPUT");
+  if (output_path != nullptr) {
+    std::ofstream out(output_path);
+    if (!out) {
+      std::cerr << "Could not write to " << output_path << std::endl;
+      exit(1);
+    }
+    replay.Run(trace, out);
+  } else {
+    replay.Run(trace, std::cout);
+  }
+
+  std::cerr << "Replayed " << trace.Events().size() << " events, "
+            << trace.Duration() << "ms, in " << replay.Cycles() << " cycles"
+            << std::endl;
+  exit(0);
+}
+
+EventTrace RandomTyping(const std::vector<KeyAddr> &keys, uint32_t duration,
+                        uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<ReplayEvent> events;
+  // The time from which each key can be pressed again.
+  std::vector<uint32_t> free_at(KeyAddr::upper_limit, 0);
+
+  for (uint32_t t = 0; t < duration;) {
+    KeyAddr key_addr;
+    do {
+      key_addr = keys[rng() % keys.size()];
+    } while (free_at[key_addr.toInt()] > t);
+
+    uint32_t hold = 20 + rng() % 380;
+    events.push_back({t, ReplayEvent::Type::Press, key_addr, 0});
+    events.push_back({t + hold, ReplayEvent::Type::Release, key_addr, 0});
+    free_at[key_addr.toInt()] = t + hold + 1;
+
+    uint32_t pace = rng() % 20;
+    if (pace == 0) {
+      t += hold + 2000 + rng() % 20000;
+    } else if (pace < 5) {
+      t += hold / 2;
+    } else {
+      t += hold + 20 + rng() % 200;
+    }
+  }
+
+  std::stable_sort(events.begin(), events.end(),
+  [](const ReplayEvent & a, const ReplayEvent & b) {
+    return a.time < b.time;
+  });
+
+  EventTrace trace;
+  for (const ReplayEvent &event : events) {
+    if (event.type == ReplayEvent::Type::Press) {
+      trace.Press(event.time, event.key_addr);
+    } else {
+      trace.Release(event.time, event.key_addr);
+    }
+  }
+  return trace;
+}
+
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,186 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "testing/SimHarness.h"
+
+// Out of order due to macro conflicts.
+#include "testing/fix-macros.h"
+
+namespace kaleidoscope {
+namespace testing {
+
+// Something that happened at the inputs of a keyboard, at a time in
+// milliseconds from the start of the recording.
+struct ReplayEvent {
+  enum class Type : uint8_t {
+    Press,
+    Release,
+    HostLEDs,
+    Suspend,
+    Resume,
+  };
+
+  uint32_t time;
+  Type type;
+  // The keyswitch that was pressed or released.
+  KeyAddr key_addr;
+  // The keyboard LEDs the host turned on.
+  uint8_t leds;
+
+  bool operator==(const ReplayEvent &other) const;
+};
+
+// A recording of the input to a keyboard, in order, to be played back by a
+// `Replay`. It can be read from and written to either of two formats.
+//
+// The text format has one event per line, with `#` starting a comment:
+//
+//   # time  event    row col
+//   0       press    2   1
+//   85      release  2   1
+//   1200    leds     2
+//   60000   suspend
+//   61000   resume
+//
+// The binary format, for long recordings, is the four bytes `KTR\x01`,
+// followed by eight bytes per event: its time as a little-endian 32-bit
+// integer, then its type (in the order of `ReplayEvent::Type`), row, column
+// and LEDs, a byte each.
+class EventTrace {
+ public:
+  // Reads a trace in either format, replacing the events already in this one.
+  // Returns false, and sets `Error()`, if it is malformed or out of order.
+  bool Read(std::istream &in);
+  bool ReadFile(const std::string &path);
+  const std::string &Error() const {
+    return error_;
+  }
+
+  void WriteText(std::ostream &out) const;
+  void WriteBinary(std::ostream &out) const;
+
+  // Add an event at the end of the trace; it's up to the caller to keep them
+  // in order.
+  void Press(uint32_t time, KeyAddr key_addr);
+  void Release(uint32_t time, KeyAddr key_addr);
+  void SetHostLEDs(uint32_t time, uint8_t leds);
+  void Suspend(uint32_t time);
+  void Resume(uint32_t time);
+
+  const std::vector<ReplayEvent> &Events() const {
+    return events_;
+  }
+  // The time of the last event.
+  uint32_t Duration() const {
+    return events_.empty() ? 0 : events_.back().time;
+  }
+
+ private:
+  std::vector<ReplayEvent> events_;
+  std::string error_;
+
+  bool readText(std::istream &in);
+  bool readBinary(std::istream &in);
+  bool add(const ReplayEvent &event, size_t position);
+};
+
+// Plays an `EventTrace` back on the virtual device, at the times it was
+// recorded, and writes every HID report and LED frame that comes out to a
+// stream, one per line, timed from the first cycle of the replay:
+//
+//   # kaleidoscope replay 1
+//   0 keyboard 04
+//   85 keyboard
+//   96 leds 0000a0 0000a0 ...
+//
+// Keyboard, consumer control and system control reports list their keycodes
+// in hex; mouse reports list their buttons and axes. An LED frame is only
+// written when it differs from the one before it. Two replays of the same
+// trace can be compared with `testing/bin/diff-replays`.
+//
+// Replays expect every cycle to take the same whole number of milliseconds,
+// which they do unless the `SimHarness` has a cost model with operation costs.
+//
+// By default, the replay runs every cycle. `SetFastForward(true)` skips the
+// stretches in which nothing happens (see `SimHarness::FastForward()`), so
+// hours of recorded typing take seconds to play. That is only exact for
+// plugins that declare their timers with `Runtime.declareDeadline()`.
+class Replay {
+ public:
+  static constexpr int format_version = 1;
+
+  explicit Replay(SimHarness &sim) : sim_(sim) {}
+
+  void SetFastForward(bool fast_forward) {
+    fast_forward_ = fast_forward;
+  }
+  // How long to keep running after the last event, so that any timers it
+  // started can expire. The default is one second.
+  void SetSettleTime(uint32_t millis) {
+    settle_time_ = millis;
+  }
+
+  // Plays `trace`, starting with the next cycle, with every key released and
+  // the host awake with its LEDs off.
+  void Run(const EventTrace &trace, std::ostream &out);
+
+  // The number of cycles the last `Run()` took.
+  size_t Cycles() const {
+    return cycles_;
+  }
+
+ private:
+  SimHarness &sim_;
+  bool fast_forward_ = false;
+  uint32_t settle_time_ = 1000;
+
+  uint32_t start_time_ = 0;
+  size_t cycles_ = 0;
+  std::vector<uint8_t> last_led_frame_;
+
+  void runFor(uint32_t millis);
+  void runUntil(uint32_t time);
+  void apply(const ReplayEvent &event);
+  void writeOutput(std::ostream &out);
+};
+
+// When the `KALEIDOSCOPE_REPLAY` environment variable names a trace file,
+// replays it against the sketch instead of running its tests, and exits. The
+// output goes to the file named by `KALEIDOSCOPE_REPLAY_OUTPUT`, or to the
+// standard output. Setting `KALEIDOSCOPE_REPLAY_FAST_FORWARD` turns on
+// fast-forwarding. Called by `SETUP_GOOGLETEST()`, so that the binary of any
+// testcase can replay traces.
+void ReplayFromEnvironment();
+
+// Someone typing on `keys` for `duration` milliseconds: mostly separate
+// keystrokes, some of them rolling over into the next, held long enough to
+// make a qukey or SpaceCadet key take on its alternate value now and then,
+// with a longer pause every so often. The same `seed` always gives the same
+// trace.
+EventTrace RandomTyping(const std::vector<KeyAddr> &keys, uint32_t duration,
+                        uint32_t seed);
+
+}  // namespace testing
+}  // namespace kaleidoscope
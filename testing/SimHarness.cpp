@@ -23,15 +23,22 @@ namespace kaleidoscope {
 namespace testing {
 
 void SimHarness::RunCycle() {
-  if (CycleTime() > 1) {
-    // We incrememnt the time before running the loop so that
-    // millisAtCycleStart ends up where we want it to
-    for (size_t i = 1; i < CycleTime() ; i++) {
-      // The current millis implementation gets us 1 milli per call to millis.
-      millis();
-    }
+  auto &clock = Kaleidoscope.device().mcu().clock();
+  // The fixed part goes first, so that `millisAtCycleStart()` ends up where we
+  // want it to.
+  clock.advance(cost_model_.cycle_micros);
+
+  if (cost_model_.operation_costs == nullptr) {
+    Kaleidoscope.loop();
+    return;
   }
+
+  auto before = OperationCounts::Current();
   Kaleidoscope.loop();
+  uint64_t nanos = leftover_nanos_ +
+                   cost_model_.operation_costs->Cost(OperationCounts::Current() - before);
+  clock.advance(nanos / 1000);
+  leftover_nanos_ = nanos % 1000;
 }
 
 void SimHarness::RunCycles(size_t n) {
@@ -45,6 +52,43 @@ void SimHarness::RunForMillis(size_t t) {
   }
 }
 
+void SimHarness::FastForward(size_t t) {
+  // Skipping cycles takes them all to be the same whole number of
+  // milliseconds.
+  if (cost_model_.operation_costs != nullptr || CycleTime() == 0 ||
+      cost_model_.cycle_micros != CycleTime() * 1000u) {
+    RunForMillis(t);
+    return;
+  }
+
+  auto start_time = Kaleidoscope.millisAtCycleStart();
+  // `RunForMillis()` would run its last cycle at the first multiple of the
+  // cycle time that is at least `t`.
+  uint64_t last_cycle = (t + CycleTime() - 1) / CycleTime() * CycleTime();
+
+  while (Kaleidoscope.millisAtCycleStart() - start_time < t) {
+    RunCycle();
+
+    uint64_t now = Kaleidoscope.millisAtCycleStart() - start_time;
+    if (now >= t)
+      break;
+
+    // The first cycle at or after the deadline has to run, as does the last
+    // one; everything before the earlier of the two can be skipped.
+    uint64_t until_deadline = Runtime.millisUntilDeadline();
+    uint64_t cycles_to_deadline = (until_deadline + CycleTime() - 1) / CycleTime();
+    if (cycles_to_deadline == 0)
+      cycles_to_deadline = 1;
+    uint64_t next_cycle = now + cycles_to_deadline * CycleTime();
+    if (next_cycle > last_cycle)
+      next_cycle = last_cycle;
+
+    uint64_t skip = next_cycle - now - CycleTime();
+    if (skip > 0)
+      Kaleidoscope.device().mcu().clock().advance(skip * 1000);
+  }
+}
+
 void SimHarness::Press(KeyAddr key_addr) {
   Kaleidoscope.device().keyScanner().setKeystate(
     key_addr,
@@ -66,11 +110,20 @@ void SimHarness::Release(uint8_t row, uint8_t col) {
 }
 
 void SimHarness::SetCycleTime(uint8_t millis) {
-  millis_per_cycle_ = millis;
+  cost_model_.cycle_micros = uint32_t(millis) * 1000;
 }
 
 uint8_t SimHarness::CycleTime() const {
-  return millis_per_cycle_;
+  return cost_model_.cycle_micros / 1000;
+}
+
+void SimHarness::SetCostModel(const CycleCostModel &model) {
+  cost_model_ = model;
+  leftover_nanos_ = 0;
+}
+
+const CycleCostModel &SimHarness::CostModel() const {
+  return cost_model_;
 }
 
 
@@ -20,25 +20,50 @@
 #include <cstdint>
 
 #include "Kaleidoscope.h"
+#include "testing/Cost.h"
 #include "testing/fix-macros.h"
 
 namespace kaleidoscope {
 namespace testing {
 
+// How much time the simulator lets pass for each cycle: a fixed amount, plus,
+// given a `CostTable`, what the costly operations the cycle did would take on
+// that target. The fixed part passes before the cycle starts, the rest after it
+// ends; the first cycle starts at the end of the fixed part. The time plugins
+// take to read the clock doesn't count, so reading it changes nothing.
+struct CycleCostModel {
+  uint32_t cycle_micros = 1000;
+  const CostTable *operation_costs = nullptr;
+};
+
 class SimHarness {
  public:
   void RunCycle();
   void RunCycles(size_t n);
   void RunForMillis(size_t t);
+  // Like `RunForMillis()`, but skips the cycles in which nothing would happen.
+  // After the first cycle, which handles any key changes, it skips ahead to
+  // the earliest deadline declared with `Runtime.declareDeadline()`, or to the
+  // last cycle if there is none. The cycles that do run start at the same
+  // times as they would with `RunForMillis()`. That takes every cycle to be as
+  // long as the last; if the cost model can't promise that, or the cycle time
+  // isn't a whole number of milliseconds, it runs every cycle instead.
+  void FastForward(size_t t);
   void Press(KeyAddr key_addr);
   void Release(KeyAddr key_addr);
   void Press(uint8_t row, uint8_t col);
   void Release(uint8_t row, uint8_t col);
+  // Sets the fixed part of the cost model, and returns it, in milliseconds.
   void SetCycleTime(uint8_t millis);
   uint8_t CycleTime() const;
+  void SetCostModel(const CycleCostModel &model);
+  const CycleCostModel &CostModel() const;
 
  private:
-  uint8_t millis_per_cycle_ = 1;
+  CycleCostModel cost_model_;
+  // What's left of the operation costs, after advancing the clock by whole
+  // microseconds.
+  uint32_t leftover_nanos_ = 0;
 };
 
 }  // namespace testing
@@ -23,6 +23,7 @@ namespace testing {
 std::unique_ptr<State> State::Snapshot() {
   auto state = std::make_unique<State>();
   state->hid_state_ = internal::HIDStateBuilder::Snapshot();
+  state->led_state_ = internal::LEDStateBuilder::Snapshot();
   return state;
 }
 
@@ -30,5 +31,9 @@ const HIDState* State::HIDReports() const {
   return hid_state_.get();
 }
 
+const LEDState* State::LEDs() const {
+  return led_state_.get();
+}
+
 }  // namespace testing
 }  // namespace kaleidoscope
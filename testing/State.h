@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "testing/HIDState.h"
+#include "testing/LEDState.h"
 
 // Out of order due to macro conflicts.
 #include "testing/fix-macros.h"
@@ -34,9 +35,11 @@ class State {
   static std::unique_ptr<State> Snapshot();
 
   const HIDState* HIDReports() const;
+  const LEDState* LEDs() const;
 
  private:
   std::unique_ptr<HIDState> hid_state_;
+  std::unique_ptr<LEDState> led_state_;
 };
 
 }  // namespace testing
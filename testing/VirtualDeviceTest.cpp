@@ -18,12 +18,14 @@
 
 #include "HIDReportObserver.h"
 #include "testing/HIDState.h"
+#include "testing/LEDState.h"
 
 namespace kaleidoscope {
 namespace testing {
 
 void VirtualDeviceTest::SetUp() {
   HIDReportObserver::resetHook(&internal::HIDStateBuilder::ProcessHidReport);
+  Runtime.device().ledDriver().setSyncHook(&internal::LEDStateBuilder::ProcessLEDFrame);
 }
 
 std::unique_ptr<State> VirtualDeviceTest::RunCycle() {
@@ -47,6 +49,11 @@ const HIDState* VirtualDeviceTest::HIDReports() const {
   return output_state_->HIDReports();
 }
 
+const LEDState* VirtualDeviceTest::LEDs() const {
+  if (output_state_ == nullptr) return nullptr;
+  return output_state_->LEDs();
+}
+
 uint32_t VirtualDeviceTest::ReportTimestamp(size_t index) const {
   uint32_t t = output_state_->HIDReports()->Keyboard(index).Timestamp();
   return t;
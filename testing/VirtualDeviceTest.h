@@ -79,6 +79,9 @@ class VirtualDeviceTest : public ::testing::Test {
   // Get a pointer to the current list of observed HID reports
   const HIDState* HIDReports() const;
 
+  // Get a pointer to the LED state loaded by the last call to `LoadState()`
+  const LEDState* LEDs() const;
+
   // Get the timestamp of a logged Keyboard HID report
   uint32_t ReportTimestamp(size_t index) const;
 
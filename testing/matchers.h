@@ -17,6 +17,8 @@
 #pragma once
 
 #include "kaleidoscope/key_defs.h"
+#include "kaleidoscope/Runtime.h"
+#include "testing/Cost.h"
 #include "testing/SystemControlReport.h"
 
 // Out of order because `fix-macros.h` clears the preprocessor environment for
@@ -24,6 +26,11 @@
 #include "testing/fix-macros.h"
 #include "gmock/gmock.h"
 
+inline void PrintTo(const cRGB& color, std::ostream* os) {
+  *os << "CRGB(" << unsigned(color.r) << ", " << unsigned(color.g) << ", "
+      << unsigned(color.b) << ")";
+}
+
 namespace kaleidoscope {
 namespace testing {
 
@@ -35,5 +42,49 @@ auto Contains(Key key) {
   return ::testing::Contains(key.getKeyCode());
 }
 
+MATCHER_P(IsColor, color,
+          std::string(negation ? "is not " : "is ") +
+          ::testing::PrintToString(color)) {
+  return arg.r == color.r && arg.g == color.g && arg.b == color.b;
+}
+
+// Check the `OperationCounts` of a workload:
+//
+//   EXPECT_THAT(OperationCounts::Current() - before, StorageReadsAtMost(1))
+//     << "A layer change reads at most one byte of storage";
+MATCHER_P(StorageReadsAtMost, n,
+          std::string(negation ? "makes more than " : "makes at most ") +
+          ::testing::PrintToString(n) + " storage reads") {
+  return arg.storage_reads <= uint32_t(n);
+}
+
+MATCHER_P(StorageCommitsAtMost, n,
+          std::string(negation ? "makes more than " : "makes at most ") +
+          ::testing::PrintToString(n) + " storage commits") {
+  return arg.storage_commits <= uint32_t(n);
+}
+
+MATCHER_P(HIDReportsAtMost, n,
+          std::string(negation ? "sends more than " : "sends at most ") +
+          ::testing::PrintToString(n) + " HID reports") {
+  return arg.hid_reports <= uint32_t(n);
+}
+
+// Weighs every operation by its cost on a target, from a `CostTable`.
+MATCHER_P2(CostsAtMost, cost_table, nsec,
+           std::string(negation ? "costs more than " : "costs at most ") +
+           ::testing::PrintToString(nsec) + "ns on " + cost_table.name) {
+  uint64_t cost = cost_table.Cost(arg);
+  *result_listener << "which costs " << cost << "ns";
+  return cost <= uint64_t(nsec);
+}
+
 }  // namespace testing
 }  // namespace kaleidoscope
+
+// Check the color currently in the LED buffer for the key at `key_addr`:
+//
+//   EXPECT_LED(KeyAddr(2, 1), CRGB(160, 160, 160)) << "`A` is highlighted";
+#define EXPECT_LED(key_addr, color)                                      \
+  EXPECT_THAT(Runtime.device().getCrgbAt(KeyAddr(key_addr)),             \
+              ::kaleidoscope::testing::IsColor(color))
@@ -28,6 +28,7 @@
 #include "gtest/gtest.h"
 
 #include "testing/matchers.h"
+#include "testing/Replay.h"
 #include "testing/VirtualDeviceTest.h"
 
 #define SETUP_GOOGLETEST()                                              \
@@ -35,6 +36,7 @@
     setup(); /* setup Kaleidoscope */                                   \
     /* Turn off virtual_io's input. */                                  \
     Kaleidoscope.device().keyScanner().setEnableReadMatrix(false);      \
+    kaleidoscope::testing::ReplayFromEnvironment();                     \
     testing::InitGoogleTest();                                          \
     int result = RUN_ALL_TESTS();                                       \
     exit(result);                                                       \
@@ -0,0 +1,44 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/setup-googletest.h"
+#include "testing/Benchmark.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr size_t benchmark_cycles = 20000;
+
+class Idle : public VirtualDeviceTest {};
+
+TEST_F(Idle, Cycles) {
+  Benchmark benchmark(sim_);
+
+  benchmark.Start();
+  benchmark.RunCycles(benchmark_cycles);
+  benchmark.Finish();
+
+  EXPECT_EQ(benchmark.Cycles(), benchmark_cycles);
+  EXPECT_EQ(benchmark.KeyboardReports(), 0)
+      << "An idle keyboard sends no reports";
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
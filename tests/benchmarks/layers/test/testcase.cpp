@@ -0,0 +1,87 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/setup-googletest.h"
+#include "testing/Benchmark.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_ShiftToLayer1{3, 6};
+constexpr KeyAddr key_addr_ShiftToLayer2{3, 9};
+constexpr KeyAddr key_addr_LockLayer3{0, 0};
+
+// The home row keys, which are different on every layer.
+constexpr KeyAddr home_row[] = {
+  {2, 1}, {2, 2}, {2, 3}, {2, 4}, {2, 5},
+  {2, 10}, {2, 11}, {2, 12}, {2, 13}, {2, 14},
+};
+
+constexpr size_t benchmark_rounds = 100;
+
+class Layers : public VirtualDeviceTest {
+ protected:
+  void Tap(Benchmark &benchmark, KeyAddr key_addr) {
+    benchmark.Press(key_addr);
+    benchmark.RunCycles(5);
+    benchmark.Release(key_addr);
+    benchmark.RunCycles(5);
+  }
+
+  void TapHomeRow(Benchmark &benchmark) {
+    for (KeyAddr key_addr : home_row)
+      Tap(benchmark, key_addr);
+  }
+};
+
+// Switches layers as often as the home row is typed on: shifting to one layer,
+// stacking a second one on top of it, and locking a third one.
+TEST_F(Layers, Thrash) {
+  Benchmark benchmark(sim_);
+
+  benchmark.Start();
+  for (size_t round = 0; round < benchmark_rounds; round++) {
+    TapHomeRow(benchmark);
+
+    benchmark.Press(key_addr_ShiftToLayer1);
+    benchmark.RunCycles(5);
+    TapHomeRow(benchmark);
+
+    benchmark.Press(key_addr_ShiftToLayer2);
+    benchmark.RunCycles(5);
+    TapHomeRow(benchmark);
+
+    benchmark.Release(key_addr_ShiftToLayer1);
+    benchmark.Release(key_addr_ShiftToLayer2);
+    benchmark.RunCycles(5);
+
+    Tap(benchmark, key_addr_LockLayer3);
+    TapHomeRow(benchmark);
+    Tap(benchmark, key_addr_LockLayer3);
+  }
+  benchmark.Finish();
+
+  EXPECT_EQ(Layer.mostRecent(), 0)
+      << "Every layer is turned off again at the end of each round";
+  EXPECT_GT(benchmark.KeyboardReports(), benchmark_rounds * 4 * 10);
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
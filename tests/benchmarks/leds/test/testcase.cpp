@@ -0,0 +1,58 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/setup-googletest.h"
+#include "testing/Benchmark.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_LeftShift{3, 7};
+constexpr KeyAddr key_addr_A{2, 1};
+
+constexpr size_t benchmark_rounds = 500;
+
+class LEDs : public VirtualDeviceTest {};
+
+// Runs an animated effect that recomputes every LED on every cycle, with a
+// modifier held half of the time, so that the active modifier highlight is
+// painted over it as well.
+TEST_F(LEDs, RainbowWithActiveModifiers) {
+  Benchmark benchmark(sim_);
+
+  benchmark.Start();
+  for (size_t round = 0; round < benchmark_rounds; round++) {
+    benchmark.Press(key_addr_LeftShift);
+    benchmark.RunCycles(10);
+    benchmark.Press(key_addr_A);
+    benchmark.RunCycles(10);
+    benchmark.Release(key_addr_A);
+    benchmark.Release(key_addr_LeftShift);
+    benchmark.RunCycles(20);
+  }
+  benchmark.Finish();
+
+  EXPECT_GT(benchmark.LEDFrames(), benchmark_rounds)
+      << "The LEDs are synced many times per round";
+  EXPECT_EQ(benchmark.KeyboardReports(), benchmark.Events());
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,83 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/setup-googletest.h"
+#include "testing/Benchmark.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr size_t benchmark_rounds = 200;
+
+// The letter keys of the home row and the row above it, on both halves.
+constexpr KeyAddr rollover_keys[] = {
+  {1, 1}, {1, 2}, {1, 3}, {1, 4}, {1, 5},
+  {2, 1}, {2, 2}, {2, 3}, {2, 4}, {2, 5},
+  {1, 10}, {1, 11}, {1, 12}, {1, 13}, {1, 14},
+  {2, 10}, {2, 11}, {2, 12}, {2, 13},
+};
+constexpr size_t rollover_key_count = sizeof(rollover_keys) / sizeof(rollover_keys[0]);
+
+class Rollover : public VirtualDeviceTest {};
+
+// Presses the keys one per cycle, holds them all, then lets go of them in the
+// same cycle.
+TEST_F(Rollover, StaggeredPressesSimultaneousRelease) {
+  Benchmark benchmark(sim_);
+
+  benchmark.Start();
+  for (size_t round = 0; round < benchmark_rounds; round++) {
+    for (KeyAddr key_addr : rollover_keys) {
+      benchmark.Press(key_addr);
+      benchmark.RunCycle();
+    }
+    benchmark.RunCycles(10);
+    for (KeyAddr key_addr : rollover_keys)
+      benchmark.Release(key_addr);
+    benchmark.RunCycles(10);
+  }
+  benchmark.Finish();
+
+  EXPECT_EQ(benchmark.Events(), benchmark_rounds * rollover_key_count * 2);
+  EXPECT_EQ(benchmark.KeyboardReports(), benchmark.Events())
+      << "Every press and every release is reported";
+}
+
+// Presses and releases every key at once, the worst case for a single cycle.
+TEST_F(Rollover, Storm) {
+  Benchmark benchmark(sim_);
+
+  benchmark.Start();
+  for (size_t round = 0; round < benchmark_rounds; round++) {
+    for (KeyAddr key_addr : KeyAddr::all())
+      benchmark.Press(key_addr);
+    benchmark.RunCycles(10);
+    for (KeyAddr key_addr : KeyAddr::all())
+      benchmark.Release(key_addr);
+    benchmark.RunCycles(10);
+  }
+  benchmark.Finish();
+
+  EXPECT_EQ(benchmark.Events(), benchmark_rounds * KeyAddr::upper_limit * 2);
+  EXPECT_GT(benchmark.KeyboardReports(), 0);
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,76 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "testing/setup-googletest.h"
+#include "testing/Benchmark.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr char text[] = "the quick brown fox jumps over the lazy dog ";
+constexpr size_t benchmark_rounds = 50;
+
+// The address of each lowercase letter in the sketch's keymap.
+constexpr KeyAddr letters[] = {
+  {2, 1}, {3, 5}, {3, 3}, {2, 3}, {1, 3}, {2, 4}, {2, 5},   // a - g
+  {2, 10}, {1, 12}, {2, 11}, {2, 12}, {2, 13}, {3, 11},     // h - m
+  {3, 10}, {1, 13}, {1, 14}, {1, 1}, {1, 4}, {2, 2},        // n - s
+  {1, 5}, {1, 11}, {3, 4}, {1, 2}, {3, 2}, {1, 10}, {3, 1}, // t - z
+};
+constexpr KeyAddr key_addr_Spacebar{1, 8};
+
+KeyAddr addrOf(char c) {
+  if (c == ' ')
+    return key_addr_Spacebar;
+  return letters[c - 'a'];
+}
+
+class Typing : public VirtualDeviceTest {};
+
+// Types the text at a brisk pace, with the next key pressed before the
+// previous one is released, the way most people type.
+TEST_F(Typing, RollingText) {
+  Benchmark benchmark(sim_);
+  const size_t length = strlen(text);
+
+  benchmark.Start();
+  for (size_t round = 0; round < benchmark_rounds; round++) {
+    for (size_t i = 0; i < length; i++) {
+      benchmark.Press(addrOf(text[i]));
+      benchmark.RunCycles(20);
+      if (i > 0) {
+        benchmark.Release(addrOf(text[i - 1]));
+        benchmark.RunCycles(20);
+      }
+    }
+    benchmark.Release(addrOf(text[length - 1]));
+    benchmark.RunCycles(20);
+  }
+  benchmark.Finish();
+
+  EXPECT_EQ(benchmark.Events(), benchmark_rounds * length * 2);
+  EXPECT_EQ(benchmark.KeyboardReports(), benchmark.Events())
+      << "Every press and every release is reported";
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,86 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/setup-googletest.h"
+
+#include <Kaleidoscope-LEDControl.h>
+#include "kaleidoscope/driver/led/ColorCorrection.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+// The brightness adjustment and gamma correction the hardware drivers used to
+// perform for every byte they transmitted.
+uint8_t perByteCorrection(uint8_t c, uint8_t brightness) {
+  uint8_t brightness_adjustment = 255 - brightness;
+
+  if (c > brightness_adjustment)
+    c -= brightness_adjustment;
+  else
+    c = 0;
+
+  return pgm_read_byte(&driver::color::gamma_correction[c]);
+}
+
+class ColorCorrection : public VirtualDeviceTest {};
+
+TEST_F(ColorCorrection, MatchesPerByteMath) {
+  driver::led::ColorCorrection color_correction;
+
+  for (uint16_t brightness = 0; brightness < 256; brightness++) {
+    color_correction.setBrightness(brightness);
+    ASSERT_EQ(color_correction.getBrightness(), brightness);
+
+    for (uint16_t c = 0; c < 256; c++) {
+      ASSERT_EQ(color_correction.apply(c), perByteCorrection(c, brightness))
+          << "Component " << c << " at brightness " << brightness;
+    }
+  }
+}
+
+TEST_F(ColorCorrection, DefaultsToFullBrightness) {
+  driver::led::ColorCorrection color_correction;
+
+  EXPECT_EQ(color_correction.getBrightness(), 255);
+  for (uint16_t c = 0; c < 256; c++) {
+    ASSERT_EQ(color_correction.apply(c), perByteCorrection(c, 255))
+        << "Component " << c;
+  }
+}
+
+TEST_F(ColorCorrection, BrightnessThroughLEDControl) {
+  ::LEDControl.setBrightness(100);
+  EXPECT_EQ(::LEDControl.getBrightness(), 100);
+
+  ::LEDControl.setCrgbAt(uint8_t(0), CRGB(200, 100, 50));
+
+  cRGB color = Runtime.device().ledDriver().getCorrectedCrgbAt(0);
+  EXPECT_EQ(color.r, perByteCorrection(200, 100));
+  EXPECT_EQ(color.g, perByteCorrection(100, 100));
+  EXPECT_EQ(color.b, perByteCorrection(50, 100));
+
+  cRGB raw = ::LEDControl.getCrgbAt(uint8_t(0));
+  EXPECT_EQ(raw.r, 200) << "Brightness does not affect the stored colors";
+
+  ::LEDControl.setBrightness(255);
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
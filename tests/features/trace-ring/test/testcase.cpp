@@ -0,0 +1,251 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "kaleidoscope/TraceRing.h"
+#include "Kaleidoscope-FlightRecorder.h"
+
+#include "testing/setup-googletest.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_A{2, 1};
+constexpr KeyAddr key_addr_X{3, 2};
+
+// The index of `SwallowX` in the sketch's `KALEIDOSCOPE_INIT_PLUGINS()`.
+constexpr uint8_t swallow_x_index = 2;
+
+// One entry of the `trace.dump` output, in the order `bin/decode-trace` reads
+// the fields.
+struct DumpedEntry {
+  unsigned timestamp, event;
+  int id;
+  unsigned addr, state, key, handler, result;
+};
+
+// The `trace.dump` output, parsed the way `bin/decode-trace` does: a header of
+// the format version, the number of entries and the current time, then one
+// line of eight fields per entry.
+struct Dump {
+  unsigned version = 0, count = 0, now = 0;
+  std::vector<DumpedEntry> entries;
+  bool malformed = false;
+
+  explicit Dump(const std::string &output) {
+    std::istringstream lines(output);
+    std::string line;
+    bool header = false;
+    while (std::getline(lines, line)) {
+      std::istringstream fields(line);
+      std::vector<std::string> values;
+      std::string value;
+      while (fields >> value)
+        values.push_back(value);
+      if (values.empty() || values[0] == ".")
+        continue;
+
+      if (!header) {
+        header = true;
+        std::istringstream(line) >> version >> count >> now;
+        continue;
+      }
+      if (values.size() != 8) {
+        malformed = true;
+        continue;
+      }
+      DumpedEntry entry;
+      std::istringstream(line) >> entry.timestamp >> entry.event >> entry.id >>
+                               entry.addr >> entry.state >> entry.key >>
+                               entry.handler >> entry.result;
+      entries.push_back(entry);
+    }
+  }
+};
+
+class TraceRingTest : public VirtualDeviceTest {
+ protected:
+  void SetUp() override {
+    VirtualDeviceTest::SetUp();
+    trace_ring.clear();
+  }
+
+  // Checks one entry of the trace against what the simulator was told to do.
+  void ExpectEntry(uint16_t index, TraceEvent event, KeyAddr addr,
+                   uint8_t state, Key key, uint16_t timestamp,
+                   uint8_t handler = TraceRing::no_handler,
+                   EventHandlerResult result = EventHandlerResult::OK) {
+    ASSERT_LT(index, trace_ring.count());
+    const TraceEntry &entry = trace_ring.entry(index);
+    EXPECT_EQ(entry.event, event) << "Entry " << index;
+    EXPECT_EQ(entry.addr, addr.toInt()) << "Entry " << index;
+    EXPECT_EQ(entry.state, state) << "Entry " << index;
+    EXPECT_EQ(entry.key, key.getRaw()) << "Entry " << index;
+    EXPECT_EQ(entry.timestamp, timestamp) << "Entry " << index;
+    EXPECT_EQ(entry.handler, handler) << "Entry " << index;
+    EXPECT_EQ(entry.result, result) << "Entry " << index;
+  }
+
+  // What the `trace.dump` Focus command sends.
+  Dump TraceDump() {
+    fflush(stdout);
+    ::testing::internal::CaptureStdout();
+    ::FlightRecorder.onFocusEvent("trace.dump");
+    fflush(stdout);
+    return Dump(::testing::internal::GetCapturedStdout());
+  }
+};
+
+TEST_F(TraceRingTest, RecordsPressAndRelease) {
+  sim_.Press(key_addr_A);
+  RunCycle();
+  uint16_t press_time = Runtime.millisAtCycleStart();
+  sim_.RunForMillis(20);
+  sim_.Release(key_addr_A);
+  RunCycle();
+  uint16_t release_time = Runtime.millisAtCycleStart();
+
+  ASSERT_EQ(trace_ring.count(), 6);
+  ExpectEntry(0, TraceEvent::KeyswitchEvent, key_addr_A, IS_PRESSED, Key_A, press_time);
+  ExpectEntry(1, TraceEvent::KeyEvent, key_addr_A, IS_PRESSED, Key_A, press_time);
+  ExpectEntry(2, TraceEvent::KeyboardReport, key_addr_A, IS_PRESSED, Key_A, press_time);
+  ExpectEntry(3, TraceEvent::KeyswitchEvent, key_addr_A, WAS_PRESSED, Key_A, release_time);
+  ExpectEntry(4, TraceEvent::KeyEvent, key_addr_A, WAS_PRESSED, Key_A, release_time);
+  ExpectEntry(5, TraceEvent::KeyboardReport, key_addr_A, WAS_PRESSED, Key_A, release_time);
+
+  EXPECT_EQ(trace_ring.entry(0).id, trace_ring.entry(2).id)
+      << "All entries for an event have its id";
+  EXPECT_NE(trace_ring.entry(0).id, trace_ring.entry(3).id)
+      << "The release is a new event";
+}
+
+TEST_F(TraceRingTest, RecordsWhichPluginStoppedAnEvent) {
+  sim_.Press(key_addr_X);
+  RunCycle();
+  uint16_t press_time = Runtime.millisAtCycleStart();
+
+  ASSERT_EQ(trace_ring.count(), 2) << "No report is sent for a swallowed key";
+  ExpectEntry(0, TraceEvent::KeyswitchEvent, key_addr_X, IS_PRESSED, Key_X, press_time);
+  ExpectEntry(1, TraceEvent::KeyEvent, key_addr_X, IS_PRESSED, Key_X, press_time,
+              swallow_x_index, EventHandlerResult::EVENT_CONSUMED);
+
+  sim_.Release(key_addr_X);
+  RunCycle();
+}
+
+TEST_F(TraceRingTest, KeepsTheLatestEntries) {
+  constexpr uint16_t taps = TraceRing::size;
+  for (uint16_t i = 0; i < taps; i++) {
+    sim_.Press(key_addr_A);
+    RunCycle();
+    sim_.Release(key_addr_A);
+    RunCycle();
+  }
+  uint16_t release_time = Runtime.millisAtCycleStart();
+
+  ASSERT_EQ(trace_ring.count(), TraceRing::size) << "The ring is full";
+
+  // Each tap leaves six entries, of which the oldest ones got overwritten.
+  constexpr TraceEvent events[] = {TraceEvent::KeyswitchEvent,
+                                   TraceEvent::KeyEvent,
+                                   TraceEvent::KeyboardReport
+                                  };
+  constexpr uint16_t dropped = taps * 6 - TraceRing::size;
+  for (uint16_t i = 0; i < trace_ring.count(); i++) {
+    uint16_t step = (dropped + i) % 6;
+    ExpectEntry(i, events[step % 3], key_addr_A,
+                step < 3 ? IS_PRESSED : WAS_PRESSED, Key_A,
+                trace_ring.entry(i).timestamp);
+    if (i > 0) {
+      EXPECT_LE(trace_ring.entry(i - 1).timestamp, trace_ring.entry(i).timestamp)
+          << "Entries are in order, oldest first";
+    }
+  }
+  EXPECT_EQ(trace_ring.entry(TraceRing::size - 1).timestamp, release_time);
+
+  trace_ring.clear();
+  EXPECT_EQ(trace_ring.count(), 0);
+}
+
+TEST_F(TraceRingTest, DumpsEntriesOverFocus) {
+  sim_.Press(key_addr_A);
+  RunCycle();
+  uint16_t press_time = Runtime.millisAtCycleStart();
+  sim_.Release(key_addr_A);
+  RunCycle();
+  sim_.Press(key_addr_X);
+  RunCycle();
+  uint16_t swallow_time = Runtime.millisAtCycleStart();
+  sim_.Release(key_addr_X);
+  RunCycle();
+
+  // An injected key has no address.
+  sim_.RunCycle();
+  uint16_t injected_time = Runtime.millisAtCycleStart();
+  Runtime.handleKeyEvent(KeyEvent(KeyAddr::none(), IS_PRESSED | INJECTED, Key_B));
+  Runtime.handleKeyEvent(KeyEvent(KeyAddr::none(), WAS_PRESSED | INJECTED, Key_B));
+
+  Dump dump = TraceDump();
+  EXPECT_FALSE(dump.malformed) << "Every entry has eight fields";
+  EXPECT_EQ(dump.version, TraceRing::format_version);
+  EXPECT_EQ(dump.count, trace_ring.count());
+  EXPECT_EQ(dump.now, injected_time);
+  ASSERT_EQ(dump.entries.size(), trace_ring.count());
+
+  // The press of `A`, in the order of the fields.
+  const DumpedEntry &press = dump.entries[0];
+  EXPECT_EQ(press.timestamp, press_time);
+  EXPECT_EQ(press.event, unsigned(TraceEvent::KeyswitchEvent));
+  EXPECT_EQ(press.id, int(trace_ring.entry(0).id));
+  EXPECT_EQ(press.addr, key_addr_A.toInt());
+  EXPECT_EQ(press.state, unsigned(IS_PRESSED));
+  EXPECT_EQ(press.key, Key_A.getRaw());
+  EXPECT_EQ(press.handler, TraceRing::no_handler);
+  EXPECT_EQ(press.result, unsigned(EventHandlerResult::OK));
+
+  // The press of `X`, which a plugin swallowed: after the six entries of `A`.
+  const DumpedEntry &swallowed = dump.entries[7];
+  EXPECT_EQ(swallowed.timestamp, swallow_time);
+  EXPECT_EQ(swallowed.event, unsigned(TraceEvent::KeyEvent));
+  EXPECT_EQ(swallowed.addr, key_addr_X.toInt());
+  EXPECT_EQ(swallowed.key, Key_X.getRaw());
+  EXPECT_EQ(swallowed.handler, swallow_x_index);
+  EXPECT_EQ(swallowed.result, unsigned(EventHandlerResult::EVENT_CONSUMED));
+
+  // The injected press and release, and their reports, have no address.
+  ASSERT_GE(dump.entries.size(), 4u);
+  for (size_t i = dump.entries.size() - 4; i < dump.entries.size(); i++) {
+    EXPECT_EQ(dump.entries[i].addr, 0xffu)
+        << "decode-trace shows 0xff as no address, entry " << i;
+    EXPECT_EQ(dump.entries[i].key, Key_B.getRaw()) << "Entry " << i;
+    EXPECT_EQ(dump.entries[i].state & INJECTED, unsigned(INJECTED)) << "Entry " << i;
+  }
+
+  for (uint16_t i = 0; i < trace_ring.count(); i++) {
+    EXPECT_EQ(dump.entries[i].timestamp, trace_ring.entry(i).timestamp)
+        << "The dump is oldest first, entry " << i;
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,167 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/setup-googletest.h"
+#include "testing/Latency.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_OSM_Ctrl{0, 0};
+constexpr KeyAddr key_addr_Qukey_A{2, 1};
+constexpr KeyAddr key_addr_J{2, 11};
+constexpr KeyAddr key_addr_K{2, 12};
+constexpr KeyAddr key_addr_SpaceCadet_Shift{3, 7};
+
+// Each test runs its workload once for each of these.
+constexpr uint8_t cycle_times[] = {1, 5, 10};
+
+constexpr uint16_t qukeys_hold_timeout = 250;
+// A qukey tapped again within this long might be the start of a tap-repeat, so
+// Qukeys holds on to the release of the first tap until it knows.
+constexpr uint16_t qukeys_tap_repeat_timeout = 200;
+constexpr uint16_t spacecadet_timeout = 200;
+
+class StockLatency : public VirtualDeviceTest {
+ protected:
+  LatencyProbe probe{sim_};
+
+  void Tap(KeyAddr key_addr, Key key, size_t hold, size_t gap) {
+    probe.Press(key_addr, key);
+    probe.RunForMillis(hold);
+    probe.Release(key_addr, key);
+    probe.RunForMillis(gap);
+  }
+
+  void Start(uint8_t cycle_time) {
+    sim_.SetCycleTime(cycle_time);
+    // Let any state from the previous run expire.
+    sim_.RunForMillis(1000);
+    probe.Start();
+  }
+};
+
+TEST_F(StockLatency, PlainKeys) {
+  for (uint8_t cycle_time : cycle_times) {
+    SCOPED_TRACE(::testing::Message() << "cycle time " << int(cycle_time) << "ms");
+    Start(cycle_time);
+
+    for (int i = 0; i < 50; i++) {
+      Tap(key_addr_J, Key_J, 30, 20);
+      Tap(key_addr_K, Key_K, 20, 30);
+    }
+    probe.Finish();
+
+    EXPECT_EQ(probe.Unmatched(), 0);
+    EXPECT_EQ(probe.All().Count(), 200);
+    EXPECT_MAX_LATENCY_LE(probe.All(), cycle_time)
+        << "Plain keys show up in the very next cycle";
+    EXPECT_EQ(probe.All().PercentileCycles(100), 1);
+    EXPECT_EQ(probe.ForKey(key_addr_J).Count(), 100);
+  }
+}
+
+TEST_F(StockLatency, OneShotModifier) {
+  for (uint8_t cycle_time : cycle_times) {
+    SCOPED_TRACE(::testing::Message() << "cycle time " << int(cycle_time) << "ms");
+    Start(cycle_time);
+
+    for (int i = 0; i < 20; i++) {
+      probe.Press(key_addr_OSM_Ctrl, Key_LeftControl);
+      probe.RunForMillis(30);
+      probe.Release(key_addr_OSM_Ctrl, Key_LeftControl);
+      probe.RunForMillis(30);
+      Tap(key_addr_J, Key_J, 30, 100);
+    }
+    probe.Finish();
+
+    EXPECT_EQ(probe.Unmatched(), 0);
+    EXPECT_MAX_LATENCY_LE(probe.Presses(), cycle_time)
+        << "A one-shot modifier is active as soon as it is pressed";
+  }
+}
+
+TEST_F(StockLatency, QukeyTaps) {
+  for (uint8_t cycle_time : cycle_times) {
+    SCOPED_TRACE(::testing::Message() << "cycle time " << int(cycle_time) << "ms");
+    Start(cycle_time);
+
+    for (int i = 0; i < 50; i++)
+      Tap(key_addr_Qukey_A, Key_A, 40, qukeys_tap_repeat_timeout + 10);
+    probe.Finish();
+
+    EXPECT_EQ(probe.Unmatched(), 0);
+    EXPECT_MAX_LATENCY_LE(probe.Presses(), 40 + cycle_time)
+        << "A tapped qukey shows up when it is released";
+    EXPECT_MAX_LATENCY_LE(probe.Releases(),
+                          qukeys_tap_repeat_timeout - 40 + cycle_time)
+        << "A tapped qukey is held until it can't be a tap-repeat any more";
+  }
+}
+
+TEST_F(StockLatency, QukeyHolds) {
+  for (uint8_t cycle_time : cycle_times) {
+    SCOPED_TRACE(::testing::Message() << "cycle time " << int(cycle_time) << "ms");
+    Start(cycle_time);
+
+    for (int i = 0; i < 20; i++)
+      Tap(key_addr_Qukey_A, Key_LeftGui, 400, 100);
+    probe.Finish();
+
+    EXPECT_EQ(probe.Unmatched(), 0);
+    EXPECT_MAX_LATENCY_LE(probe.Presses(), qukeys_hold_timeout + 2 * cycle_time)
+        << "A held qukey shows up when the hold timeout expires";
+    EXPECT_MAX_LATENCY_LE(probe.Releases(), cycle_time);
+  }
+}
+
+TEST_F(StockLatency, SpaceCadetTaps) {
+  for (uint8_t cycle_time : cycle_times) {
+    SCOPED_TRACE(::testing::Message() << "cycle time " << int(cycle_time) << "ms");
+    Start(cycle_time);
+
+    for (int i = 0; i < 50; i++)
+      Tap(key_addr_SpaceCadet_Shift, Key_9, 40, 60);
+    probe.Finish();
+
+    EXPECT_EQ(probe.Unmatched(), 0);
+    EXPECT_MAX_LATENCY_LE(probe.Presses(), 40 + cycle_time)
+        << "A tapped SpaceCadet key shows up when it is released";
+  }
+}
+
+TEST_F(StockLatency, SpaceCadetHolds) {
+  for (uint8_t cycle_time : cycle_times) {
+    SCOPED_TRACE(::testing::Message() << "cycle time " << int(cycle_time) << "ms");
+    Start(cycle_time);
+
+    for (int i = 0; i < 20; i++)
+      Tap(key_addr_SpaceCadet_Shift, Key_LeftShift, 400, 100);
+    probe.Finish();
+
+    EXPECT_EQ(probe.Unmatched(), 0);
+    EXPECT_MAX_LATENCY_LE(probe.Presses(), spacecadet_timeout + 2 * cycle_time)
+        << "A held SpaceCadet key shows up when its timeout expires";
+    EXPECT_MAX_LATENCY_LE(probe.Releases(), cycle_time);
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,154 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/setup-googletest.h"
+
+#include <Kaleidoscope-EEPROM-Settings.h>
+#include <Kaleidoscope-LED-Palette-Theme.h>
+#include <Kaleidoscope-LEDControl.h>
+
+#include "../common.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_A{2, 1};
+constexpr KeyAddr key_addr_S{2, 2};
+constexpr KeyAddr key_addr_D{2, 3};
+constexpr KeyAddr key_addr_Fn{3, 6};
+
+constexpr cRGB palette[] = {
+  CRGB(0x00, 0x00, 0x00),
+  CRGB(0xff, 0x00, 0x00),
+  CRGB(0x00, 0xff, 0x00),
+};
+
+constexpr uint8_t theme_size = Runtime.device().led_count / 2;
+
+class ColormapLayerSwitch : public VirtualDeviceTest {
+ protected:
+  void SetUp() {
+    VirtualDeviceTest::SetUp();
+
+    // The palette is stored with every component inverted, so that erased
+    // storage reads as black.
+    for (uint8_t i = 0; i < 3; i++) {
+      cRGB color = palette[i];
+      color.r ^= 0xff;
+      color.g ^= 0xff;
+      color.b ^= 0xff;
+      Runtime.storage().put(palette_base + i * sizeof(cRGB), color);
+    }
+
+    uint16_t map_base = palette_base + 16 * sizeof(cRGB);
+    for (uint8_t layer = 0; layer < COLORMAP_LAYERS; layer++) {
+      for (uint8_t i = 0; i < theme_size; i++)
+        Runtime.storage().update(map_base + layer * theme_size + i, 0);
+    }
+    ::LEDPaletteTheme.updateColorIndexAtPosition(
+      map_base + theme_size, Runtime.device().getLedIndex(key_addr_A), 1);
+    ::LEDPaletteTheme.updateColorIndexAtPosition(
+      map_base + theme_size, Runtime.device().getLedIndex(key_addr_S), 2);
+
+    ::LEDPaletteTheme.invalidateCache();
+    ::LEDControl.refreshAll();
+    Runtime.storage().resetCounters();
+  }
+};
+
+TEST_F(ColormapLayerSwitch, RepaintsChangedKeys) {
+  EXPECT_LED(key_addr_A, palette[0]) << "`A` starts out with the layer 0 color";
+  EXPECT_LED(key_addr_S, palette[0]) << "`S` starts out with the layer 0 color";
+
+  sim_.Press(key_addr_Fn);
+  RunCycle();
+
+  EXPECT_LED(key_addr_A, palette[1]) << "`A` is repainted with the layer 1 color";
+  EXPECT_LED(key_addr_S, palette[2]) << "`S` is repainted with the layer 1 color";
+  EXPECT_LED(key_addr_D, palette[0]) << "`D` has the same color on both layers";
+
+  sim_.RunForMillis(40);
+  auto state = RunCycle();
+
+  ASSERT_GT(state->LEDs()->FramesSynced(), 0);
+  EXPECT_THAT(state->LEDs()->Frames().back().At(key_addr_A), IsColor(palette[1]))
+      << "The new color of `A` is synced to the hardware";
+
+  sim_.Release(key_addr_Fn);
+  RunCycle();
+
+  EXPECT_LED(key_addr_A, palette[0]) << "`A` is restored to the layer 0 color";
+  EXPECT_LED(key_addr_S, palette[0]) << "`S` is restored to the layer 0 color";
+}
+
+TEST_F(ColormapLayerSwitch, StorageReadsPerLayerSwitch) {
+  auto before = OperationCounts::Current();
+  sim_.Press(key_addr_Fn);
+  RunCycle();
+  auto cost = OperationCounts::Current() - before;
+
+  EXPECT_LE(cost.storage_bytes_read, theme_size)
+      << "Switching layers reads at most one theme row from storage";
+  EXPECT_THAT(cost, StorageReadsAtMost(1))
+      << "The theme row is read in one go, the palette comes from RAM";
+
+  before = OperationCounts::Current();
+  sim_.Release(key_addr_Fn);
+  RunCycle();
+  cost = OperationCounts::Current() - before;
+
+  EXPECT_LE(cost.storage_bytes_read, theme_size)
+      << "Switching back reads at most one theme row from storage";
+
+  before = OperationCounts::Current();
+  sim_.Press(key_addr_A);
+  RunCycle();
+  sim_.Release(key_addr_A);
+  RunCycle();
+
+  EXPECT_THAT(OperationCounts::Current() - before, StorageReadsAtMost(0))
+      << "Key presses that do not change the top layer do not read storage";
+}
+
+TEST_F(ColormapLayerSwitch, ReloadsOverwrittenStorage) {
+  sim_.Press(key_addr_Fn);
+  RunCycle();
+  sim_.Release(key_addr_Fn);
+  RunCycle();
+
+  // Change the second palette color behind the plugin's back, like
+  // `eeprom.contents` would.
+  constexpr cRGB blue = CRGB(0x00, 0x00, 0xff);
+  cRGB stored = blue;
+  stored.r ^= 0xff;
+  stored.g ^= 0xff;
+  stored.b ^= 0xff;
+  Runtime.storage().put(palette_base + sizeof(cRGB), stored);
+  ::EEPROMSettings.contentsReplaced();
+
+  sim_.Press(key_addr_Fn);
+  RunCycle();
+
+  EXPECT_LED(key_addr_A, blue) << "`A` is painted with the new palette color";
+  EXPECT_LED(key_addr_S, palette[2]) << "`S` keeps its color";
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
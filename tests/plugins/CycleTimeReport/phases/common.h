@@ -0,0 +1,60 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <Kaleidoscope.h>
+
+namespace kaleidoscope {
+namespace plugin {
+
+// Makes its hooks take as long as a test says, by moving the virtual
+// microsecond clock forward.
+class Slowpoke : public kaleidoscope::Plugin {
+ public:
+  uint32_t before_each_cycle = 0;
+  uint32_t on_key_event = 0;
+  uint32_t after_each_cycle = 0;
+  uint32_t before_syncing_leds = 0;
+  // How long printing the report once a second takes.
+  uint32_t report = 0;
+
+  EventHandlerResult beforeEachCycle() {
+    take(before_each_cycle);
+    return EventHandlerResult::OK;
+  }
+  EventHandlerResult onKeyEvent(KeyEvent &event) {
+    take(on_key_event);
+    return EventHandlerResult::OK;
+  }
+  EventHandlerResult afterEachCycle() {
+    take(after_each_cycle);
+    return EventHandlerResult::OK;
+  }
+  EventHandlerResult beforeSyncingLeds() {
+    take(before_syncing_leds);
+    return EventHandlerResult::OK;
+  }
+
+ void take(uint32_t micros) {
+    Kaleidoscope.device().mcu().clock().advance(micros);
+  }
+};
+
+}  // namespace plugin
+}  // namespace kaleidoscope
+
+extern kaleidoscope::plugin::Slowpoke Slowpoke;
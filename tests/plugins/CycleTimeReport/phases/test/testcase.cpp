@@ -0,0 +1,148 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <string>
+
+#include <Kaleidoscope-CycleTimeReport.h>
+
+#include "kaleidoscope/CycleProfile.h"
+#include "testing/setup-googletest.h"
+
+#include "../common.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+using kaleidoscope::plugin::CycleTimeHistogram;
+
+constexpr KeyAddr key_addr_A{2, 1};
+
+// The buckets that aren't empty, as `start:count`, for failure messages.
+std::string Dump(const CycleTimeHistogram &histogram) {
+  std::ostringstream out;
+  for (uint8_t i = 0; i < CycleTimeHistogram::bucket_count; i++) {
+    if (histogram.bucket(i) != 0)
+      out << " " << CycleTimeHistogram::bucketStart(i) << ":" << histogram.bucket(i);
+  }
+  return out.str();
+}
+
+class CycleTimeReportTest : public VirtualDeviceTest {
+ protected:
+  // Gives every cycle the same cost, with the extras on cycles that sync the
+  // LEDs or handle events, and starts over from there.
+  void SetCosts(uint32_t before_each_cycle, uint32_t after_each_cycle,
+                uint32_t on_key_event, uint32_t before_syncing_leds) {
+    Slowpoke.before_each_cycle = before_each_cycle;
+    Slowpoke.after_each_cycle = after_each_cycle;
+    Slowpoke.on_key_event = on_key_event;
+    Slowpoke.before_syncing_leds = before_syncing_leds;
+    Slowpoke.report = 0;
+    sim_.RunCycle();
+    ::CycleTimeReport.reset();
+  }
+
+  void TearDown() override {
+    SetCosts(0, 0, 0, 0);
+  }
+};
+
+TEST_F(CycleTimeReportTest, ChargesEachPhaseSeparately) {
+  SetCosts(10, 20, 50, 100);
+
+  sim_.Press(key_addr_A);
+  sim_.RunCycle();
+  sim_.Release(key_addr_A);
+  sim_.RunCycle();
+  sim_.RunCycles(62);
+
+  ASSERT_EQ(cycle_profile.cycles(), 64);
+  EXPECT_EQ(cycle_profile.longest(CyclePhase::BeforeEachCycle), 10);
+  EXPECT_EQ(cycle_profile.mean(CyclePhase::BeforeEachCycle), 10);
+  EXPECT_EQ(cycle_profile.longest(CyclePhase::ScanMatrix), 0);
+  EXPECT_EQ(cycle_profile.longest(CyclePhase::EventHandling), 50);
+  EXPECT_EQ(cycle_profile.longest(CyclePhase::AfterEachCycle), 20)
+      << "LED syncs in `afterEachCycle()` are not charged to it";
+  EXPECT_EQ(cycle_profile.mean(CyclePhase::AfterEachCycle), 20);
+  EXPECT_EQ(cycle_profile.longest(CyclePhase::LEDSync), 100);
+  EXPECT_GT(cycle_profile.mean(CyclePhase::LEDSync), 0);
+}
+
+TEST_F(CycleTimeReportTest, PercentilesShowTheSpikes) {
+  SetCosts(10, 20, 0, 1000);
+
+  sim_.RunCycles(3200);
+
+  auto &histogram = ::CycleTimeReport.histogram();
+  ASSERT_EQ(histogram.count(), 3200) << Dump(histogram);
+  EXPECT_EQ(histogram.longest(), 2030) << Dump(histogram);
+
+  // Every cycle but the ones that sync the LEDs takes the simulator's 1ms, and
+  // 30us in the hooks. Percentiles are rounded up to the end of their bucket,
+  // which is no more than a quarter longer than its start.
+  EXPECT_GE(histogram.percentile(50), 1030) << Dump(histogram);
+  EXPECT_LE(histogram.percentile(50), 1030 * 5 / 4) << Dump(histogram);
+  EXPECT_LE(histogram.percentile(90), 1030 * 5 / 4) << Dump(histogram);
+  // About one in 32 cycles syncs the LEDs, which is more than one in a
+  // hundred.
+  EXPECT_EQ(histogram.percentile(99), 2030) << Dump(histogram);
+}
+
+TEST_F(CycleTimeReportTest, ReportIsNotCharged) {
+  SetCosts(10, 20, 0, 0);
+  Slowpoke.report = 50000;
+
+  sim_.RunCycles(3200);
+
+  auto &histogram = ::CycleTimeReport.histogram();
+  EXPECT_EQ(histogram.longest(), 1030)
+      << "The time it takes to print the report isn't part of any cycle"
+      << Dump(histogram);
+}
+
+TEST_F(CycleTimeReportTest, ResetEmptiesEverything) {
+  SetCosts(10, 20, 0, 0);
+  sim_.RunCycles(10);
+
+  ::CycleTimeReport.reset();
+
+  EXPECT_EQ(::CycleTimeReport.histogram().count(), 0);
+  EXPECT_EQ(::CycleTimeReport.histogram().longest(), 0);
+  EXPECT_EQ(::CycleTimeReport.histogram().percentile(99), 0);
+  EXPECT_EQ(cycle_profile.cycles(), 0);
+  EXPECT_EQ(cycle_profile.longest(CyclePhase::AfterEachCycle), 0);
+}
+
+TEST_F(CycleTimeReportTest, BucketsAreNarrow) {
+  for (uint32_t micros = 0; micros < 200000; micros++) {
+    uint8_t index = CycleTimeHistogram::bucketIndex(micros);
+    uint32_t start = CycleTimeHistogram::bucketStart(index);
+    ASSERT_LE(start, micros);
+    if (index == CycleTimeHistogram::bucket_count - 1)
+      continue;
+    uint32_t next = CycleTimeHistogram::bucketStart(index + 1);
+    ASSERT_LT(micros, next);
+    ASSERT_LE(next - start, start < 4 ? 1 : start / 4) << "Bucket " << int(index);
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,160 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "testing/setup-googletest.h"
+
+#include "Kaleidoscope-DynamicMacros.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_DM0{0, 0};
+constexpr KeyAddr key_addr_DM1{0, 1};
+constexpr KeyAddr key_addr_DM2{0, 2};
+constexpr KeyAddr key_addr_A{1, 0};
+
+// Taps X, waits two seconds, then taps Y.
+const macro_t slow_macro[] = {
+  Tc(X),
+  W(250), W(250), W(250), W(250), W(250), W(250), W(250), W(250),
+  Tc(Y),
+  MACRO_ACTION_END,
+};
+
+// Three short macros: one that taps C, one that types "de", and one that taps
+// F, followed by the empty macro that ends the list.
+const macro_t short_macros[] = {
+  Tc(C), MACRO_ACTION_END,
+  SEQ(K(D), K(E)), MACRO_ACTION_END,
+  Tc(F), MACRO_ACTION_END,
+  MACRO_ACTION_END,
+};
+
+class DynamicMacrosPlayback : public VirtualDeviceTest {
+ protected:
+  void Tap(KeyAddr key_addr) {
+    sim_.Press(key_addr);
+    sim_.RunCycle();
+    sim_.Release(key_addr);
+    sim_.RunCycle();
+  }
+
+  // Returns the timestamp of the first keyboard report since the last call to
+  // `LoadState()` that contains `key`, or -1 if there is none.
+  int64_t ReportTime(Key key) const {
+    for (const KeyboardReport &report : HIDReports()->Keyboard()) {
+      for (uint8_t keycode : report.ActiveKeycodes()) {
+        if (keycode == key.getKeyCode())
+          return report.Timestamp();
+      }
+    }
+    return -1;
+  }
+
+  // Plays the macro on the key at `key_addr`, and returns the keycodes it
+  // typed, in order.
+  std::vector<uint8_t> Play(KeyAddr key_addr) {
+    ClearState();
+    Tap(key_addr);
+    sim_.RunForMillis(10);
+    LoadState();
+
+    std::vector<uint8_t> typed;
+    for (const KeyboardReport &report : HIDReports()->Keyboard()) {
+      for (uint8_t keycode : report.ActiveKeycodes())
+        typed.push_back(keycode);
+    }
+    return typed;
+  }
+};
+
+TEST_F(DynamicMacrosPlayback, KeysTypedDuringMacroAreNotDelayed) {
+  DynamicMacros.update(0, slow_macro, sizeof(slow_macro));
+  ClearState();
+
+  sim_.Press(key_addr_DM0);
+  sim_.RunCycle();
+  uint32_t start = Runtime.millisAtCycleStart();
+  sim_.Release(key_addr_DM0);
+  sim_.RunForMillis(500);
+
+  sim_.Press(key_addr_A);
+  sim_.RunCycle();
+  uint32_t a_pressed = Runtime.millisAtCycleStart();
+  sim_.Release(key_addr_A);
+  sim_.RunCycle();
+  uint32_t a_released = Runtime.millisAtCycleStart();
+
+  sim_.RunForMillis(2000);
+  LoadState();
+
+  EXPECT_EQ(ReportTime(Key_X), start)
+      << "The macro starts as soon as its key is pressed";
+  EXPECT_EQ(ReportTime(Key_A), a_pressed)
+      << "A key pressed while the macro waits is reported right away";
+  EXPECT_LT(a_released - a_pressed, 2u)
+      << "The firmware keeps running while the macro waits";
+  EXPECT_EQ(ReportTime(Key_Y), start + 2000)
+      << "The macro finishes after waiting for two seconds";
+}
+
+TEST_F(DynamicMacrosPlayback, ShortMacros) {
+  DynamicMacros.update(0, short_macros, sizeof(short_macros));
+
+  EXPECT_EQ(Play(key_addr_DM0), std::vector<uint8_t>({Key_C.getKeyCode()}));
+  EXPECT_EQ(Play(key_addr_DM1),
+            std::vector<uint8_t>({Key_D.getKeyCode(), Key_E.getKeyCode()}));
+  EXPECT_EQ(Play(key_addr_DM2), std::vector<uint8_t>({Key_F.getKeyCode()}));
+}
+
+TEST_F(DynamicMacrosPlayback, EditOneMacro) {
+  DynamicMacros.update(0, short_macros, sizeof(short_macros));
+
+  // Replace the keycode the first macro taps. Nothing moves, so only the
+  // first macro has to be looked at again.
+  auto &storage = Runtime.storage();
+  storage.resetCounters();
+  const macro_t tap_g[] = {Tc(G)};
+  DynamicMacros.update(0, tap_g, sizeof(tap_g));
+  EXPECT_EQ(storage.bytesRead(), 16u)
+      << "Only one block of storage is read to update the index";
+
+  EXPECT_EQ(Play(key_addr_DM0), std::vector<uint8_t>({Key_G.getKeyCode()}));
+  EXPECT_EQ(Play(key_addr_DM2), std::vector<uint8_t>({Key_F.getKeyCode()}));
+
+  // Make the first macro one step longer, which moves the others.
+  const macro_t tap_g_h[] = {
+    Tc(G), Tc(H), MACRO_ACTION_END,
+    SEQ(K(D), K(E)), MACRO_ACTION_END,
+    Tc(F), MACRO_ACTION_END,
+    MACRO_ACTION_END,
+  };
+  DynamicMacros.update(0, tap_g_h, sizeof(tap_g_h));
+
+  EXPECT_EQ(Play(key_addr_DM0),
+            std::vector<uint8_t>({Key_G.getKeyCode(), Key_H.getKeyCode()}));
+  EXPECT_EQ(Play(key_addr_DM1),
+            std::vector<uint8_t>({Key_D.getKeyCode(), Key_E.getKeyCode()}));
+  EXPECT_EQ(Play(key_addr_DM2), std::vector<uint8_t>({Key_F.getKeyCode()}));
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,150 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "testing/setup-googletest.h"
+
+#include <Kaleidoscope-FingerPainter.h>
+#include <Kaleidoscope-LED-Palette-Theme.h>
+#include <Kaleidoscope-LEDControl.h>
+
+#include "../common.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_Q{1, 1};
+constexpr KeyAddr key_addr_A{2, 1};
+constexpr KeyAddr key_addr_S{2, 2};
+constexpr KeyAddr key_addr_D{2, 3};
+constexpr KeyAddr key_addr_F{2, 4};
+constexpr KeyAddr key_addr_G{2, 5};
+
+// The second and third colors are the same, so painting skips the third one.
+// The rest of the palette is black.
+constexpr cRGB palette[16] = {
+  CRGB(0x00, 0x00, 0x00),
+  CRGB(0xff, 0x00, 0x00),
+  CRGB(0xff, 0x00, 0x00),
+  CRGB(0x00, 0xff, 0x00),
+};
+
+constexpr uint8_t theme_size = Runtime.device().led_count / 2;
+
+class FingerPainterPainting : public VirtualDeviceTest {
+ protected:
+  void SetUp() {
+    VirtualDeviceTest::SetUp();
+
+    // The palette is stored with every component inverted, so that erased
+    // storage reads as black.
+    for (uint8_t i = 0; i < 16; i++) {
+      cRGB color = palette[i];
+      color.r ^= 0xff;
+      color.g ^= 0xff;
+      color.b ^= 0xff;
+      Runtime.storage().put(palette_base + i * sizeof(cRGB), color);
+    }
+    for (uint8_t i = 0; i < theme_size; i++)
+      Runtime.storage().update(theme_base() + i, 0);
+
+    ::LEDPaletteTheme.invalidateCache();
+    ::FingerPainter.toggle();
+    Runtime.storage().resetCounters();
+  }
+
+  void TearDown() {
+    ::FingerPainter.toggle();
+    VirtualDeviceTest::TearDown();
+  }
+
+  static uint16_t theme_base() {
+    return palette_base + 16 * sizeof(cRGB);
+  }
+
+  uint8_t StoredColorIndex(KeyAddr key_addr) {
+    uint8_t indexes = Runtime.storage().read(theme_base() + Runtime.device().getLedIndex(key_addr) / 2);
+    if (Runtime.device().getLedIndex(key_addr) % 2)
+      return indexes & 0x0f;
+    return indexes >> 4;
+  }
+
+  void Tap(KeyAddr key_addr) {
+    sim_.Press(key_addr);
+    sim_.RunCycle();
+    sim_.Release(key_addr);
+    sim_.RunCycle();
+    sim_.RunForMillis(20);
+  }
+};
+
+TEST_F(FingerPainterPainting, FiftyTapSession) {
+  for (uint8_t i = 0; i < 10; i++) {
+    for (KeyAddr key_addr : {key_addr_A, key_addr_S, key_addr_D, key_addr_F, key_addr_G})
+      Tap(key_addr);
+  }
+
+  EXPECT_EQ(Runtime.storage().commitCount(), 0)
+      << "Nothing is committed while painting";
+  EXPECT_EQ(Runtime.storage().bytesWritten(), 0);
+
+  // Each key went through the colors 1, 3, 4, 1, 3, 4, 1, 3, 4, 1: color 2 is
+  // skipped, because it is the same as color 1, and every color after color 3
+  // is black, like color 0.
+  EXPECT_LED(key_addr_A, palette[1]) << "Painted keys show their new color";
+
+  ::FingerPainter.toggle();
+  RecordProperty("commits_per_50_taps", std::to_string(Runtime.storage().commitCount()));
+  EXPECT_EQ(Runtime.storage().commitCount(), 1)
+      << "Leaving edit mode commits the theme once";
+  EXPECT_LE(Runtime.storage().bytesWritten(), 5)
+      << "Only the bytes of the painted keys are written";
+
+  for (KeyAddr key_addr : {key_addr_A, key_addr_S, key_addr_D, key_addr_F, key_addr_G})
+    EXPECT_EQ(StoredColorIndex(key_addr), 1);
+
+  sim_.RunCycle();
+  EXPECT_LED(key_addr_A, palette[1]) << "The stored theme shows the painted color";
+  EXPECT_LED(key_addr_Q, palette[0]);
+
+  ::FingerPainter.toggle();
+}
+
+TEST_F(FingerPainterPainting, IdleTimeoutFlushes) {
+  Tap(key_addr_A);
+  Tap(key_addr_A);
+  EXPECT_LED(key_addr_A, palette[3]);
+
+  sim_.RunForMillis(::FingerPainter.flush_timeout - 100);
+  EXPECT_EQ(Runtime.storage().commitCount(), 0);
+
+  sim_.RunForMillis(200);
+  EXPECT_EQ(Runtime.storage().commitCount(), 1)
+      << "The theme is committed once painting pauses";
+  EXPECT_EQ(StoredColorIndex(key_addr_A), 3);
+
+  ::FingerPainter.toggle();
+  EXPECT_EQ(Runtime.storage().commitCount(), 1)
+      << "Leaving edit mode with nothing painted commits nothing";
+  ::FingerPainter.toggle();
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,49 @@
+// -*- mode: c++ -*-
+
+/* Kaleidoscope - Firmware for computer input devices
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <Kaleidoscope-GhostInTheFirmware.h>
+
+namespace kaleidoscope {
+namespace testing {
+
+// The number of times `cycleTimeReport()` was called.
+extern uint16_t cycle_time_reports;
+
+// Counts the presses and releases that reach `onKeyswitchEvent()`.
+class KeyswitchEventCounter : public kaleidoscope::Plugin {
+ public:
+  uint16_t presses = 0;
+  uint16_t releases = 0;
+
+  EventHandlerResult onKeyswitchEvent(KeyEvent &event) {
+    if (keyToggledOn(event.state))
+      presses++;
+    if (keyToggledOff(event.state))
+      releases++;
+    return EventHandlerResult::OK;
+  }
+};
+
+extern KeyswitchEventCounter KeyswitchEvents;
+
+}
+}
@@ -0,0 +1,182 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <vector>
+
+#include "testing/setup-googletest.h"
+
+#include "../common.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+// A keyboard report, as the set of keys in it and the time it was sent,
+// relative to the first report.
+struct Report {
+  std::vector<uint8_t> keycodes;
+  uint32_t time;
+
+  bool operator==(const Report &other) const {
+    return keycodes == other.keycodes && time == other.time;
+  }
+};
+
+const uint8_t A = Key_A.getKeyCode();
+const uint8_t B = Key_B.getKeyCode();
+const uint8_t C = Key_C.getKeyCode();
+const uint8_t D = Key_D.getKeyCode();
+
+class GhostTimeline : public VirtualDeviceTest {
+ protected:
+  void SetUp() override {
+    VirtualDeviceTest::SetUp();
+    GhostInTheFirmware.rate = 100;
+    GhostInTheFirmware.jitter = 0;
+    GhostInTheFirmware.repeat = 1;
+  }
+
+  // Plays the timeline once, and returns the keyboard reports it produced.
+  std::vector<Report> Play() {
+    LoadState();
+    GhostInTheFirmware.playTimeline();
+    for (int i = 0; i < 1000 && GhostInTheFirmware.isPlayingTimeline(); i++)
+      sim_.RunCycle();
+    EXPECT_FALSE(GhostInTheFirmware.isPlayingTimeline());
+    LoadState();
+
+    std::vector<Report> reports;
+    for (auto &report : HIDReports()->Keyboard()) {
+      auto keycodes = report.ActiveKeycodes();
+      std::sort(keycodes.begin(), keycodes.end());
+      reports.push_back({keycodes, report.Timestamp() - HIDReports()->Keyboard(0).Timestamp()});
+    }
+    return reports;
+  }
+};
+
+TEST_F(GhostTimeline, OverlappingPresses) {
+  std::vector<Report> expected{
+    {{A}, 0},
+    {{A, B}, 10},
+    {{A, B, C}, 20},
+    {{B, C}, 30},
+    {{C}, 40},
+    {{}, 50},
+    {{D}, 60},
+    {{}, 70},
+  };
+  EXPECT_EQ(Play(), expected);
+}
+
+TEST_F(GhostTimeline, PressesAreKeyswitchEvents) {
+  KeyswitchEvents.presses = 0;
+  KeyswitchEvents.releases = 0;
+  Play();
+
+  EXPECT_EQ(KeyswitchEvents.presses, 4)
+      << "Plugins see the timeline's presses as keyswitch events";
+  EXPECT_EQ(KeyswitchEvents.releases, 4);
+}
+
+TEST_F(GhostTimeline, RateScalesTimes) {
+  GhostInTheFirmware.rate = 200;
+  std::vector<Report> expected{
+    {{A}, 0},
+    {{A, B}, 5},
+    {{A, B, C}, 10},
+    {{B, C}, 15},
+    {{C}, 20},
+    {{}, 25},
+    {{D}, 30},
+    {{}, 35},
+  };
+  EXPECT_EQ(Play(), expected);
+}
+
+TEST_F(GhostTimeline, RateZeroPlaysSlowly) {
+  GhostInTheFirmware.rate = 0;
+  GhostInTheFirmware.playTimeline();
+  sim_.RunCycles(500);
+  EXPECT_TRUE(GhostInTheFirmware.isPlayingTimeline())
+      << "A rate of zero plays the timeline at the slowest rate";
+  GhostInTheFirmware.stopTimeline();
+  sim_.RunCycle();
+}
+
+TEST_F(GhostTimeline, SeededJitterIsReproducible) {
+  GhostInTheFirmware.jitter = 4;
+
+  GhostInTheFirmware.seed(42);
+  auto first = Play();
+  GhostInTheFirmware.seed(42);
+  auto second = Play();
+  GhostInTheFirmware.seed(7);
+  auto third = Play();
+
+  EXPECT_EQ(first, second) << "The same seed plays the same timeline";
+  EXPECT_NE(first, third) << "A different seed plays a different one";
+  EXPECT_TRUE(first.back().keycodes.empty()) << "Every key gets released";
+}
+
+TEST_F(GhostTimeline, StressWithCycleTimeReport) {
+  GhostInTheFirmware.rate = 400;
+  GhostInTheFirmware.jitter = 3;
+  GhostInTheFirmware.repeat = 0;
+  GhostInTheFirmware.seed(1);
+  cycle_time_reports = 0;
+
+  GhostInTheFirmware.playTimeline();
+
+  // The cycles are measured by the operations they do, priced for the
+  // ATmega32U4, rather than by the wall clock of the machine running the test.
+  OperationCounts worst;
+  uint64_t total = 0;
+  constexpr int cycles = 3000;
+  for (int i = 0; i < cycles; i++) {
+    auto before = OperationCounts::Current();
+    sim_.RunCycle();
+    auto cost = OperationCounts::Current() - before;
+    if (atmega32u4_costs.Cost(cost) > atmega32u4_costs.Cost(worst))
+      worst = cost;
+    total += atmega32u4_costs.Cost(cost);
+  }
+
+  EXPECT_TRUE(GhostInTheFirmware.isPlayingTimeline())
+      << "A timeline with `repeat` set to zero plays until stopped";
+  GhostInTheFirmware.stopTimeline();
+  sim_.RunCycle();
+  LoadState();
+
+  EXPECT_GE(cycle_time_reports, 2)
+      << "CycleTimeReport keeps recording while the timeline plays";
+  EXPECT_GT(HIDReports()->Keyboard().size(), 1000);
+  EXPECT_TRUE(HIDReports()->Keyboard().back().ActiveKeycodes().empty())
+      << "Stopping the timeline releases every key";
+
+  EXPECT_THAT(worst, CostsAtMost(atmega32u4_costs, 10000000))
+      << "No cycle takes longer than 10ms";
+  RecordProperty("nsec_worst_cycle", std::to_string(atmega32u4_costs.Cost(worst)));
+  RecordProperty("nsec_per_cycle", std::to_string(total / cycles));
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
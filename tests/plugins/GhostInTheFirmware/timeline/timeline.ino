@@ -0,0 +1,78 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <Kaleidoscope.h>
+#include <Kaleidoscope-CycleTimeReport.h>
+#include <Kaleidoscope-GhostInTheFirmware.h>
+
+#include "./common.h"
+
+// *INDENT-OFF*
+KEYMAPS(
+    [0] = KEYMAP_STACKED
+    (
+        ___, Key_A, Key_B, Key_C, Key_D, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___,
+        ___,
+
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___,
+        ___
+    ),
+)
+// *INDENT-ON*
+
+namespace kaleidoscope {
+namespace testing {
+
+uint16_t cycle_time_reports;
+KeyswitchEventCounter KeyswitchEvents;
+
+}
+}
+
+KALEIDOSCOPE_INIT_PLUGINS(kaleidoscope::testing::KeyswitchEvents,
+                          GhostInTheFirmware,
+                          CycleTimeReport);
+
+void cycleTimeReport() {
+  kaleidoscope::testing::cycle_time_reports++;
+}
+
+// `A`, `B`, and `C` rolling over each other, then `D` on its own.
+static const kaleidoscope::plugin::GhostInTheFirmware::TimelineKey timeline[] PROGMEM = {
+  {KeyAddr(0, 1), 0, 30},
+  {KeyAddr(0, 2), 10, 30},
+  {KeyAddr(0, 3), 20, 30},
+  {KeyAddr(0, 4), 60, 10},
+  {KeyAddr::none(), 0, 0}
+};
+
+void setup() {
+  Kaleidoscope.setup();
+  GhostInTheFirmware.timeline = timeline;
+}
+
+void loop() {
+  Kaleidoscope.loop();
+}
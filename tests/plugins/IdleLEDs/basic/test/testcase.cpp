@@ -0,0 +1,79 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/setup-googletest.h"
+
+#include "../common.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_A{2, 1};
+
+constexpr cRGB blue = CRGB(0, 0, 160);
+constexpr cRGB off = CRGB(0, 0, 0);
+
+class IdleLEDsBasic : public VirtualDeviceTest {
+ protected:
+  std::unique_ptr<State> state_ = nullptr;
+};
+
+TEST_F(IdleLEDsBasic, TurnsLEDsOffAndOn) {
+  // Start counting frames from here
+  state_ = RunCycle();
+
+  sim_.RunForMillis(320);
+  state_ = RunCycle();
+
+  EXPECT_GT(state_->LEDs()->FramesSynced(), 0)
+      << "LEDs are synced periodically while not idle";
+  EXPECT_THAT(state_->LEDs()->At(key_addr_A), IsColor(blue))
+      << "`A` has the color of the LED mode";
+
+  sim_.RunForMillis(IDLE_TIMEOUT_SECONDS * 1000);
+  state_ = RunCycle();
+
+  EXPECT_THAT(state_->LEDs()->At(key_addr_A), IsColor(off))
+      << "The LEDs are turned off after the idle timeout";
+  ASSERT_GT(state_->LEDs()->FramesSynced(), 0);
+  EXPECT_THAT(state_->LEDs()->Frames().back().At(key_addr_A), IsColor(off))
+      << "The turned off LEDs are synced to the hardware";
+
+  sim_.RunForMillis(320);
+  state_ = RunCycle();
+
+  EXPECT_EQ(state_->LEDs()->FramesSynced(), 0)
+      << "No LED frames are synced while idle";
+
+  sim_.Press(key_addr_A);
+  state_ = RunCycle();
+
+  EXPECT_LED(key_addr_A, blue) << "A keypress turns the LEDs back on";
+  ASSERT_EQ(state_->LEDs()->FramesSynced(), 1)
+      << "Waking up syncs the LEDs right away, and only once";
+  EXPECT_THAT(state_->LEDs()->Frame(0).At(key_addr_A), IsColor(blue));
+  EXPECT_EQ(state_->LEDs()->Frame(0).Timestamp(), Runtime.millisAtCycleStart());
+
+  sim_.Release(key_addr_A);
+  state_ = RunCycle();
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,173 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Kaleidoscope-IdleLEDs.h>
+
+#include "testing/setup-googletest.h"
+
+#include "../common.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_A{2, 1};
+
+constexpr cRGB blue = CRGB(0, 0, 160);
+constexpr cRGB off = CRGB(0, 0, 0);
+
+constexpr size_t measured_cycles = 1000;
+
+class IdleLEDsHostSuspend : public VirtualDeviceTest {
+ protected:
+  void SetHostSuspended(bool suspended) {
+    Runtime.device().mcu().setHostSuspended(suspended);
+  }
+
+  // Runs `measured_cycles` cycles, and returns the number of LED frames synced
+  // to the hardware during them.
+  size_t MeasureFramesSynced() {
+    sim_.RunCycles(measured_cycles - 1);
+    state_ = RunCycle();
+    return state_->LEDs()->FramesSynced();
+  }
+
+  std::unique_ptr<State> state_ = nullptr;
+};
+
+TEST_F(IdleLEDsHostSuspend, TurnsLEDsOffWhileSuspended) {
+  state_ = RunCycle();
+
+  size_t active_frames = MeasureFramesSynced();
+  EXPECT_GT(active_frames, 0)
+      << "LEDs are synced periodically while the host is awake";
+  RecordProperty("active_frames_per_1000_cycles", active_frames);
+
+  SetHostSuspended(true);
+  state_ = RunCycle();
+
+  EXPECT_LED(key_addr_A, off)
+      << "The LEDs are turned off when the host suspends";
+  ASSERT_EQ(state_->LEDs()->FramesSynced(), 1);
+  EXPECT_THAT(state_->LEDs()->Frame(0).At(key_addr_A), IsColor(off))
+      << "The turned off LEDs are synced to the hardware";
+
+  size_t suspended_frames = MeasureFramesSynced();
+  EXPECT_EQ(suspended_frames, 0)
+      << "No LED frames are synced while the host is suspended";
+  RecordProperty("suspended_frames_per_1000_cycles", suspended_frames);
+
+  SetHostSuspended(false);
+  state_ = RunCycle();
+
+  EXPECT_LED(key_addr_A, blue)
+      << "The LEDs are turned back on when the host resumes";
+  ASSERT_EQ(state_->LEDs()->FramesSynced(), 1)
+      << "Resuming syncs the LEDs right away, and only once";
+  EXPECT_THAT(state_->LEDs()->Frame(0).At(key_addr_A), IsColor(blue));
+}
+
+TEST_F(IdleLEDsHostSuspend, KeypressWakesLEDsWhileSuspended) {
+  SetHostSuspended(true);
+  state_ = RunCycle();
+
+  EXPECT_LED(key_addr_A, off);
+
+  sim_.Press(key_addr_A);
+  state_ = RunCycle();
+
+  EXPECT_LED(key_addr_A, blue)
+      << "A keypress turns the LEDs back on, even while suspended";
+  ASSERT_EQ(state_->LEDs()->FramesSynced(), 1);
+
+  sim_.Release(key_addr_A);
+  state_ = RunCycle();
+
+  SetHostSuspended(false);
+  state_ = RunCycle();
+
+  EXPECT_LED(key_addr_A, blue)
+      << "Resuming leaves LEDs that are already on alone";
+}
+
+TEST_F(IdleLEDsHostSuspend, StaysIdleAfterResumeIfTimedOut) {
+  SetHostSuspended(true);
+  state_ = RunCycle();
+
+  sim_.RunForMillis(IDLE_TIMEOUT_SECONDS * 1000);
+  state_ = RunCycle();
+
+  size_t idle_frames = MeasureFramesSynced();
+  EXPECT_EQ(idle_frames, 0);
+  RecordProperty("idle_frames_per_1000_cycles", idle_frames);
+
+  SetHostSuspended(false);
+  state_ = RunCycle();
+
+  EXPECT_LED(key_addr_A, off)
+      << "The LEDs stay off if the idle timeout expired during the suspend";
+  EXPECT_EQ(state_->LEDs()->FramesSynced(), 0);
+
+  sim_.Press(key_addr_A);
+  state_ = RunCycle();
+
+  EXPECT_LED(key_addr_A, blue) << "A keypress turns the LEDs back on";
+  EXPECT_EQ(state_->LEDs()->FramesSynced(), 1);
+
+  sim_.Release(key_addr_A);
+  state_ = RunCycle();
+}
+
+TEST_F(IdleLEDsHostSuspend, LeavesLEDsOnIfDisabled) {
+  ::IdleLEDs.setIdleTimeoutSeconds(0);
+  SetHostSuspended(true);
+  state_ = RunCycle();
+
+  EXPECT_LED(key_addr_A, blue)
+      << "A timeout of 0 keeps the LEDs on while suspended, too";
+
+  SetHostSuspended(false);
+  ::IdleLEDs.setIdleTimeoutSeconds(IDLE_TIMEOUT_SECONDS);
+  state_ = RunCycle();
+}
+
+TEST_F(IdleLEDsHostSuspend, LeavesLEDsOnIfAskedTo) {
+  ::IdleLEDs.off_while_suspended = false;
+  SetHostSuspended(true);
+  state_ = RunCycle();
+
+  EXPECT_LED(key_addr_A, blue)
+      << "The LEDs stay on while suspended, if so configured";
+
+  sim_.RunForMillis(IDLE_TIMEOUT_SECONDS * 1000);
+  state_ = RunCycle();
+
+  EXPECT_LED(key_addr_A, off)
+      << "The idle timeout still turns them off";
+
+  SetHostSuspended(false);
+  ::IdleLEDs.off_while_suspended = true;
+  sim_.Press(key_addr_A);
+  RunCycle();
+  sim_.Release(key_addr_A);
+  RunCycle();
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,123 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/setup-googletest.h"
+
+#include <Kaleidoscope-LEDControl.h>
+#include <Kaleidoscope-LED-Stalker.h>
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr cRGB green = CRGB(0, 128, 0);
+constexpr cRGB off = CRGB(0, 0, 0);
+
+// One step of the animation is 50ms, and the default `Haunt` effect fades out
+// in less than 40 steps.
+constexpr size_t measured_cycles = 1000;
+constexpr size_t fade_out_time = 2500;
+
+class LEDStalker : public VirtualDeviceTest {
+ protected:
+  // Taps the first `count` keys at once.
+  void TapKeys(uint8_t count) {
+    for (uint8_t i = 0; i < count; i++)
+      sim_.Press(KeyAddr(i));
+    state_ = RunCycle();
+
+    for (uint8_t i = 0; i < count; i++)
+      sim_.Release(KeyAddr(i));
+    state_ = RunCycle();
+
+    // LEDControl updates the LED mode once per sync interval.
+    sim_.RunForMillis(32);
+    for (uint8_t i = 0; i < count; i++)
+      EXPECT_LED(KeyAddr(i), green) << "Tapped keys light up";
+  }
+
+  // Runs `measured_cycles` cycles, and returns the number of LED writes done
+  // during them.
+  uint32_t MeasureLEDWrites() {
+    Runtime.device().ledDriver().resetCounters();
+    sim_.RunCycles(measured_cycles);
+    return Runtime.device().ledDriver().writeCount();
+  }
+
+  void ExpectFadeOut(uint8_t count) {
+    sim_.RunForMillis(fade_out_time);
+    state_ = RunCycle();
+
+    for (uint8_t i = 0; i < count; i++)
+      EXPECT_LED(KeyAddr(i), off) << "Tapped keys fade out";
+
+    EXPECT_EQ(MeasureLEDWrites(), 0)
+        << "Nothing is written once all keys faded out";
+  }
+
+  void MeasureFadingKeys(uint8_t count) {
+    TapKeys(count);
+
+    uint32_t writes = MeasureLEDWrites();
+    EXPECT_GT(writes, 0);
+    EXPECT_LE(writes, count * (measured_cycles / StalkerEffect.step_length))
+        << "Only the fading keys are written, at most once per step";
+    RecordProperty("led_writes_per_1000_cycles_" + std::to_string(count) +
+                   "_keys", writes);
+
+    ExpectFadeOut(count);
+  }
+
+  std::unique_ptr<State> state_ = nullptr;
+};
+
+TEST_F(LEDStalker, NoFadingKeys) {
+  state_ = RunCycle();
+
+  uint32_t writes = MeasureLEDWrites();
+  EXPECT_EQ(writes, 0) << "Nothing is written while no keys are fading";
+  RecordProperty("led_writes_per_1000_cycles_0_keys", writes);
+}
+
+TEST_F(LEDStalker, FiveFadingKeys) {
+  MeasureFadingKeys(5);
+}
+
+TEST_F(LEDStalker, ThirtyFadingKeys) {
+  MeasureFadingKeys(30);
+}
+
+TEST_F(LEDStalker, RefreshKeepsFadingColor) {
+  TapKeys(1);
+
+  // Pretend another plugin painted over the fading key.
+  ::LEDControl.setCrgbAt(KeyAddr(uint8_t(0)), off);
+  ::LEDControl.refreshAt(KeyAddr(uint8_t(0)));
+  EXPECT_GT(Runtime.device().getCrgbAt(KeyAddr(uint8_t(0))).g, 0)
+      << "Refreshing a fading key restores its fading color";
+
+  ::LEDControl.refreshAt(KeyAddr(uint8_t(1)));
+  EXPECT_LED(KeyAddr(uint8_t(1)), off)
+      << "Refreshing an inactive key restores the inactive color";
+
+  ExpectFadeOut(1);
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
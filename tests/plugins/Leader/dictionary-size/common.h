@@ -0,0 +1,35 @@
+// -*- mode: c++ -*-
+
+/* Kaleidoscope - Firmware for computer input devices
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <Kaleidoscope-Leader.h>
+
+namespace kaleidoscope {
+namespace testing {
+
+extern uint8_t last_seq_index;
+extern uint16_t action_count;
+
+// The dictionaries used by the test, with 16, 128, and 512 entries.
+extern const kaleidoscope::plugin::Leader::dictionary_t *dictionaries[];
+
+}
+}
@@ -0,0 +1,100 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Kaleidoscope.h>
+#include <Kaleidoscope-Leader.h>
+
+#include "./common.h"
+
+// *INDENT-OFF*
+KEYMAPS(
+    [0] = KEYMAP_STACKED
+    (
+        LEAD(0), Key_A, Key_B, Key_C, Key_D, Key_E, Key_F,
+        Key_G, Key_H, Key_X, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___,
+        ___,
+
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___,
+        ___
+    ),
+)
+// *INDENT-ON*
+
+KALEIDOSCOPE_INIT_PLUGINS(Leader);
+
+namespace kaleidoscope {
+namespace testing {
+
+uint8_t last_seq_index;
+uint16_t action_count;
+
+}
+}
+
+static void leaderAction(uint8_t seq_index) {
+  kaleidoscope::testing::last_seq_index = seq_index;
+  kaleidoscope::testing::action_count++;
+}
+
+// Every sequence of the leader key, followed by two or three keys out of `A`
+// to `H`, in alphabetical order.
+#define SEQ3(a, b, c) {LEADER_SEQ(LEAD(0), Key_ ## a, Key_ ## b, Key_ ## c), leaderAction}
+#define SEQ3_8(a, b)                                         \
+  SEQ3(a, b, A), SEQ3(a, b, B), SEQ3(a, b, C), SEQ3(a, b, D), \
+  SEQ3(a, b, E), SEQ3(a, b, F), SEQ3(a, b, G), SEQ3(a, b, H)
+#define SEQ3_64(a)                                         \
+  SEQ3_8(a, A), SEQ3_8(a, B), SEQ3_8(a, C), SEQ3_8(a, D),   \
+  SEQ3_8(a, E), SEQ3_8(a, F), SEQ3_8(a, G), SEQ3_8(a, H)
+
+// *INDENT-OFF*
+static const kaleidoscope::plugin::Leader::dictionary_t dictionary_16[] PROGMEM =
+  LEADER_DICT(SEQ3_8(A, A), SEQ3_8(A, B));
+
+static const kaleidoscope::plugin::Leader::dictionary_t dictionary_128[] PROGMEM =
+  LEADER_DICT(SEQ3_64(A), SEQ3_64(B));
+
+static const kaleidoscope::plugin::Leader::dictionary_t dictionary_512[] PROGMEM =
+  LEADER_DICT(SEQ3_64(A), SEQ3_64(B), SEQ3_64(C), SEQ3_64(D),
+              SEQ3_64(E), SEQ3_64(F), SEQ3_64(G), SEQ3_64(H));
+// *INDENT-ON*
+
+namespace kaleidoscope {
+namespace testing {
+
+const kaleidoscope::plugin::Leader::dictionary_t *dictionaries[] = {
+  dictionary_16,
+  dictionary_128,
+  dictionary_512,
+};
+
+}
+}
+
+void setup() {
+  Kaleidoscope.setup();
+  Leader.dictionary = dictionary_16;
+}
+
+void loop() {
+  Kaleidoscope.loop();
+}
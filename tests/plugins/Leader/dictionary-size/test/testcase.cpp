@@ -0,0 +1,104 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <initializer_list>
+
+#include "testing/setup-googletest.h"
+#include "testing/Benchmark.h"
+
+#include "../common.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_LEAD{0, 0};
+constexpr KeyAddr key_addr_A{0, 1};
+constexpr KeyAddr key_addr_B{0, 2};
+constexpr KeyAddr key_addr_H{1, 1};
+constexpr KeyAddr key_addr_X{1, 2};
+
+constexpr size_t benchmark_rounds = 500;
+
+class LeaderDictionarySize : public VirtualDeviceTest {
+ protected:
+  void Tap(KeyAddr key_addr) {
+    sim_.Press(key_addr);
+    sim_.RunCycle();
+    sim_.Release(key_addr);
+    sim_.RunCycle();
+  }
+
+  void TapSequence(std::initializer_list<KeyAddr> sequence) {
+    for (KeyAddr key_addr : sequence)
+      Tap(key_addr);
+  }
+
+  void UseDictionary(uint8_t index) {
+    Leader.dictionary = dictionaries[index];
+    Leader.reset();
+    action_count = 0;
+  }
+
+  void CheckAndBenchmark(uint8_t dictionary_index, uint16_t entries,
+                         std::initializer_list<KeyAddr> last_sequence) {
+    UseDictionary(dictionary_index);
+
+    TapSequence(last_sequence);
+    EXPECT_EQ(action_count, 1)
+        << "The last sequence of the dictionary triggers its action";
+    EXPECT_EQ(last_seq_index, uint8_t(entries - 1))
+        << "The action receives the index of the sequence";
+
+    TapSequence({key_addr_LEAD, key_addr_X, key_addr_A});
+    EXPECT_EQ(action_count, 1)
+        << "A key not in the dictionary aborts the sequence";
+
+    // Typing the last sequence over and over, through the whole firmware.
+    Benchmark benchmark(sim_);
+    benchmark.Start();
+    for (size_t i = 0; i < benchmark_rounds; i++) {
+      for (KeyAddr key_addr : last_sequence) {
+        benchmark.Press(key_addr);
+        benchmark.RunCycle();
+        benchmark.Release(key_addr);
+        benchmark.RunCycle();
+      }
+    }
+    benchmark.Finish();
+
+    EXPECT_EQ(action_count, 1 + benchmark_rounds)
+        << "The sequence triggers its action every time";
+  }
+};
+
+TEST_F(LeaderDictionarySize, Entries16) {
+  CheckAndBenchmark(0, 16, {key_addr_LEAD, key_addr_A, key_addr_B, key_addr_H});
+}
+
+TEST_F(LeaderDictionarySize, Entries128) {
+  CheckAndBenchmark(1, 128, {key_addr_LEAD, key_addr_B, key_addr_H, key_addr_H});
+}
+
+TEST_F(LeaderDictionarySize, Entries512) {
+  CheckAndBenchmark(2, 512, {key_addr_LEAD, key_addr_H, key_addr_H, key_addr_H});
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
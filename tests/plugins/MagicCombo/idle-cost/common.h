@@ -0,0 +1,47 @@
+// -*- mode: c++ -*-
+
+/* Kaleidoscope - Firmware for computer input devices
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <Kaleidoscope-MagicCombo.h>
+
+namespace kaleidoscope {
+namespace testing {
+
+extern uint8_t last_combo_index;
+extern uint16_t combo_count;
+
+// Swallows the keyswitch events of `addr`, the way plugins such as Leader do
+// with the keys they hold back.
+class KeyswitchEventSwallower : public kaleidoscope::Plugin {
+ public:
+  KeyAddr addr = KeyAddr::none();
+
+  EventHandlerResult onKeyswitchEvent(KeyEvent &event) {
+    if (event.addr == addr)
+      return EventHandlerResult::ABORT;
+    return EventHandlerResult::OK;
+  }
+};
+
+extern KeyswitchEventSwallower Swallower;
+
+}  // namespace testing
+}  // namespace kaleidoscope
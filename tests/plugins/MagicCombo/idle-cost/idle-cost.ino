@@ -0,0 +1,124 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Kaleidoscope.h>
+#include <Kaleidoscope-MagicCombo.h>
+
+#include "./common.h"
+
+// *INDENT-OFF*
+KEYMAPS(
+    [0] = KEYMAP_STACKED
+    (
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___,
+        ___,
+
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___,
+        ___
+    ),
+)
+// *INDENT-ON*
+
+namespace kaleidoscope {
+namespace testing {
+
+uint8_t last_combo_index;
+uint16_t combo_count;
+KeyswitchEventSwallower Swallower;
+
+}
+}
+
+void comboAction(uint8_t combo_index) {
+  kaleidoscope::testing::last_combo_index = combo_index;
+  kaleidoscope::testing::combo_count++;
+}
+
+// Every pair of one of the first five keys of the first row, and one of the
+// first ten keys of the second.
+// *INDENT-OFF*
+USE_MAGIC_COMBOS(
+                 {.action = comboAction, .keys = {R0C0, R1C0}},
+                 {.action = comboAction, .keys = {R0C0, R1C1}},
+                 {.action = comboAction, .keys = {R0C0, R1C2}},
+                 {.action = comboAction, .keys = {R0C0, R1C3}},
+                 {.action = comboAction, .keys = {R0C0, R1C4}},
+                 {.action = comboAction, .keys = {R0C0, R1C5}},
+                 {.action = comboAction, .keys = {R0C0, R1C6}},
+                 {.action = comboAction, .keys = {R0C0, R1C7}},
+                 {.action = comboAction, .keys = {R0C0, R1C8}},
+                 {.action = comboAction, .keys = {R0C0, R1C9}},
+                 {.action = comboAction, .keys = {R0C1, R1C0}},
+                 {.action = comboAction, .keys = {R0C1, R1C1}},
+                 {.action = comboAction, .keys = {R0C1, R1C2}},
+                 {.action = comboAction, .keys = {R0C1, R1C3}},
+                 {.action = comboAction, .keys = {R0C1, R1C4}},
+                 {.action = comboAction, .keys = {R0C1, R1C5}},
+                 {.action = comboAction, .keys = {R0C1, R1C6}},
+                 {.action = comboAction, .keys = {R0C1, R1C7}},
+                 {.action = comboAction, .keys = {R0C1, R1C8}},
+                 {.action = comboAction, .keys = {R0C1, R1C9}},
+                 {.action = comboAction, .keys = {R0C2, R1C0}},
+                 {.action = comboAction, .keys = {R0C2, R1C1}},
+                 {.action = comboAction, .keys = {R0C2, R1C2}},
+                 {.action = comboAction, .keys = {R0C2, R1C3}},
+                 {.action = comboAction, .keys = {R0C2, R1C4}},
+                 {.action = comboAction, .keys = {R0C2, R1C5}},
+                 {.action = comboAction, .keys = {R0C2, R1C6}},
+                 {.action = comboAction, .keys = {R0C2, R1C7}},
+                 {.action = comboAction, .keys = {R0C2, R1C8}},
+                 {.action = comboAction, .keys = {R0C2, R1C9}},
+                 {.action = comboAction, .keys = {R0C3, R1C0}},
+                 {.action = comboAction, .keys = {R0C3, R1C1}},
+                 {.action = comboAction, .keys = {R0C3, R1C2}},
+                 {.action = comboAction, .keys = {R0C3, R1C3}},
+                 {.action = comboAction, .keys = {R0C3, R1C4}},
+                 {.action = comboAction, .keys = {R0C3, R1C5}},
+                 {.action = comboAction, .keys = {R0C3, R1C6}},
+                 {.action = comboAction, .keys = {R0C3, R1C7}},
+                 {.action = comboAction, .keys = {R0C3, R1C8}},
+                 {.action = comboAction, .keys = {R0C3, R1C9}},
+                 {.action = comboAction, .keys = {R0C4, R1C0}},
+                 {.action = comboAction, .keys = {R0C4, R1C1}},
+                 {.action = comboAction, .keys = {R0C4, R1C2}},
+                 {.action = comboAction, .keys = {R0C4, R1C3}},
+                 {.action = comboAction, .keys = {R0C4, R1C4}},
+                 {.action = comboAction, .keys = {R0C4, R1C5}},
+                 {.action = comboAction, .keys = {R0C4, R1C6}},
+                 {.action = comboAction, .keys = {R0C4, R1C7}},
+                 {.action = comboAction, .keys = {R0C4, R1C8}},
+                 {.action = comboAction, .keys = {R0C4, R1C9}}
+);
+// *INDENT-ON*
+
+KALEIDOSCOPE_INIT_PLUGINS(kaleidoscope::testing::Swallower, MagicCombo);
+
+void setup() {
+  Kaleidoscope.setup();
+  MagicCombo.min_interval = 20;
+}
+
+void loop() {
+  Kaleidoscope.loop();
+}
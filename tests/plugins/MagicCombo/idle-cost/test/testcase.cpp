@@ -0,0 +1,131 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/setup-googletest.h"
+#include "testing/Benchmark.h"
+
+#include "../common.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_R0C0{0, 0};
+constexpr KeyAddr key_addr_R0C4{0, 4};
+constexpr KeyAddr key_addr_R1C0{1, 0};
+constexpr KeyAddr key_addr_R1C1{1, 1};
+constexpr KeyAddr key_addr_R1C9{1, 9};
+
+constexpr size_t benchmark_cycles = 10000;
+
+class MagicComboIdleCost : public VirtualDeviceTest {
+ protected:
+  void SetUp() override {
+    VirtualDeviceTest::SetUp();
+    combo_count = 0;
+    Swallower.addr = KeyAddr::none();
+  }
+};
+
+TEST_F(MagicComboIdleCost, IdleCycles) {
+  sim_.RunForMillis(100);
+
+  // Idle cycles, then cycles with a key held that is part of combos, but
+  // doesn't complete any.
+  Benchmark benchmark(sim_);
+  benchmark.Start();
+  benchmark.RunCycles(benchmark_cycles);
+  benchmark.Press(key_addr_R0C0);
+  benchmark.RunCycles(benchmark_cycles);
+  benchmark.Release(key_addr_R0C0);
+  benchmark.RunCycle();
+  benchmark.Finish();
+
+  EXPECT_EQ(combo_count, 0);
+}
+
+TEST_F(MagicComboIdleCost, LastComboRepeats) {
+  sim_.RunForMillis(100);
+
+  sim_.Press(key_addr_R0C4);
+  sim_.Press(key_addr_R1C9);
+  sim_.RunCycle();
+
+  EXPECT_EQ(combo_count, 1) << "The combo fires as soon as it is held";
+  EXPECT_EQ(last_combo_index, 49) << "The action gets the index of the combo";
+
+  sim_.RunForMillis(50);
+  EXPECT_EQ(combo_count, 3)
+      << "The combo fires again every `min_interval` while held";
+
+  sim_.Release(key_addr_R1C9);
+  sim_.RunForMillis(50);
+  EXPECT_EQ(combo_count, 3) << "The combo stops firing once released";
+
+  sim_.Release(key_addr_R0C4);
+  sim_.RunCycle();
+}
+
+TEST_F(MagicComboIdleCost, ExtraKeyPreventsCombo) {
+  sim_.RunForMillis(100);
+
+  sim_.Press(key_addr_R0C0);
+  sim_.Press(key_addr_R1C0);
+  sim_.Press(key_addr_R1C1);
+  sim_.RunForMillis(50);
+
+  EXPECT_EQ(combo_count, 0)
+      << "Holding more keys than a combo has does not trigger it";
+
+  sim_.Release(key_addr_R1C1);
+  sim_.RunCycle();
+
+  EXPECT_EQ(combo_count, 1)
+      << "Releasing the extra key triggers the combo";
+  EXPECT_EQ(last_combo_index, 0);
+
+  sim_.Release(key_addr_R0C0);
+  sim_.Release(key_addr_R1C0);
+  sim_.RunCycle();
+}
+
+TEST_F(MagicComboIdleCost, SwallowedPressCompletesCombo) {
+  sim_.RunForMillis(100);
+
+  Swallower.addr = key_addr_R1C9;
+  sim_.Press(key_addr_R0C4);
+  sim_.RunCycle();
+  sim_.Press(key_addr_R1C9);
+  sim_.RunCycle();
+
+  EXPECT_EQ(combo_count, 1)
+      << "A press that an earlier plugin swallowed still completes the combo";
+  EXPECT_EQ(last_combo_index, 49);
+
+  sim_.Release(key_addr_R1C9);
+  sim_.RunForMillis(50);
+  EXPECT_EQ(combo_count, 1)
+      << "A swallowed release still ends the combo";
+
+  sim_.Release(key_addr_R0C4);
+  sim_.RunCycle();
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
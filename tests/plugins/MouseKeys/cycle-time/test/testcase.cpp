@@ -0,0 +1,227 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <vector>
+
+#include "testing/setup-googletest.h"
+#include "testing/Benchmark.h"
+
+#include "Kaleidoscope-MouseKeys.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_mouseR{0, 0};
+constexpr KeyAddr key_addr_mouseDn{0, 1};
+constexpr KeyAddr key_addr_mouseUpL{0, 2};
+constexpr KeyAddr key_addr_mouseScrollDn{0, 3};
+
+constexpr size_t benchmark_cycles = 10000;
+
+struct Displacement {
+  int x = 0;
+  int y = 0;
+  int wheel = 0;
+  size_t reports = 0;
+};
+
+// A key press or release, `time` milliseconds into a `Play()`.
+struct Step {
+  uint32_t time;
+  KeyAddr key_addr;
+  bool press;
+};
+
+// The same steps, at the start of the first cycle that would see them, if
+// cycles took `cycle_time` milliseconds.
+std::vector<Step> SeenAt(std::vector<Step> steps, uint8_t cycle_time) {
+  for (Step &step : steps)
+    step.time = (step.time + cycle_time - 1) / cycle_time * cycle_time;
+  return steps;
+}
+
+class MouseKeysCycleTime : public VirtualDeviceTest {
+ protected:
+  void SetUp() override {
+    VirtualDeviceTest::SetUp();
+    MouseKeys.speed = 1;
+    MouseKeys.speedDelay = 1;
+    MouseKeys.accelSpeed = 1;
+    MouseKeys.accelDelay = 64;
+  }
+
+  // Holds the key at `key_addr` for `duration` milliseconds, with each cycle
+  // taking `cycle_time` milliseconds, and adds up the movement in the mouse
+  // reports sent in the meantime.
+  Displacement Hold(KeyAddr key_addr, uint8_t cycle_time, uint32_t duration) {
+    ClearState();
+    sim_.SetCycleTime(cycle_time);
+
+    sim_.Press(key_addr);
+    sim_.RunCycle();
+    uint32_t start = Runtime.millisAtCycleStart();
+    while (Runtime.millisAtCycleStart() - start + cycle_time < duration)
+      sim_.RunCycle();
+
+    sim_.Release(key_addr);
+    sim_.RunCycle();
+    EXPECT_EQ(Runtime.millisAtCycleStart() - start, duration)
+        << "The duration is a multiple of the cycle time";
+    sim_.SetCycleTime(1);
+
+    return Sum();
+  }
+
+  // Plays `steps`, with each cycle taking `cycle_time` milliseconds, until
+  // `end`, and adds up the movement in the mouse reports sent in the meantime.
+  // Like on a real keyboard, a key change is only seen by the first cycle that
+  // starts at or after its time.
+  Displacement Play(const std::vector<Step> &steps, uint8_t cycle_time, uint32_t end) {
+    ClearState();
+    sim_.SetCycleTime(cycle_time);
+
+    sim_.RunCycle();
+    uint32_t start = Runtime.millisAtCycleStart();
+    auto step = steps.begin();
+    while (Runtime.millisAtCycleStart() - start < end) {
+      uint32_t next_cycle = Runtime.millisAtCycleStart() - start + cycle_time;
+      for (; step != steps.end() && step->time <= next_cycle; ++step) {
+        if (step->press)
+          sim_.Press(step->key_addr);
+        else
+          sim_.Release(step->key_addr);
+      }
+      sim_.RunCycle();
+    }
+    sim_.SetCycleTime(1);
+
+    return Sum();
+  }
+
+  Displacement Sum() {
+    LoadState();
+    Displacement result;
+    for (const MouseReport &report : HIDReports()->Mouse()) {
+      EXPECT_TRUE(report.XAxis() != 0 || report.YAxis() != 0 || report.VWheel() != 0)
+          << "Mouse reports are only sent when the cursor or the wheel moves";
+      result.x += report.XAxis();
+      result.y += report.YAxis();
+      result.wheel += report.VWheel();
+    }
+    result.reports = HIDReports()->Mouse().size();
+    return result;
+  }
+};
+
+TEST_F(MouseKeysCycleTime, IdleCycles) {
+  Displacement d = Hold(key_addr_mouseR, 1, 100);
+  EXPECT_GT(d.x, 0);
+  d = Hold(key_addr_mouseScrollDn, 1, 100);
+  EXPECT_EQ(d.wheel, -2)
+      << "The wheel scrolls right away, then every `wheelDelay` milliseconds";
+
+  // Idle cycles, after the mouse keys have been used.
+  Benchmark benchmark(sim_);
+  benchmark.Start();
+  benchmark.RunCycles(benchmark_cycles);
+  benchmark.Finish();
+
+  EXPECT_EQ(benchmark.MouseReports(), 0)
+      << "No mouse reports are sent while no mouse keys are held";
+}
+
+TEST_F(MouseKeysCycleTime, SubpixelMovement) {
+  MouseKeys.accelSpeed = 0;
+
+  // At the default speed, the cursor moves 1/16th of a pixel each
+  // millisecond, plus one step right away.
+  Displacement d = Hold(key_addr_mouseR, 1, 160);
+  EXPECT_EQ(d.x, 10);
+  EXPECT_EQ(d.y, 0);
+  EXPECT_EQ(d.reports, 10)
+      << "One report is sent each time the cursor crosses a whole pixel";
+}
+
+TEST_F(MouseKeysCycleTime, TrajectoryIndependentOfCycleTime) {
+  MouseKeys.accelDelay = 5;
+
+  Displacement reference = Hold(key_addr_mouseDn, 1, 420);
+  EXPECT_EQ(reference.x, 0);
+  EXPECT_GT(reference.y, 420 / 16)
+      << "The cursor accelerates while the key is held";
+
+  for (uint8_t cycle_time : {3, 7, 20}) {
+    Displacement d = Hold(key_addr_mouseDn, cycle_time, 420);
+    EXPECT_EQ(d.x, reference.x) << "cycle time: " << int(cycle_time);
+    EXPECT_EQ(d.y, reference.y) << "cycle time: " << int(cycle_time);
+    EXPECT_LT(d.reports, reference.reports)
+        << "Slower cycles send fewer, bigger reports";
+  }
+}
+
+TEST_F(MouseKeysCycleTime, DiagonalTrajectory) {
+  MouseKeys.accelDelay = 5;
+
+  Displacement reference = Hold(key_addr_mouseUpL, 1, 420);
+  EXPECT_EQ(reference.x, reference.y);
+  EXPECT_LT(reference.x, 0);
+
+  Displacement d = Hold(key_addr_mouseUpL, 7, 420);
+  EXPECT_EQ(d.x, reference.x);
+  EXPECT_EQ(d.y, reference.y);
+}
+
+TEST_F(MouseKeysCycleTime, ReleaseBetweenCycles) {
+  MouseKeys.accelDelay = 5;
+  const std::vector<Step> steps = {
+    {1, key_addr_mouseDn, true},
+    {100, key_addr_mouseDn, false},
+  };
+
+  for (uint8_t cycle_time : {3, 7, 20}) {
+    Displacement reference = Play(SeenAt(steps, cycle_time), 1, 140);
+    Displacement d = Play(steps, cycle_time, 140);
+    EXPECT_GT(d.y, 0);
+    EXPECT_EQ(d.y, reference.y)
+        << "The cursor moves until the cycle that sees the release, cycle time: "
+        << int(cycle_time);
+  }
+}
+
+TEST_F(MouseKeysCycleTime, DirectionChangeBetweenCycles) {
+  MouseKeys.accelDelay = 5;
+  const std::vector<Step> steps = {
+    {1, key_addr_mouseDn, true},
+    {50, key_addr_mouseR, true},
+    {130, key_addr_mouseDn, false},
+    {200, key_addr_mouseR, false},
+  };
+
+  for (uint8_t cycle_time : {3, 7, 20}) {
+    Displacement reference = Play(SeenAt(steps, cycle_time), 1, 420);
+    Displacement d = Play(steps, cycle_time, 420);
+    EXPECT_EQ(d.x, reference.x) << "cycle time: " << int(cycle_time);
+    EXPECT_EQ(d.y, reference.y) << "cycle time: " << int(cycle_time);
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
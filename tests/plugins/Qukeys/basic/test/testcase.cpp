@@ -215,6 +215,22 @@ TEST_F(QukeysBasic, RolloverPrimary) {
   ASSERT_EQ(state_->HIDReports()->Keyboard().size(), 0);
 }
 
+TEST_F(QukeysBasic, TapsAcrossEventIdWraparound) {
+  // Event IDs are a single byte, so they wrap around every 256 events, which
+  // must not cost any of the taps.
+  ClearState();
+  for (int i = 0; i < 200; i++) {
+    sim_.Press(key_addr_A);
+    sim_.RunForMillis(20);
+    sim_.Release(key_addr_A);
+    sim_.RunForMillis(20);
+  }
+  state_ = RunCycle();
+
+  ASSERT_EQ(state_->HIDReports()->Keyboard().size(), 400)
+      << "Every tap of the qukey should be reported, in two reports";
+}
+
 }  // namespace
 }  // namespace testing
 }  // namespace kaleidoscope
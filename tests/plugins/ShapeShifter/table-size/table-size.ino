@@ -0,0 +1,91 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Kaleidoscope.h>
+#include <Kaleidoscope-ShapeShifter.h>
+
+#include "./common.h"
+
+// *INDENT-OFF*
+KEYMAPS(
+    [0] = KEYMAP_STACKED
+    (
+        Key_1, Key_2, Key_3, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        Key_LeftShift, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___,
+        ___,
+
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___,
+        ___
+    ),
+)
+// *INDENT-ON*
+
+// Tables of keys with consecutive keycodes, starting with `Key_Keypad8`, all of
+// which turn into `A` when shifted.
+#define SHIFT_TO_A(n)  {Key(Key_Keypad8.getKeyCode() + n, KEY_FLAGS), Key_A}
+#define SHIFT_TO_A_4(n)                                             \
+  SHIFT_TO_A(n), SHIFT_TO_A(n + 1), SHIFT_TO_A(n + 2), SHIFT_TO_A(n + 3)
+#define SHIFT_TO_A_16(n)                                            \
+  SHIFT_TO_A_4(n), SHIFT_TO_A_4(n + 4), SHIFT_TO_A_4(n + 8), SHIFT_TO_A_4(n + 12)
+#define SHIFT_TO_A_32(n)                                            \
+  SHIFT_TO_A_16(n), SHIFT_TO_A_16(n + 16)
+
+// *INDENT-OFF*
+static const kaleidoscope::plugin::ShapeShifter::dictionary_t dictionary_4[] PROGMEM = {
+  SHIFT_TO_A_4(0),
+  {Key_NoKey, Key_NoKey},
+};
+
+static const kaleidoscope::plugin::ShapeShifter::dictionary_t dictionary_32[] PROGMEM = {
+  SHIFT_TO_A_32(0),
+  {Key_NoKey, Key_NoKey},
+};
+
+static const kaleidoscope::plugin::ShapeShifter::dictionary_t dictionary_128[] PROGMEM = {
+  SHIFT_TO_A_32(0), SHIFT_TO_A_32(32), SHIFT_TO_A_32(64), SHIFT_TO_A_32(96),
+  {Key_NoKey, Key_NoKey},
+};
+// *INDENT-ON*
+
+namespace kaleidoscope {
+namespace testing {
+
+const kaleidoscope::plugin::ShapeShifter::dictionary_t *dictionaries[] = {
+  dictionary_4,
+  dictionary_32,
+  dictionary_128,
+};
+
+}
+}
+
+KALEIDOSCOPE_INIT_PLUGINS(ShapeShifter);
+
+void setup() {
+  Kaleidoscope.setup();
+  ShapeShifter.dictionary = dictionary_4;
+}
+
+void loop() {
+  Kaleidoscope.loop();
+}
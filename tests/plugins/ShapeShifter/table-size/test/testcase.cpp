@@ -0,0 +1,85 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/setup-googletest.h"
+#include "testing/Benchmark.h"
+
+#include "../common.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_LeftShift{2, 0};
+constexpr KeyAddr key_addr_X{1, 0};
+constexpr KeyAddr key_addr_1{0, 0};
+
+constexpr size_t benchmark_rounds = 1000;
+
+class ShapeShifterTableSize : public VirtualDeviceTest {
+ protected:
+  void CheckAndBenchmark(uint8_t dictionary_index, uint8_t entries) {
+    ShapeShifter.dictionary = dictionaries[dictionary_index];
+
+    // Tapping a key that isn't in the dictionary, through the whole firmware.
+    Benchmark benchmark(sim_);
+    benchmark.Start();
+    for (size_t i = 0; i < benchmark_rounds; i++) {
+      benchmark.Press(key_addr_1);
+      benchmark.RunCycle();
+      benchmark.Release(key_addr_1);
+      benchmark.RunCycle();
+    }
+    benchmark.Finish();
+
+    sim_.Press(key_addr_LeftShift);
+    sim_.RunCycle();
+
+    Key last = Key(Key_Keypad8.getKeyCode() + entries - 1, KEY_FLAGS);
+    KeyEvent event = KeyEvent::next(key_addr_X, IS_PRESSED);
+    event.key = last;
+    ShapeShifter.onKeyEvent(event);
+    EXPECT_EQ(event.key, Key_A)
+        << "The last key of the dictionary is replaced while shifted";
+
+    event = KeyEvent::next(key_addr_X, IS_PRESSED);
+    event.key = Key_B;
+    ShapeShifter.onKeyEvent(event);
+    EXPECT_EQ(event.key, Key_B)
+        << "Keys not in the dictionary are left alone";
+
+    sim_.Release(key_addr_LeftShift);
+    sim_.RunCycle();
+  }
+};
+
+TEST_F(ShapeShifterTableSize, Entries4) {
+  CheckAndBenchmark(0, 4);
+}
+
+TEST_F(ShapeShifterTableSize, Entries32) {
+  CheckAndBenchmark(1, 32);
+}
+
+TEST_F(ShapeShifterTableSize, Entries128) {
+  CheckAndBenchmark(2, 128);
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,83 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Kaleidoscope.h>
+#include <Kaleidoscope-SpaceCadet.h>
+
+#include "./common.h"
+
+// *INDENT-OFF*
+KEYMAPS(
+    [0] = KEYMAP_STACKED
+    (
+        Key_LeftShift, Key_RightShift, Key_RightGui, ___, ___, ___, ___,
+        Key_A, Key_B, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___,
+        ___,
+
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___,
+        ___
+    ),
+)
+// *INDENT-ON*
+
+KALEIDOSCOPE_INIT_PLUGINS(SpaceCadet);
+
+namespace kaleidoscope {
+namespace testing {
+
+kaleidoscope::plugin::SpaceCadet::KeyBinding map_4[4 + 1];
+kaleidoscope::plugin::SpaceCadet::KeyBinding map_32[32 + 1];
+kaleidoscope::plugin::SpaceCadet::KeyBinding map_128[128 + 1];
+
+kaleidoscope::plugin::SpaceCadet::KeyBinding *maps[] = {
+  map_4,
+  map_32,
+  map_128,
+};
+
+// Fills `map` with keys of consecutive keycodes, starting with `Key_Keypad8`,
+// all of which turn into `A` when tapped.
+void fillMap(kaleidoscope::plugin::SpaceCadet::KeyBinding *map, uint8_t size) {
+  for (uint8_t i = 0; i < size; i++) {
+    map[i] = {Key(Key_Keypad8.getKeyCode() + i, KEY_FLAGS), Key_A, 0};
+  }
+  map[size] = SPACECADET_MAP_END;
+}
+
+}
+}
+
+void setup() {
+  Kaleidoscope.setup();
+
+  kaleidoscope::testing::fillMap(kaleidoscope::testing::map_4, 4);
+  kaleidoscope::testing::fillMap(kaleidoscope::testing::map_32, 32);
+  kaleidoscope::testing::fillMap(kaleidoscope::testing::map_128, 128);
+
+  SpaceCadet.map = kaleidoscope::testing::map_4;
+  SpaceCadet.time_out = 20;
+}
+
+void loop() {
+  Kaleidoscope.loop();
+}
@@ -0,0 +1,77 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/setup-googletest.h"
+#include "testing/Benchmark.h"
+
+#include "../common.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_X{1, 0};
+
+constexpr size_t benchmark_rounds = 1000;
+
+class SpaceCadetTableSize : public VirtualDeviceTest {
+ protected:
+  void CheckAndBenchmark(uint8_t map_index, uint8_t entries) {
+    SpaceCadet.map = maps[map_index];
+
+    // Tapping a key that isn't in the map, through the whole firmware.
+    Benchmark benchmark(sim_);
+    benchmark.Start();
+    for (size_t i = 0; i < benchmark_rounds; i++) {
+      benchmark.Press(key_addr_X);
+      benchmark.RunCycle();
+      benchmark.Release(key_addr_X);
+      benchmark.RunCycle();
+    }
+    benchmark.Finish();
+
+    KeyEvent event = KeyEvent::next(key_addr_X, IS_PRESSED);
+    event.key = Key_B;
+    EXPECT_EQ(SpaceCadet.onKeyswitchEvent(event), EventHandlerResult::OK)
+        << "Keys not in the map are let through";
+
+    event = KeyEvent::next(key_addr_X, IS_PRESSED);
+    event.key = Key(Key_Keypad8.getKeyCode() + entries - 1, KEY_FLAGS);
+    EXPECT_EQ(SpaceCadet.onKeyswitchEvent(event), EventHandlerResult::ABORT)
+        << "The last key of the map is held back until it is resolved";
+
+    // Let the pending key time out, so the next test starts from scratch.
+    sim_.RunForMillis(50);
+  }
+};
+
+TEST_F(SpaceCadetTableSize, Entries4) {
+  CheckAndBenchmark(0, 4);
+}
+
+TEST_F(SpaceCadetTableSize, Entries32) {
+  CheckAndBenchmark(1, 32);
+}
+
+TEST_F(SpaceCadetTableSize, Entries128) {
+  CheckAndBenchmark(2, 128);
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
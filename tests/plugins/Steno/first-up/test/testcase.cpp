@@ -0,0 +1,168 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <vector>
+
+#include "testing/setup-googletest.h"
+
+#include "Kaleidoscope-Steno.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_S1{0, 0};
+constexpr KeyAddr key_addr_TL{0, 1};
+constexpr KeyAddr key_addr_KL{0, 2};
+constexpr KeyAddr key_addr_PL{0, 3};
+
+using Packet = std::vector<uint8_t>;
+
+// The packets of `S1` + `TL`, `KL` + `PL`, and all four keys together.
+const Packet packet_S1_TL{0x80, 0x40 | 0x10, 0, 0, 0, 0};
+const Packet packet_KL_PL{0x80, 0x08 | 0x04, 0, 0, 0, 0};
+const Packet packet_all{0x80, 0x40 | 0x10 | 0x08 | 0x04, 0, 0, 0, 0};
+
+std::vector<Packet> packets;
+std::vector<uint32_t> packet_times;
+bool transport_ready;
+
+bool testTransport(const uint8_t *packet, uint8_t size) {
+  if (!transport_ready)
+    return false;
+
+  packets.emplace_back(packet, packet + size);
+  packet_times.push_back(Runtime.millisAtCycleStart());
+  return true;
+}
+
+class GeminiPRStrokes : public VirtualDeviceTest {
+ protected:
+  void SetUp() override {
+    VirtualDeviceTest::SetUp();
+    GeminiPR.transport = testTransport;
+    transport_ready = true;
+    packets.clear();
+    packet_times.clear();
+    release_times_.clear();
+  }
+
+  void TearDown() override {
+    GeminiPR.stroke_mode = plugin::steno::GeminiPR::StrokeMode::ALL_UP;
+    GeminiPR.transport = plugin::steno::GeminiPR::serialTransport;
+    VirtualDeviceTest::TearDown();
+  }
+
+  void PressStroke(uint8_t stroke) {
+    sim_.Press(stroke % 2 ? key_addr_KL : key_addr_S1);
+    sim_.Press(stroke % 2 ? key_addr_PL : key_addr_TL);
+    sim_.RunCycle();
+  }
+
+  // Types `count` strokes, alternating between `S1` + `TL` and `KL` + `PL`, each
+  // one started before the last key of the previous one is released, as in
+  // fast steno writing. Records the time each stroke's first key is released.
+  void RollStrokes(uint8_t count) {
+    PressStroke(0);
+    for (uint8_t stroke = 0; stroke < count; stroke++) {
+      sim_.RunForMillis(20);
+
+      sim_.Release(stroke % 2 ? key_addr_KL : key_addr_S1);
+      sim_.RunCycle();
+      release_times_.push_back(Runtime.millisAtCycleStart());
+      sim_.RunForMillis(5);
+
+      if (stroke + 1 < count)
+        PressStroke(stroke + 1);
+      sim_.RunForMillis(5);
+
+      sim_.Release(stroke % 2 ? key_addr_PL : key_addr_TL);
+      sim_.RunCycle();
+    }
+    sim_.RunForMillis(10);
+  }
+
+  std::vector<uint32_t> release_times_;
+};
+
+TEST_F(GeminiPRStrokes, AllUpMergesOverlappingStrokes) {
+  RollStrokes(2);
+
+  ASSERT_EQ(packets.size(), 1)
+      << "Strokes that overlap are sent as a single one";
+  EXPECT_EQ(packets[0], packet_all);
+}
+
+TEST_F(GeminiPRStrokes, FirstUpSendsEachStroke) {
+  GeminiPR.stroke_mode = plugin::steno::GeminiPR::StrokeMode::FIRST_UP;
+  RollStrokes(2);
+
+  ASSERT_EQ(packets.size(), 2);
+  EXPECT_EQ(packets[0], packet_S1_TL);
+  EXPECT_EQ(packets[1], packet_KL_PL)
+      << "Keys still held from the previous stroke are not part of the next one";
+}
+
+TEST_F(GeminiPRStrokes, StrokeToEmitLatency) {
+  constexpr uint8_t strokes = 20;
+
+  RollStrokes(strokes);
+  ASSERT_EQ(packets.size(), 1);
+  RecordProperty("msec_first_up_to_emit_all_up",
+                 std::to_string(packet_times[0] - release_times_[0]));
+
+  packets.clear();
+  packet_times.clear();
+  release_times_.clear();
+
+  GeminiPR.stroke_mode = plugin::steno::GeminiPR::StrokeMode::FIRST_UP;
+  RollStrokes(strokes);
+  ASSERT_EQ(packets.size(), strokes);
+
+  uint32_t total_latency = 0;
+  for (uint8_t stroke = 0; stroke < strokes; stroke++) {
+    EXPECT_EQ(packets[stroke], stroke % 2 ? packet_KL_PL : packet_S1_TL);
+    EXPECT_EQ(packet_times[stroke], release_times_[stroke])
+        << "Each stroke is sent in the cycle its first key is released";
+    total_latency += packet_times[stroke] - release_times_[stroke];
+  }
+  RecordProperty("msec_first_up_to_emit_first_up",
+                 std::to_string(total_latency / strokes));
+}
+
+TEST_F(GeminiPRStrokes, BusyTransportQueuesStrokes) {
+  GeminiPR.stroke_mode = plugin::steno::GeminiPR::StrokeMode::FIRST_UP;
+  transport_ready = false;
+  RollStrokes(2);
+
+  EXPECT_TRUE(packets.empty())
+      << "Strokes are held back while the transport is busy";
+
+  transport_ready = true;
+  sim_.RunCycle();
+
+  ASSERT_EQ(packets.size(), 2)
+      << "Waiting strokes are sent, in order, once the transport is ready";
+  EXPECT_EQ(packets[0], packet_S1_TL);
+  EXPECT_EQ(packets[1], packet_KL_PL);
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
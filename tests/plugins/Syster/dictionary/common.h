@@ -0,0 +1,37 @@
+// -*- mode: c++ -*-
+
+/* Kaleidoscope - Firmware for computer input devices
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <Kaleidoscope-Syster.h>
+
+namespace kaleidoscope {
+namespace testing {
+
+extern uint8_t last_symbol_index;
+extern uint16_t action_count;
+
+// The last symbol that was handed to `systerAction()`, because it was not in
+// the dictionary.
+extern char fallback_symbol[SYSTER_MAX_SYMBOL_LENGTH + 1];
+extern uint16_t fallback_count;
+
+}
+}
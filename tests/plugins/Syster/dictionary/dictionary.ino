@@ -0,0 +1,81 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <Kaleidoscope.h>
+#include <Kaleidoscope-Syster.h>
+
+#include "./common.h"
+
+// *INDENT-OFF*
+KEYMAPS(
+    [0] = KEYMAP_STACKED
+    (
+        SYSTER, Key_A, Key_B, Key_C, Key_E, Key_F, Key_O,
+        Key_T, Key_X, ___, ___, ___, ___, ___,
+        Key_Spacebar, Key_Backspace, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___,
+        ___,
+
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___, ___, ___, ___,
+        ___, ___, ___, ___,
+        ___
+    ),
+)
+// *INDENT-ON*
+
+KALEIDOSCOPE_INIT_PLUGINS(Syster);
+
+namespace kaleidoscope {
+namespace testing {
+
+uint8_t last_symbol_index;
+uint16_t action_count;
+char fallback_symbol[SYSTER_MAX_SYMBOL_LENGTH + 1];
+uint16_t fallback_count;
+
+}
+}
+
+static void symbolAction(uint8_t symbol_index) {
+  kaleidoscope::testing::last_symbol_index = symbol_index;
+  kaleidoscope::testing::action_count++;
+}
+
+static const kaleidoscope::plugin::Syster::dictionary_t dictionary[] PROGMEM =
+  SYSTER_DICT({"cab", symbolAction},
+              {"coffee", symbolAction},
+              {"cot", symbolAction});
+
+void systerAction(kaleidoscope::plugin::Syster::action_t action, const char *symbol) {
+  if (action == kaleidoscope::plugin::Syster::SymbolAction) {
+    strcpy(kaleidoscope::testing::fallback_symbol, symbol);
+    kaleidoscope::testing::fallback_count++;
+  }
+}
+
+void setup() {
+  Kaleidoscope.setup();
+  Syster.dictionary = dictionary;
+}
+
+void loop() {
+  Kaleidoscope.loop();
+}
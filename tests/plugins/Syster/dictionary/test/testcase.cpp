@@ -0,0 +1,162 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <initializer_list>
+#include <vector>
+
+#include "testing/setup-googletest.h"
+
+#include "../common.h"
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_SYSTER{0, 0};
+constexpr KeyAddr key_addr_A{0, 1};
+constexpr KeyAddr key_addr_B{0, 2};
+constexpr KeyAddr key_addr_C{0, 3};
+constexpr KeyAddr key_addr_E{0, 4};
+constexpr KeyAddr key_addr_F{0, 5};
+constexpr KeyAddr key_addr_O{0, 6};
+constexpr KeyAddr key_addr_T{1, 0};
+constexpr KeyAddr key_addr_X{1, 1};
+constexpr KeyAddr key_addr_Space{2, 0};
+constexpr KeyAddr key_addr_Backspace{2, 1};
+
+constexpr size_t benchmark_rounds = 1000;
+
+class SysterDictionary : public VirtualDeviceTest {
+ protected:
+  void SetUp() override {
+    VirtualDeviceTest::SetUp();
+    Syster.reset();
+    action_count = 0;
+    fallback_count = 0;
+  }
+
+  void Tap(KeyAddr key_addr) {
+    sim_.Press(key_addr);
+    sim_.RunCycle();
+    sim_.Release(key_addr);
+    sim_.RunCycle();
+  }
+
+  void TapSequence(std::initializer_list<KeyAddr> sequence) {
+    for (KeyAddr key_addr : sequence)
+      Tap(key_addr);
+  }
+
+  // Presses the spacebar to end the symbol, and checks that the reports sent in
+  // that cycle are exactly `count` taps of backspace.
+  void EndSymbol(size_t count) {
+    LoadState();
+    sim_.Press(key_addr_Space);
+    sim_.RunCycle();
+    LoadState();
+
+    ASSERT_EQ(HIDReports()->Keyboard().size(), count * 2)
+        << "Erasing sends one report for each press and release of backspace";
+    for (size_t i = 0; i < count; i++) {
+      EXPECT_EQ(HIDReports()->Keyboard(i * 2).ActiveKeycodes(),
+                std::vector<uint8_t> {Key_Backspace.getKeyCode()});
+      EXPECT_TRUE(HIDReports()->Keyboard(i * 2 + 1).ActiveKeycodes().empty());
+    }
+
+    sim_.Release(key_addr_Space);
+    sim_.RunCycle();
+  }
+};
+
+TEST_F(SysterDictionary, SymbolInDictionary) {
+  TapSequence({key_addr_SYSTER, key_addr_C, key_addr_O, key_addr_T});
+  EndSymbol(3);
+
+  EXPECT_EQ(action_count, 1) << "The symbol's action is called";
+  EXPECT_EQ(last_symbol_index, 2) << "The action gets the index of the symbol";
+  EXPECT_EQ(fallback_count, 0);
+  EXPECT_FALSE(Syster.is_active());
+}
+
+TEST_F(SysterDictionary, UnknownSymbolFallsBackToSysterAction) {
+  TapSequence({key_addr_SYSTER, key_addr_C});
+
+  LoadState();
+  sim_.Press(key_addr_X);
+  sim_.RunCycle();
+  sim_.Release(key_addr_X);
+  sim_.RunCycle();
+  LoadState();
+  EXPECT_FALSE(HIDReports()->Keyboard().empty())
+      << "A character no symbol continues with is still typed";
+
+  TapSequence({key_addr_A});
+  EndSymbol(3);
+
+  EXPECT_EQ(action_count, 0);
+  EXPECT_EQ(fallback_count, 1)
+      << "A symbol not in the dictionary is handed to `systerAction()`";
+  EXPECT_STREQ(fallback_symbol, "cxa");
+}
+
+TEST_F(SysterDictionary, BackspaceRecoversFromAnUnknownPrefix) {
+  TapSequence({key_addr_SYSTER, key_addr_C, key_addr_X, key_addr_Backspace,
+               key_addr_O, key_addr_F, key_addr_F, key_addr_E, key_addr_E});
+  EndSymbol(6);
+
+  EXPECT_EQ(action_count, 1);
+  EXPECT_EQ(last_symbol_index, 1);
+  EXPECT_EQ(fallback_count, 0);
+}
+
+TEST_F(SysterDictionary, BackspaceWidensTheMatch) {
+  TapSequence({key_addr_SYSTER, key_addr_C, key_addr_O, key_addr_Backspace,
+               key_addr_A, key_addr_B});
+  EndSymbol(3);
+
+  EXPECT_EQ(action_count, 1);
+  EXPECT_EQ(last_symbol_index, 0);
+}
+
+TEST_F(SysterDictionary, PrefixFallsBackToSysterAction) {
+  TapSequence({key_addr_SYSTER, key_addr_C, key_addr_O});
+  EndSymbol(2);
+
+  EXPECT_EQ(action_count, 0);
+  EXPECT_EQ(fallback_count, 1)
+      << "A symbol that is only a prefix is handed to `systerAction()`";
+  EXPECT_STREQ(fallback_symbol, "co");
+}
+
+TEST_F(SysterDictionary, EraseCost) {
+  LoadState();
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < benchmark_rounds; i++)
+    eraseChars(8);
+  auto end = std::chrono::steady_clock::now();
+  LoadState();
+
+  EXPECT_EQ(HIDReports()->Keyboard().size(), benchmark_rounds * 8 * 2);
+
+  auto nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  RecordProperty("nsec_per_erased_char", std::to_string(nsec / (benchmark_rounds * 8)));
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
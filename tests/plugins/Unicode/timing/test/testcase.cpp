@@ -0,0 +1,278 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <set>
+
+#include "testing/setup-googletest.h"
+
+#include "Kaleidoscope-HostOS.h"
+#include "Kaleidoscope-Unicode.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+// A host that reads the keyboard reports the way an input method of the
+// given OS would, and records the code points typed, and the time between
+// each report and the next. The keyboard driver sends newly pressed modifiers
+// in a report of their own, right before the one with the rest of the keys,
+// so reports sent in the same cycle count as one when measuring the gaps.
+class MockHost {
+ public:
+  explicit MockHost(hostos::Type os) : os_(os) {}
+
+  void Receive(const KeyboardReport &report) {
+    std::set<uint8_t> keys;
+    for (uint8_t keycode : report.ActiveKeycodes())
+      keys.insert(keycode);
+
+    if (reports_ != 0 && report.Timestamp() != last_timestamp_)
+      gaps_.push_back(report.Timestamp() - last_timestamp_);
+    last_timestamp_ = report.Timestamp();
+    reports_++;
+
+    bool alt = keys.count(Key_LeftAlt.getKeyCode());
+    for (uint8_t keycode : keys) {
+      if (held_.count(keycode))
+        continue;
+      // A newly pressed key.
+      if (os_ == hostos::LINUX && keycode == Key_U.getKeyCode() &&
+          keys.count(Key_LeftControl.getKeyCode()) &&
+          keys.count(Key_LeftShift.getKeyCode())) {
+        StartEntry();
+      } else if (os_ == hostos::LINUX && keycode == Key_Spacebar.getKeyCode()) {
+        EndEntry();
+      } else if (os_ == hostos::WINDOWS && alt &&
+                 keycode == Key_KeypadAdd.getKeyCode()) {
+        StartEntry();
+      } else if (HexValue(keycode) >= 0 &&
+                 (in_entry_ || (os_ == hostos::OSX && alt))) {
+        if (!in_entry_)
+          StartEntry();
+        code_ = code_ * 16 + HexValue(keycode);
+      } else if (!IsModifier(keycode)) {
+        // Any other key is typed as it is, unless it lands in the middle of
+        // an entry, or modifiers are held with it.
+        if (in_entry_ || HasModifiers(keys))
+          strays_.push_back(keycode);
+        else
+          plain_.push_back(keycode);
+      }
+    }
+    if (os_ != hostos::LINUX && in_entry_ && !alt)
+      EndEntry();
+
+    held_ = keys;
+  }
+
+  const std::vector<uint32_t> &Typed() const {
+    return typed_;
+  }
+  // Keys typed on their own, outside of any entry.
+  const std::vector<uint8_t> &Plain() const {
+    return plain_;
+  }
+  // Keys that interrupted an entry, or were turned into shortcuts.
+  const std::vector<uint8_t> &Strays() const {
+    return strays_;
+  }
+  size_t Reports() const {
+    return reports_;
+  }
+  uint32_t ShortestGap() const {
+    return *std::min_element(gaps_.begin(), gaps_.end());
+  }
+
+ private:
+  hostos::Type os_;
+  std::set<uint8_t> held_;
+  bool in_entry_ = false;
+  uint32_t code_ = 0;
+  std::vector<uint32_t> typed_;
+  std::vector<uint8_t> plain_;
+  std::vector<uint8_t> strays_;
+  std::vector<uint32_t> gaps_;
+  uint32_t last_timestamp_ = 0;
+  size_t reports_ = 0;
+
+  void StartEntry() {
+    in_entry_ = true;
+    code_ = 0;
+  }
+  void EndEntry() {
+    in_entry_ = false;
+    typed_.push_back(code_);
+  }
+
+  static bool IsModifier(uint8_t keycode) {
+    return keycode >= Key_LeftControl.getKeyCode() &&
+           keycode <= Key_RightGui.getKeyCode();
+  }
+  static bool HasModifiers(const std::set<uint8_t> &keys) {
+    return std::any_of(keys.begin(), keys.end(), IsModifier);
+  }
+
+  int HexValue(uint8_t keycode) const {
+    if (keycode == Key_0.getKeyCode() || keycode == Key_Keypad0.getKeyCode())
+      return 0;
+    if (keycode >= Key_1.getKeyCode() && keycode <= Key_9.getKeyCode())
+      return keycode - Key_1.getKeyCode() + 1;
+    if (keycode >= Key_Keypad1.getKeyCode() && keycode <= Key_Keypad9.getKeyCode())
+      return keycode - Key_Keypad1.getKeyCode() + 1;
+    if (keycode >= Key_A.getKeyCode() && keycode <= Key_F.getKeyCode())
+      return keycode - Key_A.getKeyCode() + 0xA;
+    return -1;
+  }
+};
+
+class UnicodeTiming : public VirtualDeviceTest {
+ protected:
+  // Types `code_points` on a host running `os`, and returns what the host saw.
+  MockHost Type(hostos::Type os, std::vector<uint32_t> code_points) {
+    HostOS.os(os);
+    ClearState();
+
+    for (uint32_t code_point : code_points)
+      Unicode.type(code_point);
+    EXPECT_TRUE(Unicode.isTyping());
+
+    sim_.RunForMillis(1000);
+    EXPECT_FALSE(Unicode.isTyping());
+
+    return Received(os);
+  }
+
+  // What a host running `os` saw since the last `ClearState()`.
+  MockHost Received(hostos::Type os) {
+    LoadState();
+    MockHost host(os);
+    for (const KeyboardReport &report : HIDReports()->Keyboard())
+      host.Receive(report);
+    return host;
+  }
+};
+
+TEST_F(UnicodeTiming, Linux) {
+  MockHost host = Type(hostos::LINUX, {0x2328, 0x1F600});
+
+  EXPECT_EQ(host.Typed(), std::vector<uint32_t>({0x2328, 0x1F600}));
+  EXPECT_GE(host.ShortestGap(), Unicode.input_delay(hostos::LINUX));
+  // Ctrl+Shift (sent by the driver on its own), Ctrl+Shift+U, four digits,
+  // space, and the release of everything; then the same with five digits, and
+  // a release between the two zeros.
+  EXPECT_EQ(host.Reports(), 8u + 10u);
+}
+
+TEST_F(UnicodeTiming, Windows) {
+  Unicode.input_delay(hostos::WINDOWS, 12);
+  MockHost host = Type(hostos::WINDOWS, {0x00E9, 0x2328});
+
+  EXPECT_EQ(host.Typed(), std::vector<uint32_t>({0x00E9, 0x2328}));
+  EXPECT_GE(host.ShortestGap(), 12u);
+  // Alt, Alt+Plus, four digits, then the release of the last digit, and of
+  // Alt; and an extra release between the two zeros of the first one.
+  EXPECT_EQ(host.Reports(), 9u + 8u);
+}
+
+TEST_F(UnicodeTiming, MacOS) {
+  Unicode.input_delay(hostos::OSX, 0);
+  MockHost host = Type(hostos::OSX, {0x2328, 0x2615});
+
+  EXPECT_EQ(host.Typed(), std::vector<uint32_t>({0x2328, 0x2615}));
+  EXPECT_GE(host.ShortestGap(), 1u)
+      << "At most one report is sent each cycle";
+  // Alt (sent by the driver on its own), Alt with the first digit, three more
+  // digits, the release of the last digit, and of Alt.
+  EXPECT_EQ(host.Reports(), 7u + 7u);
+}
+
+TEST_F(UnicodeTiming, TypeDoesNotBlock) {
+  HostOS.os(hostos::LINUX);
+  ClearState();
+
+  uint32_t start = Runtime.millisAtCycleStart();
+  Unicode.type(0x2328);
+  sim_.RunCycle();
+  EXPECT_EQ(Runtime.millisAtCycleStart() - start, 1u)
+      << "Typing a code point does not hold up the cycle";
+
+  LoadState();
+  EXPECT_EQ(HIDReports()->Keyboard().size(), 2u)
+      << "Only Ctrl+Shift+U (preceded by Ctrl+Shift) is sent in the first cycle";
+
+  sim_.RunForMillis(1000);
+}
+
+TEST_F(UnicodeTiming, FullQueueDoesNotDropCodePoints) {
+  std::vector<uint32_t> code_points;
+  for (uint32_t i = 0; i < UNICODE_QUEUE_SIZE + 2; i++)
+    code_points.push_back(0x2600 + i);
+
+  for (hostos::Type os : {hostos::LINUX, hostos::WINDOWS, hostos::OSX}) {
+    HostOS.os(os);
+    State::Snapshot();
+
+    for (uint32_t code_point : code_points)
+      Unicode.type(code_point);
+    // Typing out the queue moved the clock on while the cycle stood still, so
+    // count cycles rather than milliseconds.
+    for (int cycles = 0; cycles < 1000 && Unicode.isTyping(); cycles++)
+      sim_.RunCycle();
+    EXPECT_FALSE(Unicode.isTyping());
+
+    MockHost host = Received(os);
+    EXPECT_EQ(host.Typed(), code_points)
+        << "The queue is typed out before the code points past it, os: " << int(os);
+  }
+}
+
+TEST_F(UnicodeTiming, HoldsBackKeysPressedWhileTyping) {
+  constexpr KeyAddr key_addr_A{0, 0};
+
+  for (hostos::Type os : {hostos::LINUX, hostos::WINDOWS, hostos::OSX}) {
+    HostOS.os(os);
+    Unicode.input_delay(os, 5);
+    // Start with only the reports sent from here on.
+    State::Snapshot();
+
+    Unicode.type(0x2328);
+    sim_.RunForMillis(8);
+    sim_.Press(key_addr_A);
+    sim_.RunForMillis(10);
+    sim_.Release(key_addr_A);
+    sim_.RunCycle();
+    EXPECT_TRUE(Unicode.isTyping())
+        << "The key was pressed and released in the middle of the sequence";
+
+    sim_.RunForMillis(1000);
+
+    MockHost host = Received(os);
+    EXPECT_EQ(host.Typed(), std::vector<uint32_t>({0x2328}))
+        << "The code point is typed intact, os: " << int(os);
+    EXPECT_EQ(host.Plain(), std::vector<uint8_t>({Key_A.getKeyCode()}))
+        << "The key is typed after the code point, os: " << int(os);
+    EXPECT_TRUE(host.Strays().empty())
+        << "No key is mixed into the sequence, os: " << int(os);
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
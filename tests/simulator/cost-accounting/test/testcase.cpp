@@ -0,0 +1,109 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/setup-googletest.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_A{2, 1};
+constexpr KeyAddr key_addr_S{2, 2};
+
+class CostAccounting : public VirtualDeviceTest {};
+
+TEST_F(CostAccounting, CountsScans) {
+  auto before = OperationCounts::Current();
+  sim_.RunCycles(10);
+  auto cost = OperationCounts::Current() - before;
+
+  EXPECT_EQ(cost.matrix_scans, 10) << "Every cycle scans the matrix once";
+  EXPECT_EQ(cost.hid_reports, 0) << "Idle cycles send no reports";
+  EXPECT_EQ(cost.storage_reads, 0) << "Idle cycles don't read storage";
+}
+
+TEST_F(CostAccounting, CountsReports) {
+  ClearState();
+
+  auto before = OperationCounts::Current();
+  sim_.Press(key_addr_A);
+  sim_.RunCycle();
+  sim_.Press(key_addr_S);
+  sim_.RunCycle();
+  sim_.Release(key_addr_A);
+  sim_.RunCycle();
+  sim_.Release(key_addr_S);
+  sim_.RunCycle();
+  auto cost = OperationCounts::Current() - before;
+
+  LoadState();
+  ASSERT_EQ(HIDReports()->Keyboard().size(), 4);
+  EXPECT_EQ(cost.hid_reports, 4) << "Every report sent is counted";
+  EXPECT_THAT(cost, HIDReportsAtMost(4));
+  EXPECT_THAT(cost, ::testing::Not(HIDReportsAtMost(3)));
+  EXPECT_GT(cost.hid_bytes_sent, 0);
+}
+
+TEST_F(CostAccounting, CountsStorage) {
+  auto before = OperationCounts::Current();
+  uint16_t word = 0x1234;
+  Runtime.storage().put(0, word);
+  Runtime.storage().commit();
+  Runtime.storage().get(0, word);
+  Runtime.storage().read(2);
+  auto cost = OperationCounts::Current() - before;
+
+  EXPECT_EQ(cost.storage_bytes_written, 2);
+  EXPECT_EQ(cost.storage_commits, 1);
+  EXPECT_EQ(cost.storage_reads, 2);
+  EXPECT_EQ(cost.storage_bytes_read, 3);
+  EXPECT_THAT(cost, StorageReadsAtMost(2));
+  EXPECT_THAT(cost, ::testing::Not(StorageReadsAtMost(1)));
+  EXPECT_THAT(cost, StorageCommitsAtMost(1));
+}
+
+TEST_F(CostAccounting, CountsLEDSyncs) {
+  auto before = OperationCounts::Current();
+  sim_.RunForMillis(1000);
+  auto cost = OperationCounts::Current() - before;
+
+  EXPECT_GE(cost.led_syncs, 1000 / 32 - 1)
+      << "LEDControl syncs the LEDs every 32ms";
+  EXPECT_LE(cost.led_syncs, 1000 / 32 + 1)
+      << "LEDControl syncs the LEDs every 32ms";
+}
+
+TEST_F(CostAccounting, WeighsCountsByTarget) {
+  OperationCounts counts;
+  counts.storage_bytes_written = 2;
+  counts.storage_commits = 1;
+
+  EXPECT_EQ(atmega32u4_costs.Cost(counts), 2 * atmega32u4_costs.storage_byte_written);
+  EXPECT_EQ(samd_costs.Cost(counts),
+            2 * samd_costs.storage_byte_written + samd_costs.storage_commit);
+
+  EXPECT_THAT(counts, CostsAtMost(atmega32u4_costs, 2 * 3400000));
+  EXPECT_THAT(counts, ::testing::Not(CostsAtMost(atmega32u4_costs, 3400000)))
+      << "Writing EEPROM is slow on the ATmega32U4";
+  EXPECT_THAT(counts, ::testing::Not(CostsAtMost(samd_costs, 3400000)))
+      << "Committing flash is slow on the SAMD21";
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,174 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <tuple>
+#include <vector>
+
+#include "testing/setup-googletest.h"
+
+#include "Kaleidoscope-LEDControl.h"
+
+#include "../common.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_A{2, 1};
+constexpr KeyAddr key_addr_MouseUp{0, 0};
+constexpr KeyAddr key_addr_ScrollDn{0, 6};
+
+// What a stretch of simulated time looked like from the outside: when each LED
+// frame was synced, relative to the start, and what color `A` was in it.
+struct Stretch {
+  std::vector<std::tuple<uint32_t, uint8_t, uint8_t, uint8_t>> frames;
+  uint32_t duration;
+  uint32_t cycles;
+};
+
+class FastForward : public VirtualDeviceTest {
+ protected:
+  // Taps `A` to restart the idle timer, and wake the LEDs up, then lets `t`
+  // milliseconds pass, either one cycle at a time, or fast-forwarding. Waking
+  // the LEDs up restarts their sync timer too, so as long as they were asleep
+  // before, every run starts out the same.
+  Stretch TapAndWait(size_t t, bool fast_forward) {
+    sim_.Press(key_addr_A);
+    sim_.RunCycle();
+    sim_.Release(key_addr_A);
+    sim_.RunCycle();
+    State::Snapshot();
+
+    Stretch run;
+    uint32_t start_time = Runtime.millisAtCycleStart();
+    uint32_t start_cycles = cycle_count;
+    if (fast_forward) {
+      sim_.FastForward(t);
+    } else {
+      sim_.RunForMillis(t);
+    }
+    run.duration = Runtime.millisAtCycleStart() - start_time;
+    run.cycles = cycle_count - start_cycles;
+
+    auto state = State::Snapshot();
+    for (const LEDFrame &frame : state->LEDs()->Frames()) {
+      const cRGB &color = frame.At(key_addr_A);
+      run.frames.emplace_back(frame.Timestamp() - start_time,
+                              color.r, color.g, color.b);
+    }
+    return run;
+  }
+
+  // Holds the key at `key_addr` for `t` milliseconds, either one cycle at a
+  // time, or fast-forwarding, and returns the mouse reports sent meanwhile:
+  // when each was sent, relative to the start, and how far it moved.
+  std::vector<std::tuple<uint32_t, int8_t, int8_t, int8_t>> HoldMouseKey(KeyAddr key_addr, size_t t,
+                                                                       bool fast_forward) {
+    State::Snapshot();
+    uint32_t start_time = Runtime.millisAtCycleStart();
+    sim_.Press(key_addr);
+    if (fast_forward) {
+      sim_.FastForward(t);
+    } else {
+      sim_.RunForMillis(t);
+    }
+    auto state = State::Snapshot();
+    sim_.Release(key_addr);
+    sim_.RunCycles(2);
+
+    std::vector<std::tuple<uint32_t, int8_t, int8_t, int8_t>> reports;
+    for (const MouseReport &report : state->HIDReports()->Mouse()) {
+      reports.emplace_back(report.Timestamp() - start_time,
+                           report.XAxis(), report.YAxis(), report.VWheel());
+    }
+    return reports;
+  }
+
+  void ExpectSameAsStepped(uint8_t cycle_time) {
+    sim_.SetCycleTime(cycle_time);
+    size_t t = IDLE_TIMEOUT_SECONDS * 1000 + 500;
+
+    TapAndWait(t, true);
+    Stretch stepped = TapAndWait(t, false);
+    Stretch fast = TapAndWait(t, true);
+
+    EXPECT_EQ(fast.duration, stepped.duration)
+        << "Fast-forwarding ends at the same time";
+    EXPECT_EQ(fast.frames, stepped.frames)
+        << "The same LED frames are synced at the same times";
+    EXPECT_LT(fast.cycles, stepped.cycles / 4)
+        << "Only the cycles with something to do are run";
+
+    // The LEDs have timed out by the end of both runs.
+    ASSERT_FALSE(stepped.frames.empty());
+    EXPECT_EQ(std::get<1>(stepped.frames.back()), 0);
+    EXPECT_EQ(std::get<2>(stepped.frames.back()), 0);
+    EXPECT_EQ(std::get<3>(stepped.frames.back()), 0);
+
+    sim_.SetCycleTime(1);
+  }
+};
+
+TEST_F(FastForward, SameAsStepped) {
+  ExpectSameAsStepped(1);
+}
+
+TEST_F(FastForward, SameAsSteppedWithLongerCycles) {
+  ExpectSameAsStepped(3);
+}
+
+// Plugins that act on timers of their own declare them, so that fast-forwarding
+// doesn't skip past them.
+TEST_F(FastForward, MouseKeysSameAsStepped) {
+  for (KeyAddr key_addr : {key_addr_MouseUp, key_addr_ScrollDn}) {
+    auto stepped = HoldMouseKey(key_addr, 500, false);
+    auto fast = HoldMouseKey(key_addr, 500, true);
+
+    EXPECT_GT(stepped.size(), 2);
+    EXPECT_EQ(fast, stepped)
+        << "The same mouse reports are sent at the same times";
+  }
+}
+
+// With the LEDs off, there is nothing to wait for, and an hour passes in a
+// single cycle.
+TEST_F(FastForward, IdleHour) {
+  TapAndWait(IDLE_TIMEOUT_SECONDS * 1000 + 100, true);
+
+  uint32_t start_cycles = cycle_count;
+  auto start = std::chrono::steady_clock::now();
+  sim_.FastForward(60 * 60 * 1000);
+  auto end = std::chrono::steady_clock::now();
+
+  EXPECT_LE(cycle_count - start_cycles, 2);
+
+  auto usec = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+  RecordProperty("usec_per_idle_hour", std::to_string(usec));
+
+  sim_.Press(key_addr_A);
+  sim_.RunCycle();
+  EXPECT_TRUE(::LEDControl.isEnabled())
+      << "A keypress still wakes the LEDs up after fast-forwarding";
+  sim_.Release(key_addr_A);
+  sim_.RunCycle();
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
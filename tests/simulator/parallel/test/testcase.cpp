@@ -0,0 +1,142 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <Kaleidoscope-OneShot.h>
+#include <Kaleidoscope-Qukeys.h>
+#include <Kaleidoscope-SpaceCadet.h>
+
+#include "testing/Parallel.h"
+#include "testing/setup-googletest.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+const std::vector<KeyAddr> typed_keys = {
+  KeyAddr{0, 0},  // OSM(LeftControl)
+  KeyAddr{2, 1},  // A/LeftGui
+  KeyAddr{2, 11},  // J
+  KeyAddr{2, 12},  // K
+  KeyAddr{3, 7},  // SpaceCadet LeftShift
+  KeyAddr{1, 2},  // W
+  KeyAddr{2, 3},  // D
+  KeyAddr{3, 9},  // Spacebar
+};
+
+// Everything a simulation depends on that a test would change.
+struct Config {
+  uint8_t cycle_time;
+  uint16_t qukeys_hold_timeout;
+  uint16_t spacecadet_timeout;
+  uint16_t oneshot_timeout;
+  uint16_t oneshot_hold_timeout;
+};
+
+const Config stock{1, 250, 200, 2500, 250};
+const Config impatient{5, 150, 120, 800, 150};
+
+void Apply(const Config &config, SimHarness &sim) {
+  sim.SetCycleTime(config.cycle_time);
+  ::Qukeys.setHoldTimeout(config.qukeys_hold_timeout);
+  ::SpaceCadet.time_out = config.spacecadet_timeout;
+  ::OneShot.setTimeout(config.oneshot_timeout);
+  ::OneShot.setHoldTimeout(config.oneshot_hold_timeout);
+}
+
+// Replays someone typing for two minutes with `config`, and returns the
+// output.
+std::string Simulate(const Config &config, uint32_t seed) {
+  SimHarness sim;
+  Apply(config, sim);
+
+  Replay replay(sim);
+  std::ostringstream out;
+  replay.Run(RandomTyping(typed_keys, 2 * 60 * 1000, seed), out);
+  return out.str();
+}
+
+class ParallelTest : public VirtualDeviceTest {
+ protected:
+  void TearDown() override {
+    Apply(stock, sim_);
+  }
+};
+
+TEST_F(ParallelTest, WorkersMatchSerialRuns) {
+  const std::vector<std::pair<Config, uint32_t>> runs = {
+    {stock, 1}, {impatient, 1}, {stock, 2}, {impatient, 2},
+  };
+
+  std::vector<SimulationJob> jobs;
+  for (const auto &run : runs) {
+    jobs.push_back([run](std::ostream & out) {
+      out << Simulate(run.first, run.second);
+    });
+  }
+  std::vector<JobResult> results = RunInParallel(jobs, 2);
+
+  // The workers changed their own copies of the settings, not these.
+  EXPECT_EQ(::SpaceCadet.time_out, stock.spacecadet_timeout);
+  EXPECT_EQ(sim_.CycleTime(), 1);
+
+  ASSERT_EQ(results.size(), runs.size());
+  for (size_t i = 0; i < runs.size(); i++) {
+    ASSERT_TRUE(results[i].completed) << "Job " << i;
+    EXPECT_EQ(results[i].output, Simulate(runs[i].first, runs[i].second))
+        << "Job " << i;
+  }
+  EXPECT_NE(results[0].output, results[1].output)
+      << "The settings make no difference to the typing";
+}
+
+TEST_F(ParallelTest, ReportsJobsThatDidNotFinish) {
+  std::vector<SimulationJob> jobs = {
+    [](std::ostream & out) {
+      out << "done";
+    },
+    [](std::ostream & out) {
+      out << "partial";
+      std::_Exit(3);
+    },
+    [](std::ostream & out) {
+      out << "partial";
+      throw std::runtime_error("job failed");
+    },
+  };
+
+  std::vector<JobResult> results = RunInParallel(jobs);
+
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_TRUE(results[0].completed);
+  EXPECT_EQ(results[0].output, "done");
+  EXPECT_FALSE(results[1].completed);
+  EXPECT_EQ(results[1].output, "");
+  EXPECT_FALSE(results[2].completed)
+      << "A job that throws doesn't carry on as the caller";
+  EXPECT_EQ(results[2].output, "");
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -0,0 +1,87 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Kaleidoscope.h>
+#include <Kaleidoscope-LEDControl.h>
+#include <Kaleidoscope-LEDEffect-SolidColor.h>
+#include <Kaleidoscope-OneShot.h>
+#include <Kaleidoscope-Qukeys.h>
+#include <Kaleidoscope-SpaceCadet.h>
+
+// *INDENT-OFF*
+KEYMAPS(
+  [0] = KEYMAP_STACKED
+  (
+      OSM(LeftControl), Key_1, Key_2, Key_3, Key_4, Key_5, Key_NoKey,
+      Key_Backtick,     Key_Q, Key_W, Key_E, Key_R, Key_T, Key_Tab,
+      Key_PageUp,       Key_A, Key_S, Key_D, Key_F, Key_G,
+      Key_PageDown,     Key_Z, Key_X, Key_C, Key_V, Key_B, Key_Escape,
+
+      Key_LeftControl, Key_Backspace, Key_LeftGui, Key_LeftShift,
+      Key_NoKey,
+
+      Key_skip,  Key_6, Key_7, Key_8,     Key_9,      Key_0,         Key_skip,
+      Key_Enter, Key_Y, Key_U, Key_I,     Key_O,      Key_P,         Key_Equals,
+                 Key_H, Key_J, Key_K,     Key_L,      Key_Semicolon, Key_Quote,
+      Key_skip,  Key_N, Key_M, Key_Comma, Key_Period, Key_Slash,     Key_Minus,
+
+      Key_RightShift, Key_RightAlt, Key_Spacebar, Key_RightControl,
+      Key_NoKey
+   ),
+)
+// *INDENT-ON*
+
+namespace kaleidoscope {
+namespace plugin {
+
+// Shows what the host asked for on the first two LEDs: red when Caps Lock is
+// on, and green while the host is suspended.
+class HostIndicators : public kaleidoscope::Plugin {
+ public:
+  EventHandlerResult beforeSyncingLeds() {
+    bool caps_lock = Kaleidoscope.hid().keyboard().getKeyboardLEDs() & 0x02;
+    bool suspended = Kaleidoscope.device().mcu().isHostSuspended();
+    ::LEDControl.setCrgbAt(0, caps_lock ? CRGB(160, 0, 0) : CRGB(0, 0, 0));
+    ::LEDControl.setCrgbAt(1, suspended ? CRGB(0, 160, 0) : CRGB(0, 0, 0));
+    return EventHandlerResult::OK;
+  }
+};
+
+}  // namespace plugin
+}  // namespace kaleidoscope
+
+kaleidoscope::plugin::HostIndicators HostIndicators;
+kaleidoscope::plugin::LEDSolidColor solidBlue(0, 0, 160);
+
+KALEIDOSCOPE_INIT_PLUGINS(Qukeys,
+                          SpaceCadet,
+                          OneShot,
+                          LEDControl,
+                          solidBlue,
+                          HostIndicators);
+
+void setup() {
+  QUKEYS(
+    kaleidoscope::plugin::Qukey(0, KeyAddr(2, 1), Key_LeftGui),       // A/cmd
+  )
+
+  Kaleidoscope.setup();
+  solidBlue.activate();
+}
+
+void loop() {
+  Kaleidoscope.loop();
+}
@@ -0,0 +1,180 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "testing/setup-googletest.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr KeyAddr key_addr_OSM_Ctrl{0, 0};
+constexpr KeyAddr key_addr_Qukey_A{2, 1};
+constexpr KeyAddr key_addr_J{2, 11};
+constexpr KeyAddr key_addr_K{2, 12};
+constexpr KeyAddr key_addr_SpaceCadet_Shift{3, 7};
+
+const std::vector<KeyAddr> typed_keys = {
+  key_addr_OSM_Ctrl,
+  key_addr_Qukey_A,
+  key_addr_J,
+  key_addr_K,
+  key_addr_SpaceCadet_Shift,
+  KeyAddr{1, 2},  // W
+  KeyAddr{2, 3},  // D
+  KeyAddr{3, 9},  // Spacebar
+};
+
+// The lines of a replay's output that start with `prefix`, after the time.
+std::vector<std::string> Lines(const std::string &output, const std::string &prefix) {
+  std::vector<std::string> lines;
+  std::istringstream in(output);
+  std::string line;
+  while (std::getline(in, line)) {
+    size_t space = line.find(' ');
+    if (line[0] != '#' && line.compare(space + 1, prefix.size(), prefix) == 0)
+      lines.push_back(line);
+  }
+  return lines;
+}
+
+class ReplayTest : public VirtualDeviceTest {
+ protected:
+  std::string Play(const EventTrace &trace, bool fast_forward = false) {
+    Replay replay(sim_);
+    replay.SetFastForward(fast_forward);
+    std::ostringstream out;
+    replay.Run(trace, out);
+    cycles_ = replay.Cycles();
+    return out.str();
+  }
+
+  size_t cycles_ = 0;
+};
+
+TEST_F(ReplayTest, ReadsWhatItWrites) {
+  EventTrace trace;
+  trace.Press(0, key_addr_J);
+  trace.SetHostLEDs(10, 0x02);
+  trace.Release(85, key_addr_J);
+  trace.Suspend(60000);
+  trace.Resume(61000);
+  trace.Press(100000, KeyAddr{3, 15});
+
+  std::stringstream text;
+  trace.WriteText(text);
+  EventTrace from_text;
+  ASSERT_TRUE(from_text.Read(text)) << from_text.Error();
+  EXPECT_EQ(from_text.Events(), trace.Events());
+
+  std::stringstream binary;
+  trace.WriteBinary(binary);
+  EventTrace from_binary;
+  ASSERT_TRUE(from_binary.Read(binary)) << from_binary.Error();
+  EXPECT_EQ(from_binary.Events(), trace.Events());
+}
+
+TEST_F(ReplayTest, RejectsMalformedTraces) {
+  EventTrace trace;
+
+  std::istringstream unknown("# A comment\n\n0 press 2 11\n10 tickle 2 11\n");
+  EXPECT_FALSE(trace.Read(unknown));
+  EXPECT_EQ(trace.Error(), "Malformed event on line 4: 10 tickle 2 11");
+
+  std::istringstream outside("0 press 4 0\n");
+  EXPECT_FALSE(trace.Read(outside)) << "There are only four rows";
+
+  std::istringstream out_of_order("10 press 2 11\n5 release 2 11\n");
+  EXPECT_FALSE(trace.Read(out_of_order));
+
+  std::istringstream truncated(std::string("KTR\x01\x00\x00\x00", 7));
+  EXPECT_FALSE(trace.Read(truncated));
+}
+
+TEST_F(ReplayTest, ReportsAtTheRecordedTimes) {
+  EventTrace trace;
+  trace.Press(0, key_addr_J);
+  trace.Release(50, key_addr_J);
+  trace.Press(100, key_addr_K);
+  trace.Release(130, key_addr_K);
+
+  // Each event is seen by the first cycle that starts at or after it.
+  auto at = [](uint32_t time, uint8_t cycle_time) {
+    return std::to_string((time + cycle_time - 1) / cycle_time * cycle_time);
+  };
+  for (uint8_t cycle_time : {1, 4}) {
+    sim_.SetCycleTime(cycle_time);
+    std::string output = Play(trace);
+    EXPECT_EQ(output.substr(0, output.find('\n')), "# kaleidoscope replay 1");
+    EXPECT_THAT(Lines(output, "keyboard"), ::testing::ElementsAre(
+                  at(0, cycle_time) + " keyboard 0d",
+                  at(50, cycle_time) + " keyboard",
+                  at(100, cycle_time) + " keyboard 0e",
+                  at(130, cycle_time) + " keyboard"))
+        << "With a cycle time of " << int(cycle_time) << "ms";
+  }
+  sim_.SetCycleTime(1);
+}
+
+TEST_F(ReplayTest, PlaysHostLEDsAndSuspend) {
+  EventTrace trace;
+  trace.SetHostLEDs(0, 0x02);
+  trace.Suspend(500);
+  trace.Resume(1000);
+  trace.SetHostLEDs(1000, 0x00);
+
+  std::string output = Play(trace);
+  auto frames = Lines(output, "leds");
+  ASSERT_EQ(frames.size(), 3) << output;
+  EXPECT_THAT(frames[0], ::testing::MatchesRegex("[0-9]+ leds a00000 000000 0000a0 .*"));
+  EXPECT_THAT(frames[1], ::testing::MatchesRegex("5[0-9][0-9] leds a00000 00a000 0000a0 .*"));
+  EXPECT_THAT(frames[2], ::testing::MatchesRegex("10[0-9][0-9] leds 000000 000000 0000a0 .*"));
+
+  EXPECT_EQ(Kaleidoscope.hid().keyboard().getKeyboardLEDs(), 0);
+  EXPECT_FALSE(Kaleidoscope.device().mcu().isHostSuspended());
+}
+
+TEST_F(ReplayTest, FastForwardChangesNothing) {
+  EventTrace trace = RandomTyping(typed_keys, 2 * 60 * 1000, 1);
+
+  std::string stepped = Play(trace, false);
+  size_t stepped_cycles = cycles_;
+  std::string fast_forwarded = Play(trace, true);
+
+  EXPECT_GT(Lines(stepped, "keyboard").size(), trace.Events().size() / 2);
+  EXPECT_EQ(fast_forwarded, stepped);
+  EXPECT_LT(cycles_, stepped_cycles / 4);
+}
+
+TEST_F(ReplayTest, ReplaysAnHourQuickly) {
+  EventTrace trace = RandomTyping(typed_keys, 60 * 60 * 1000, 2);
+
+  std::string output = Play(trace, true);
+
+  EXPECT_GT(trace.Events().size(), 5000);
+  EXPECT_GT(Lines(output, "keyboard").size(), trace.Events().size() / 2);
+  EXPECT_LT(cycles_, trace.Duration() / 16)
+      << "Only the cycles that handle events, or let timers expire, run";
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
@@ -94,6 +94,83 @@ TEST_F(SimulatorTiming, 3msPerCycleTestRunCycles) {
 }
 
 
+TEST_F(SimulatorTiming, MicrosecondsMatchMilliseconds) {
+  RunCycle();
+  uint32_t micros = Kaleidoscope.device().micros();
+  ASSERT_EQ(micros, Kaleidoscope.millisAtCycleStart() * 1000);
+
+  sim_.RunCycles(10);
+  ASSERT_EQ(Kaleidoscope.device().micros() - micros, 10000);
+}
+
+TEST_F(SimulatorTiming, ReadingTheClockTakesNoTime) {
+  RunCycle();
+  uint32_t millis = Kaleidoscope.device().millis();
+  uint32_t micros = Kaleidoscope.device().micros();
+  for (int i = 0; i < 1000; i++) {
+    Kaleidoscope.device().millis();
+    Kaleidoscope.device().micros();
+  }
+  ASSERT_EQ(Kaleidoscope.device().millis(), millis);
+  ASSERT_EQ(Kaleidoscope.device().micros(), micros);
+  ASSERT_EQ(Kaleidoscope.millisAtCycleStart(), millis);
+}
+
+TEST_F(SimulatorTiming, DelayMovesTheClock) {
+  RunCycle();
+  uint32_t micros = Kaleidoscope.device().micros();
+
+  Kaleidoscope.device().delayMicroseconds(250);
+  ASSERT_EQ(Kaleidoscope.device().micros() - micros, 250);
+  Kaleidoscope.device().delay(3);
+  ASSERT_EQ(Kaleidoscope.device().micros() - micros, 3250);
+}
+
+TEST_F(SimulatorTiming, MacroWaitMovesTheClock) {
+  constexpr KeyAddr key_addr_Macro{0, 0};
+  RunCycle();
+  uint32_t start = Kaleidoscope.millisAtCycleStart();
+
+  sim_.Press(key_addr_Macro);
+  RunCycle();
+  ASSERT_EQ(Kaleidoscope.device().millis() - start, 1 + 100)
+      << "The cycle that plays the macro takes as long as it waits";
+  sim_.Release(key_addr_Macro);
+  RunCycle();
+  ASSERT_EQ(Kaleidoscope.millisAtCycleStart() - start, 1 + 100 + 1)
+      << "The next cycle starts after the wait";
+}
+
+TEST_F(SimulatorTiming, CostModelSetsTheCycleTime) {
+  sim_.SetCostModel({1500, nullptr});
+  uint32_t start_micros = Kaleidoscope.device().micros();
+  uint32_t start = Kaleidoscope.millisAtCycleStart();
+
+  sim_.RunCycle();
+  ASSERT_EQ(Kaleidoscope.millisAtCycleStart() - start, 1) << "1.5ms, rounded down";
+  sim_.RunCycle();
+  ASSERT_EQ(Kaleidoscope.millisAtCycleStart() - start, 3);
+  ASSERT_EQ(Kaleidoscope.device().micros() - start_micros, 3000);
+}
+
+TEST_F(SimulatorTiming, OperationCostsMakeCyclesLonger) {
+  sim_.SetCostModel({1000, &atmega32u4_costs});
+  RunCycle();
+  uint32_t start_micros = Kaleidoscope.device().micros();
+
+  // Each of these cycles scans the matrix once, and does nothing else that
+  // costs anything.
+  sim_.RunCycles(10);
+  ASSERT_EQ(Kaleidoscope.device().micros() - start_micros,
+            10 * (1000 + atmega32u4_costs.matrix_scan / 1000));
+
+  // Which fast-forwarding can't know in advance, so it doesn't skip any.
+  uint32_t start = Kaleidoscope.millisAtCycleStart();
+  sim_.FastForward(100);
+  ASSERT_GE(Kaleidoscope.millisAtCycleStart() - start, 100);
+  ASSERT_LT(Kaleidoscope.millisAtCycleStart() - start, 100 + 2);
+}
+
 TEST_F(SimulatorTiming, 4msPerCycleTestRunForMillis) {
   sim_.SetCycleTime(4);
   // Record time at start
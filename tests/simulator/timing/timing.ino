@@ -15,13 +15,14 @@
  */
 
 #include "Kaleidoscope.h"
+#include "Kaleidoscope-Macros.h"
 
 // *INDENT-OFF*
 
 KEYMAPS(
   [0] = KEYMAP_STACKED
   (
-    XXX   ,XXX   ,XXX   ,XXX   ,XXX   ,XXX   ,XXX
+    M(0)  ,XXX   ,XXX   ,XXX   ,XXX   ,XXX   ,XXX
    ,XXX   ,XXX   ,XXX   ,XXX   ,XXX   ,XXX   ,XXX
    ,XXX   ,XXX   ,XXX   ,XXX   ,XXX   ,XXX
    ,XXX   ,XXX   ,XXX   ,XXX   ,XXX   ,XXX   ,XXX
@@ -39,6 +40,46 @@ KEYMAPS(
 
 // *INDENT-ON*
 
+namespace kaleidoscope {
+namespace plugin {
+
+// Reads the clock, every way there is, from every hook that runs each cycle,
+// so that the tests show that this doesn't make time pass.
+class ClockReader : public kaleidoscope::Plugin {
+ public:
+  EventHandlerResult beforeEachCycle() {
+    read();
+    return EventHandlerResult::OK;
+  }
+  EventHandlerResult afterEachCycle() {
+    read();
+    return EventHandlerResult::OK;
+  }
+
+ private:
+  void read() {
+    for (uint8_t i = 0; i < 10; i++) {
+      Kaleidoscope.device().millis();
+      Kaleidoscope.device().micros();
+      ::millis();
+      ::micros();
+    }
+  }
+};
+
+}  // namespace plugin
+}  // namespace kaleidoscope
+
+kaleidoscope::plugin::ClockReader ClockReader;
+
+const macro_t *macroAction(uint8_t macro_id, KeyEvent &event) {
+  if (macro_id == 0 && keyToggledOn(event.state))
+    return MACRO(T(A), W(100), T(B));
+  return MACRO_NONE;
+}
+
+KALEIDOSCOPE_INIT_PLUGINS(ClockReader, Macros);
+
 void setup() {
   Kaleidoscope.setup();
 }
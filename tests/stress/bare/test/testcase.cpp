@@ -0,0 +1,72 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testing/setup-googletest.h"
+#include "testing/KeyStorm.h"
+
+SETUP_GOOGLETEST();
+
+namespace kaleidoscope {
+namespace testing {
+namespace {
+
+constexpr uint32_t default_seed = 0x5eed0001;
+
+// Long enough for every timeout in the sketch to expire.
+constexpr size_t settle_time = 3000;
+
+// A cycle that would take this long on the ATmega32U4 is doing runaway work:
+// sending a report for every key of a burst, and syncing the LEDs on top of
+// that, stays well under it.
+constexpr uint64_t max_cycle_nsec = 10 * 1000 * 1000;
+
+// The home row, and the modifiers and layer keys around it.
+const std::vector<KeyAddr> home_row = {
+  {2, 1}, {2, 2}, {2, 3}, {2, 4}, {2, 5},
+  {2, 10}, {2, 11}, {2, 12}, {2, 13}, {2, 14},
+  {0, 0}, {0, 6}, {0, 15}, {3, 6}, {3, 7}, {3, 8}, {3, 9},
+};
+
+class BareStorm : public VirtualDeviceTest {};
+
+TEST_F(BareStorm, DenseBursts) {
+  KeyStorm storm(sim_, KeyStorm::SeedFromEnvironment(default_seed));
+  storm.SetConcurrency(8, 15);
+  storm.SetGap(0, 5);
+  storm.Run(2000);
+  storm.Check(settle_time, atmega32u4_costs, max_cycle_nsec);
+}
+
+TEST_F(BareStorm, SparseBursts) {
+  KeyStorm storm(sim_, KeyStorm::SeedFromEnvironment(default_seed + 1));
+  storm.SetConcurrency(1, 4);
+  storm.SetGap(0, 300);
+  storm.Run(1000);
+  storm.Check(settle_time, atmega32u4_costs, max_cycle_nsec);
+}
+
+TEST_F(BareStorm, HomeRowChords) {
+  KeyStorm storm(sim_, KeyStorm::SeedFromEnvironment(default_seed + 2));
+  storm.SetKeys(home_row);
+  storm.SetConcurrency(2, 8);
+  storm.SetGap(0, 50);
+  storm.Run(2000);
+  storm.Check(settle_time, atmega32u4_costs, max_cycle_nsec);
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace kaleidoscope
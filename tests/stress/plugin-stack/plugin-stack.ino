@@ -0,0 +1,98 @@
+/* -*- mode: c++ -*-
+ * Copyright (C) 2021  Keyboard.io, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Kaleidoscope.h>
+#include <Kaleidoscope-LEDControl.h>
+#include <Kaleidoscope-LEDEffect-SolidColor.h>
+#include <Kaleidoscope-LED-ActiveModColor.h>
+#include <Kaleidoscope-OneShot.h>
+#include <Kaleidoscope-Qukeys.h>
+#include <Kaleidoscope-SpaceCadet.h>
+
+// *INDENT-OFF*
+KEYMAPS(
+  [0] = KEYMAP_STACKED
+  (
+      OSM(LeftControl), Key_1, Key_2, Key_3, Key_4, Key_5, OSM(LeftAlt),
+      Key_Backtick,     Key_Q, Key_W, Key_E, Key_R, Key_T, Key_Tab,
+      Key_PageUp,       Key_A, Key_S, Key_D, Key_F, Key_G,
+      Key_PageDown,     Key_Z, Key_X, Key_C, Key_V, Key_B, Key_Escape,
+
+      Key_LeftControl, Key_Backspace, Key_LeftGui, Key_LeftShift,
+      OSL(1),
+
+      Key_skip,  Key_6, Key_7, Key_8,     Key_9,      Key_0,         OSM(RightAlt),
+      Key_Enter, Key_Y, Key_U, Key_I,     Key_O,      Key_P,         Key_Equals,
+                 Key_H, Key_J, Key_K,     Key_L,      Key_Semicolon, Key_Quote,
+      Key_skip,  Key_N, Key_M, Key_Comma, Key_Period, Key_Slash,     Key_Minus,
+
+      Key_RightShift, Key_RightAlt, Key_Spacebar, Key_RightControl,
+      ShiftToLayer(1)
+   ),
+  [1] = KEYMAP_STACKED
+  (
+      ___, Key_F1, Key_F2, Key_F3, Key_F4, Key_F5, ___,
+      ___, ___,    ___,    ___,    ___,    ___,    ___,
+      ___, Key_1,  Key_2,  Key_3,  Key_4,  Key_5,
+      ___, ___,    ___,    ___,    ___,    ___,    ___,
+
+      ___, ___, ___, ___,
+      ___,
+
+      ___, Key_F6, Key_F7, Key_F8, Key_F9, Key_F10, ___,
+      ___, ___,    ___,    ___,    ___,    ___,     ___,
+           Key_6,  Key_7,  Key_8,  Key_9,  Key_0,   ___,
+      ___, ___,    ___,    ___,    ___,    ___,     ___,
+
+      ___, ___, ___, ___,
+      ___
+   ),
+)
+// *INDENT-ON*
+
+kaleidoscope::plugin::LEDSolidColor solidBlue(0, 0, 160);
+
+KALEIDOSCOPE_INIT_PLUGINS(Qukeys,
+                          SpaceCadet,
+                          OneShot,
+                          LEDControl,
+                          solidBlue,
+                          ActiveModColorEffect);
+
+void setup() {
+  QUKEYS(
+    kaleidoscope::plugin::Qukey(0, KeyAddr(2, 1), Key_LeftGui),       // A/cmd
+    kaleidoscope::plugin::Qukey(0, KeyAddr(2, 2), Key_LeftAlt),       // S/alt
+    kaleidoscope::plugin::Qukey(0, KeyAddr(2, 3), Key_LeftControl),   // D/ctrl
+    kaleidoscope::plugin::Qukey(0, KeyAddr(2, 4), Key_LeftShift),     // F/shift
+    kaleidoscope::plugin::Qukey(0, KeyAddr(2, 11), Key_RightShift),   // J/shift
+    kaleidoscope::plugin::Qukey(0, KeyAddr(2, 12), Key_RightControl), // K/ctrl
+    kaleidoscope::plugin::Qukey(0, KeyAddr(2, 13), ShiftToLayer(1))   // L/layer-shift
+  )
+
+  Kaleidoscope.setup();
+
+  // A sticky one-shot key stays active until it is tapped again, which a storm
+  // has no reason to do, so it would look like a stuck key.
+  OneShot.disableStickabilityForModifiers();
+  OneShot.disableStickabilityForLayers();
+
+  solidBlue.activate();
+}
+
+void loop() {
+  Kaleidoscope.loop();
+}